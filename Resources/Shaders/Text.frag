@@ -1,11 +1,11 @@
 #version 330 core
 in vec2 TexCoords;
+in vec4 TextColor;
 out vec4 FragColor;
 
 uniform sampler2D text;
-uniform vec3 textColor;
 
 void main() {
     float alpha = texture(text, TexCoords).r; // Glyphs are monochrome, stored in the red channel
-    FragColor = vec4(textColor, alpha);
-}
+    FragColor = vec4(TextColor.rgb, TextColor.a * alpha);
+}
\ No newline at end of file
@@ -1,11 +1,14 @@
 #version 330 core
-layout (location = 0) in vec4 vertex; // (x, y, texX, texY)
+layout (location = 0) in vec4 vertex; // (x, y, texX, texY), texY = 0 at the top of the atlas
+layout (location = 1) in vec4 color;  // SpriteBatch vertex layout
 
 out vec2 TexCoords;
+out vec4 TextColor;
 
 uniform mat4 projection; // Orthographic projection matrix
 
 void main() {
     gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vec2(vertex.z, 1 - vertex.w); // Flip the Y coordinate of the texture
+    TexCoords = vertex.zw;
+    TextColor = color;
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #version 330 core
-layout(location = 0) in vec2 aPos;       // Vertex position (2D)
-layout(location = 1) in vec2 aTexCoord;  // Texture coordinate
+layout(location = 0) in vec4 vertex;     // (x, y) screen position, (z, w) texture coordinate
+layout(location = 1) in vec4 color;      // Tint, SpriteBatch vertex layout
 
 out vec2 TexCoord;  // Pass texture coordinate to fragment shader
+out vec4 Tint;
 
 uniform mat4 projection;  // Projection matrix for screen-space rendering
 
 void main() {
-    gl_Position = projection * vec4(aPos, 0.0, 1.0);  // Transform vertex position
-    TexCoord = aTexCoord;                             // Pass texture coordinates
+    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);  // Transform vertex position
+    TexCoord = vertex.zw;                                   // Pass texture coordinates
+    Tint = color;
 }
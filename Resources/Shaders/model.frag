@@ -11,13 +11,35 @@ uniform sampler2D texture_metallicRoughness1;
 uniform sampler2D texture_normal1;
 
 // IBL maps
-uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
 
-uniform vec3 camPos;
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
+
+// Diffuse sky light, SH9 of the HDRI projected on the CPU (IrradianceSH, SkyIrradianceUniforms in Shaders.h)
+layout (std140) uniform SkyIrradiance {
+    vec4 irradianceSH[9];
+};
+
+// Irradiance / PI around the normal, what the old irradiance cubemap held
+vec3 skyIrradiance(vec3 n) {
+    vec3 result = irradianceSH[0].rgb
+        + irradianceSH[1].rgb * n.y + irradianceSH[2].rgb * n.z + irradianceSH[3].rgb * n.x
+        + irradianceSH[4].rgb * (n.x * n.y) + irradianceSH[5].rgb * (n.y * n.z) + irradianceSH[6].rgb * (3.0 * n.z * n.z - 1.0)
+        + irradianceSH[7].rgb * (n.x * n.z) + irradianceSH[8].rgb * (n.x * n.x - n.y * n.y);
+    return max(result, vec3(0.0));
+}
+
 uniform vec3 lightPos;
-uniform vec3 lightColor;
+uniform vec3 pointLightColor; // lightColor is the sun (FrameData)
 
 // Material properties
 uniform float metallic = 0.65;
@@ -98,7 +120,7 @@ void main() {
     
     // Direct light radiance
     float distance = length(lightPos - FragPos);
-    vec3 radiance = lightColor / (distance * distance);
+    vec3 radiance = pointLightColor / (distance * distance);
     
     // BRDF parameters (specular reflectance at normal incidence)
     vec3 F0 = mix(vec3(0.04), albedo, metallicFinal);
@@ -126,7 +148,7 @@ void main() {
     
     // --- IBL: Ambient Lighting using Image-Based Lighting ---
     // Diffuse irradiance from the environment
-    vec3 irradiance = texture(irradianceMap, N).rgb;
+    vec3 irradiance = skyIrradiance(N);
     vec3 diffuseIBL = irradiance * albedo;
     
     // Specular IBL: sample from prefiltered map using the reflection vector
@@ -3,17 +3,42 @@
 layout(location = 0) in vec3 pos;
 layout(location = 1) in vec3 norm;
 layout(location = 2) in vec2 tex;
-layout(location = 5) in ivec4 boneIds; 
-layout(location = 6) in vec4 weights;
+layout(location = 5) in uvec4 boneIds;  // uint8 in the vertex
+layout(location = 6) in vec4 weights;   // unorm16, sum to 1 (all 0 = not skinned)
 
-uniform mat4 projection;
-uniform mat4 view;
 uniform mat4 model;
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
 
 const int MAX_BONES = 100;
-const int MAX_BONE_INFLUENCE = 4;
 uniform mat4 finalBonesMatrices[MAX_BONES];
-uniform vec3 cameraPos;
+
+// Instanced crowd (BonePaletteBuffer.h) : per instance a block of instanceStride matrices,
+// the model matrix then the palette, 4 RGBA32F texels each
+uniform bool instancedSkin;
+uniform samplerBuffer bonePalettes;
+uniform int instanceStride;
+
+mat4 fetchMatrix(int index)
+{
+    int texel = index * 4;
+    return mat4(texelFetch(bonePalettes, texel), texelFetch(bonePalettes, texel + 1),
+                texelFetch(bonePalettes, texel + 2), texelFetch(bonePalettes, texel + 3));
+}
+
+mat4 boneMatrix(uint id)
+{
+    if (instancedSkin)
+        return fetchMatrix(gl_InstanceID * instanceStride + 1 + int(min(id, uint(instanceStride - 2))));
+    return finalBonesMatrices[min(id, uint(MAX_BONES - 1))];
+}
 
 out vec2 TexCoords;
 out vec3 FragNormal;
@@ -25,40 +50,27 @@ out vec3 Bitangent;  // Added bitangent output
 
 void main()
 {
-    vec4 totalPosition = vec4(0.0f);
-    vec3 totalNormal = vec3(0.0f);
-    float totalWeight = 0.0f;
-
-    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
-    {
-        if (boneIds[i] < 0)  // -1 means no bone assigned
-            continue;
-        
-        if (boneIds[i] >= MAX_BONES) 
-            continue;
-
-        vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(pos, 1.0f);
-        totalPosition += localPosition * weights[i];
-
-        mat3 normalMatrix = mat3(finalBonesMatrices[boneIds[i]]);
-        totalNormal += normalMatrix * norm * weights[i];
-
-        totalWeight += weights[i];
-    }
+    vec4 totalPosition = vec4(pos, 1.0f);
+    vec3 totalNormal = norm;
 
-    // If no valid bone weights were applied, keep in bind pose
-    if (totalWeight == 0.0)
+    // The importer keeps 4 influences renormalized, so one blended matrix does the whole skin
+    if (dot(weights, vec4(1.0f)) > 0.0f)
     {
-        totalPosition = vec4(pos, 1.0f);
-        totalNormal = norm;
+        mat4 skin = boneMatrix(boneIds.x) * weights.x
+                  + boneMatrix(boneIds.y) * weights.y
+                  + boneMatrix(boneIds.z) * weights.z
+                  + boneMatrix(boneIds.w) * weights.w;
+        totalPosition = skin * totalPosition;
+        totalNormal = mat3(skin) * norm;
     }
 
-    mat4 viewModel = view * model;
+    mat4 modelMatrix = instancedSkin ? fetchMatrix(gl_InstanceID * instanceStride) : model;
+    mat4 viewModel = view * modelMatrix;
     gl_Position = projection * viewModel * totalPosition;	
-    vec4 worldPos = model * totalPosition;
+    vec4 worldPos = modelMatrix * totalPosition;
     FragPos = vec3(worldPos);
-    Normal = normalize(mat3(transpose(inverse(model))) * totalNormal);
-    ViewPos = cameraPos;
+    Normal = normalize(mat3(transpose(inverse(modelMatrix))) * totalNormal);
+    ViewPos = camPos;
     
     // Generate tangent vectors (since we don't have them as inputs)
     // This is a simple approach - better would be to compute these in the mesh preprocessing
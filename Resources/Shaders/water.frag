@@ -8,11 +8,17 @@ in vec2 TexCoord;
 in vec3 Normal;
 in vec3 FragPos;
 
-uniform vec3 cameraPos;
 uniform sampler2D texture_diffuse;
 
-uniform vec3 lightDir;
-uniform vec3 lightColor;
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
 uniform float ambientStrength;
 uniform float diffuseStrength;
 uniform float specularStrength;
@@ -22,7 +28,7 @@ void main() {
     vec4 textureColor = texture(texture_diffuse, TexCoord);
     vec3 norm = normalize(Normal);
     vec3 lightDirection = normalize(-lightDir);
-    vec3 viewDir = normalize(cameraPos - FragPos);
+    vec3 viewDir = normalize(camPos - FragPos);
 
     // Lighting calculations
     vec3 ambient = ambientStrength * lightColor;
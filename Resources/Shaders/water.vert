@@ -2,24 +2,31 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
+layout (location = 7) in vec3 aChunkOffset; // world position of the chunk (per draw, chunks share one buffer)
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 FragPos;   // World-space position
 out vec3 ViewPos;   // View-space position
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform float time; // Add this uniform for animation
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
 
 void main() {
     // Create a modified position with wave effect
-    vec3 waterPos = aPos;
+    vec3 waterPos = aPos + aChunkOffset;
     
     // Base lowering of water level
     waterPos.y -= 0.07;
     
     // Get world position for consistent waves across chunks
-    vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+    vec3 worldPos = vec3(model * vec4(aPos + aChunkOffset, 1.0));
     
     // Apply sine wave based on world position and time
     float waveHeight = 0.02; // Reduced amplitude for subtler effect
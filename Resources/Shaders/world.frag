@@ -5,6 +5,8 @@ in vec3  FragPos;
 in vec3  Normal;
 in vec3  Tangent;
 in vec3  Bitangent;
+in float AO;
+in vec2  Light;
 
 // Material maps
 uniform sampler2D texture_diffuse1;
@@ -12,16 +14,38 @@ uniform sampler2D texture_normal1;
 uniform sampler2D texture_metallicRoughness1;
 
 // IBL maps
-uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
 uniform sampler2D  brdfLUT;
 
-// Camera
-uniform vec3 camPos;
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
+
+// Diffuse sky light, SH9 of the HDRI projected on the CPU (IrradianceSH, SkyIrradianceUniforms in Shaders.h)
+layout (std140) uniform SkyIrradiance {
+    vec4 irradianceSH[9];
+};
+
+// Irradiance / PI around the normal, what the old irradiance cubemap held
+vec3 skyIrradiance(vec3 n) {
+    vec3 result = irradianceSH[0].rgb
+        + irradianceSH[1].rgb * n.y + irradianceSH[2].rgb * n.z + irradianceSH[3].rgb * n.x
+        + irradianceSH[4].rgb * (n.x * n.y) + irradianceSH[5].rgb * (n.y * n.z) + irradianceSH[6].rgb * (3.0 * n.z * n.z - 1.0)
+        + irradianceSH[7].rgb * (n.x * n.z) + irradianceSH[8].rgb * (n.x * n.x - n.y * n.y);
+    return max(result, vec3(0.0));
+}
 
 // Control
 uniform float alphaThreshold = 0.5;  // discard if alpha < this
-uniform int   debugMode;       // 1=Albedo,2=Normal,3=Metallic,4=Roughness,5=Final
+uniform int   debugMode;       // 1=Albedo,2=Normal,3=Metallic,4=Roughness,5=Final,6=AO,7=Light
+uniform bool  useVertexAO = true; // baked per-vertex AO, off = old flat term
+uniform bool  useVoxelLight = true; // flood fill sky/block light, off = everything fully sky lit
 
 const float PI = 3.14159265359;
 
@@ -78,8 +102,13 @@ void main() {
     float roughness = mrSample.g; // Green channel = roughness
     float metallic = mrSample.b;  // Blue channel = metallic
     
-    // Use AO from texture if available, otherwise use default
-    float ao = 0.8;
+    // Baked per-vertex AO from the mesher (interpolated over the quad), flat term when disabled
+    float ao = useVertexAO ? mix(0.35, 1.0, AO) : 0.8;
+
+    // Flood fill light, every level down is 20% darker. Block light (lava) is a warm orange
+    float skyBrightness = pow(0.8, 15.0 * (1.0 - Light.x));
+    float blockBrightness = Light.y > 0.0 ? pow(0.8, 15.0 * (1.0 - Light.y)) : 0.0;
+    vec3 voxelLight = useVoxelLight ? max(vec3(skyBrightness), blockBrightness * vec3(1.0, 0.8, 0.55)) : vec3(1.0);
     
     // Calculate surface reflection at zero incidence angle
     // For non-metals (dialectics) F0 is 0.04, for metals we use albedo
@@ -89,8 +118,8 @@ void main() {
     vec3 kS = FresnelSchlickRoughness(NdotV, F0, roughness);
     vec3 kD = (1.0 - kS) * (1.0 - metallic); // No diffuse for metals
     
-    // Sample irradiance map with proper intensity scaling
-    vec3 irradiance = texture(irradianceMap, N).rgb;
+    // Diffuse sky light around the normal
+    vec3 irradiance = skyIrradiance(N);
     
     // Fix: Apply intensity correction to avoid over-bright results
     irradiance = min(irradiance, vec3(2.0)); // Clamp super bright irradiance values
@@ -120,7 +149,7 @@ void main() {
     vec3 diffuseIBL_scaled = diffuseIBL * 0.5; // Reduce diffuse intensity
     vec3 specularIBL_scaled = specularIBL * 0.6; // Control specular intensity
     
-    vec3 ambient = (diffuseIBL_scaled + specularIBL_scaled) * ao;
+    vec3 ambient = (diffuseIBL_scaled + specularIBL_scaled) * ao * voxelLight;
     
     // Apply exposure adjustment before tonemapping to fix white tint
     float exposure = 1.0;
@@ -151,6 +180,16 @@ void main() {
         FragColor = vec4(vec3(roughness), albedoSample.a);
         return;
     }
+    else if (debugMode == 6) {
+        // Baked AO
+        FragColor = vec4(vec3(ao), albedoSample.a);
+        return;
+    }
+    else if (debugMode == 7) {
+        // Baked light, sky in green , block light in red
+        FragColor = vec4(Light.y, Light.x, 0.0, albedoSample.a);
+        return;
+    }
     else if (debugMode == 5) {
         // Final PBR+IBL
         FragColor = vec4(color, albedoSample.a);
@@ -5,20 +5,33 @@ layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in vec3 aNormal;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
+layout (location = 5) in float aAO;       // baked corner AO, 0 = occluded .. 1 = open
+layout (location = 6) in vec2 aLight;     // baked smooth light, x = sky , y = block (0 .. 1)
+layout (location = 7) in vec3 aChunkOffset; // world position of the chunk (per draw, chunks share one buffer)
 
 out vec2    TexCoord;
 out vec3    FragPos;    // world-space position
 out vec3    Normal;     // world-space normal
 out vec3    Tangent;    // world-space tangent
 out vec3    Bitangent;  // world-space bitangent
+out float   AO;
+out vec2    Light;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Per frame, shared by the world / water / model programs (FrameUniforms in Shaders.h)
+layout (std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec3  camPos;
+    float time;
+    vec3  lightDir;
+    vec3  lightColor;
+};
 
 void main() {
     // positions
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec4 worldPos = model * vec4(aPos + aChunkOffset, 1.0);
     FragPos = worldPos.xyz;
     gl_Position = projection * view * worldPos;
 
@@ -29,4 +42,6 @@ void main() {
     Bitangent = normalize(normalMatrix * aBitangent);
 
     TexCoord = aTexCoords;
+    AO = aAO;
+    Light = aLight;
 }
@@ -0,0 +1,1528 @@
+/*  voxel_bench : headless benchmark suite for voxel_core
+
+    Every scenario runs on a fixed world seed and fixed query seeds, so two runs on
+    the same host (and the same build type) are directly comparable. The results are
+    printed as JSON (stdout, or --out <file>) to be diffed across commits.
+
+    usage : voxel_bench [--seed N] [--radius R] [--iterations N] [--queries N] [--out file.json]
+*/
+#include "World.h"
+#include "Entity.h"
+#include "LightEngine.h"
+#include "MeshBufferPool.h"
+#include "ChunkPool.h"
+#include "ChunkCuller.h"
+#include "SectionVisibility.h"
+#include "OcclusionBuffer.h"
+#include "RangeAllocator.h"
+#include "SphericalHarmonics.h"
+#include "AnimationClip.h"
+#include "AnimationPose.h"
+#include "AnimationScheduler.h"
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every heap allocation of the process goes through here, scenarios read the counter around
+// the code that's supposed to run without allocating
+static std::atomic<size_t> g_allocations{ 0 };
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+// GCC inlines these into every delete and sees free() on memory from operator new, which is
+// exactly what the replacement pair does
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct BenchConfig {
+    unsigned int seed = 1337;
+    int radius = 4;          // generates a (2R+1)^2 grid of chunks around the origin
+    int iterations = 3;      // repeats for the meshing pass
+    int queries = 1000000;   // getBlockAtPos lookups (rays/collisions use a tenth of that)
+    std::string outPath;
+};
+
+// Minimal JSON writer, flat objects inside one "scenarios" array is all we need
+class JsonReport {
+public:
+    void beginScenario(const std::string& name) {
+        if (!firstScenario) body << ",";
+        firstScenario = false;
+        body << "\n    { \"name\": \"" << name << "\"";
+        scenario = name;
+    }
+    void field(const std::string& key, double value) {
+        body << ", \"" << key << "\": " << value;
+    }
+    void field(const std::string& key, bool value) {
+        body << ", \"" << key << "\": " << (value ? "true" : "false");
+    }
+    // Correctness field : false also fails the run (non zero exit), not just a value nobody reads
+    void check(const std::string& key, bool value) {
+        field(key, value);
+        if (!value) failedChecks.push_back(scenario + "." + key);
+    }
+    void endScenario() { body << " }"; }
+
+    const std::vector<std::string>& failures() const { return failedChecks; }
+
+    std::string str(const BenchConfig& cfg) const {
+        std::ostringstream out;
+        out << "{\n  \"bench\": \"voxel_bench\",\n"
+            << "  \"seed\": " << cfg.seed << ",\n"
+            << "  \"radius\": " << cfg.radius << ",\n"
+            << "  \"compiler\": \"" << compilerName() << "\",\n"
+#ifdef NDEBUG
+            << "  \"build\": \"release\",\n"
+#else
+            << "  \"build\": \"debug\",\n"
+#endif
+            << "  \"scenarios\": [" << body.str() << "\n  ]\n}\n";
+        return out.str();
+    }
+
+private:
+    std::ostringstream body;
+    bool firstScenario = true;
+    std::string scenario;
+    std::vector<std::string> failedChecks;
+
+    static std::string compilerName() {
+#if defined(__clang__)
+        return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+};
+
+std::vector<glm::ivec3> chunkGrid(int radius) {
+    std::vector<glm::ivec3> positions;
+    for (int x = -radius; x <= radius; ++x) {
+        for (int z = -radius; z <= radius; ++z) {
+            positions.push_back({ x * CHUNK_SIZE, -BASE_GROUND_HEIGHT, z * CHUNK_SIZE });
+        }
+    }
+    return positions;
+}
+
+// 1) World generation : generateChunkData for every chunk of the grid
+std::vector<std::shared_ptr<Chunk>> benchGenerate(World& world, const BenchConfig& cfg, JsonReport& report) {
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    auto positions = chunkGrid(cfg.radius);
+
+    auto start = Clock::now();
+    for (const auto& pos : positions) {
+        auto chunk = std::make_shared<Chunk>(pos);
+        world.generateChunkData(*chunk);
+        chunks.push_back(chunk);
+    }
+    double totalMs = msSince(start);
+
+    report.beginScenario("generate");
+    report.field("chunks", static_cast<double>(chunks.size()));
+    report.field("total_ms", totalMs);
+    report.field("ms_per_chunk", totalMs / chunks.size());
+    report.field("chunks_per_sec", chunks.size() / (totalMs / 1000.0));
+    report.endScenario();
+    return chunks;
+}
+
+// Every light value of the grid, to compare the incremental result against a relight from scratch
+std::vector<uint8_t> snapshotLight(const std::vector<std::shared_ptr<Chunk>>& chunks) {
+    const uint32_t cells = CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH;
+    std::vector<uint8_t> packed;
+    packed.reserve(chunks.size() * cells);
+    for (const auto& chunk : chunks) {
+        for (uint32_t i = 0; i < cells; ++i) packed.push_back(chunk->light.getPacked(i));
+    }
+    return packed;
+}
+
+// 1b) Lighting : initial flood fill of every chunk, stitching them together on insert, then
+// incremental relights of block edits (digging + lava) against relighting from scratch
+void benchLighting(World& world, std::vector<std::shared_ptr<Chunk>>& chunks, const BenchConfig& cfg, JsonReport& report) {
+    auto start = Clock::now();
+    for (auto& chunk : chunks) LightEngine::lightNewChunk(*chunk);
+    double lightMs = msSince(start);
+
+    size_t sections = 0;
+    for (auto& chunk : chunks) sections += chunk->light.allocatedSections();
+
+    start = Clock::now();
+    for (auto& chunk : chunks) world.insertChunk(chunk);
+    double insertMs = msSince(start);
+
+    const int edits = 64;
+    std::mt19937 rng(cfg.seed + 2);
+    std::uniform_int_distribution<size_t> pickChunk(0, chunks.size() - 1);
+    std::uniform_int_distribution<int> local(0, CHUNK_SIZE - 1);
+    std::uniform_int_distribution<int> height(40, 140);
+
+    size_t nodesBefore = world.getLightNodesProcessed();
+    double editMs = 0.0, worstEditMs = 0.0;
+    for (int i = 0; i < edits; ++i) {
+        glm::ivec3 pos = glm::ivec3(chunks[pickChunk(rng)]->getPosition()) + glm::ivec3(local(rng), height(rng), local(rng));
+        auto edit = Clock::now();
+        world.editBlock(pos, (i % 4 == 3) ? Block::Type::LAVA : Block::Type::AIR);
+        double ms = msSince(edit);
+        editMs += ms;
+        worstEditMs = std::max(worstEditMs, ms);
+    }
+    size_t editNodes = world.getLightNodesProcessed() - nodesBefore;
+
+    // Same grid relit from scratch must land on exactly the same values
+    std::vector<uint8_t> incremental = snapshotLight(chunks);
+    LightEngine fresh;
+    for (auto& chunk : chunks) LightEngine::lightNewChunk(*chunk);
+    for (auto& chunk : chunks) fresh.stitchNewChunk(*chunk);
+    fresh.propagate();
+    std::vector<std::pair<Chunk*, uint32_t>> freshDirty;
+    fresh.takeDirtyChunks(freshDirty); // Nothing to remesh here, the values are the same
+    bool matches = incremental == snapshotLight(chunks);
+
+    report.beginScenario("lighting");
+    report.field("chunks", static_cast<double>(chunks.size()));
+    report.field("light_ms_per_chunk", lightMs / chunks.size());
+    report.field("allocated_sections_per_chunk", static_cast<double>(sections) / chunks.size());
+    report.field("insert_stitch_ms_per_chunk", insertMs / chunks.size());
+    report.field("edits", static_cast<double>(edits));
+    report.field("edit_ms", editMs / edits);
+    report.field("worst_edit_ms", worstEditMs);
+    report.field("edit_nodes", static_cast<double>(editNodes) / edits);
+    report.field("incremental_matches_full_relight", matches);
+    report.endScenario();
+}
+
+// 2) Meshing : both passes (solid + liquid) over the whole grid, neighbours linked
+void benchMesh(std::vector<std::shared_ptr<Chunk>>& chunks, const BenchConfig& cfg, JsonReport& report) {
+    double bestMs = 0.0, sumMs = 0.0;
+    size_t faces = 0, vertices = 0;
+
+    for (int it = 0; it < cfg.iterations; ++it) {
+        faces = 0;
+        vertices = 0;
+        auto start = Clock::now();
+        for (auto& chunk : chunks) {
+            chunk->generateMeshData();
+            faces += chunk->getIndexCount() / 6;
+            vertices += chunk->getVertexCount();
+        }
+        double ms = msSince(start);
+        sumMs += ms;
+        if (it == 0 || ms < bestMs) bestMs = ms;
+    }
+
+    report.beginScenario("mesh");
+    report.field("chunks", static_cast<double>(chunks.size()));
+    report.field("iterations", static_cast<double>(cfg.iterations));
+    report.field("best_ms", bestMs);
+    report.field("mean_ms", sumMs / cfg.iterations);
+    report.field("ms_per_chunk", bestMs / chunks.size());
+    report.field("faces", static_cast<double>(faces));
+    report.field("faces_per_sec", faces / (bestMs / 1000.0));
+    report.field("vertices_per_chunk", static_cast<double>(vertices) / chunks.size());
+    report.endScenario();
+}
+
+// 3) Storage : save + load round trip of every chunk through the on-disk format
+void benchStorage(std::vector<std::shared_ptr<Chunk>>& chunks, JsonReport& report) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "voxel_bench_chunks";
+    fs::create_directories(dir);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i]->saveToDisk((dir / (std::to_string(i) + ".chunk")).string());
+    }
+    double saveMs = msSince(start);
+
+    std::vector<std::shared_ptr<Chunk>> loaded;
+    start = Clock::now();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto chunk = std::make_shared<Chunk>(chunks[i]->getPosition());
+        chunk->loadFromDisk((dir / (std::to_string(i) + ".chunk")).string());
+        loaded.push_back(chunk);
+    }
+    double loadMs = msSince(start);
+
+    bool roundTripOk = true;
+    for (size_t i = 0; i < chunks.size() && roundTripOk; ++i) {
+        for (int y = 0; y < CHUNK_DEPTH && roundTripOk; ++y)
+            for (int z = 0; z < CHUNK_SIZE && roundTripOk; ++z)
+                for (int x = 0; x < CHUNK_SIZE; ++x)
+                    if (chunks[i]->getBlockType(x, z, y) != loaded[i]->getBlockType(x, z, y)) {
+                        roundTripOk = false;
+                        break;
+                    }
+    }
+
+    uintmax_t bytes = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) bytes += entry.file_size();
+    fs::remove_all(dir);
+
+    report.beginScenario("storage");
+    report.field("chunks", static_cast<double>(chunks.size()));
+    report.field("bytes_per_chunk", static_cast<double>(bytes) / chunks.size());
+    report.field("save_ms_per_chunk", saveMs / chunks.size());
+    report.field("load_ms_per_chunk", loadMs / chunks.size());
+    report.field("save_mb_per_sec", (bytes / (1024.0 * 1024.0)) / (saveMs / 1000.0));
+    report.field("load_mb_per_sec", (bytes / (1024.0 * 1024.0)) / (loadMs / 1000.0));
+    report.field("roundtrip_ok", roundTripOk);
+    report.endScenario();
+}
+
+// 3b) Mesh memory : CPU bytes behind a chunk's meshes. The Chunk constructor used to reserve room
+// for 25k faces it never used, and the built meshes used to stay on the CPU after the upload.
+// Two rounds of remeshes through the pool (the second one runs on recycled buffers), then every
+// section patched into the released meshes must stage the same data a full build has
+void benchMeshMemory(std::vector<std::shared_ptr<Chunk>>& chunks, JsonReport& report) {
+    const double oldFaces = 2 * CHUNK_SIZE * CHUNK_SIZE + 4 * CHUNK_SIZE * CHUNK_DEPTH;
+    const double oldReserveBytes = oldFaces * 4 * sizeof(CompactVertex) + oldFaces * 6 * sizeof(uint32_t);
+
+    MeshBufferPool pool;
+    size_t builtBytes = 0, residentBytes = 0;
+    MeshBufferPool::Stats firstRound;
+    for (int round = 0; round < 2; ++round) {
+        builtBytes = residentBytes = 0;
+        for (auto& chunk : chunks) {
+            chunk->generatePendingMeshData(&pool);
+            chunk->swapPendingMesh(&pool);
+            builtBytes += chunk->SolidMesh.cpuBytes() + chunk->LiquidMesh.cpuBytes();
+            chunk->releaseCpuMeshes(&pool); // What World does right after the upload
+            residentBytes += chunk->SolidMesh.cpuBytes() + chunk->LiquidMesh.cpuBytes();
+        }
+        if (round == 0) firstRound = pool.getStats();
+    }
+    MeshBufferPool::Stats stats = pool.getStats();
+    double secondRoundHitRate = static_cast<double>(stats.hits - firstRound.hits) /
+        std::max<size_t>(1, (stats.hits + stats.misses) - (firstRound.hits + firstRound.misses));
+
+    bool stagedMatch = true;
+    SectionMesh solidScratch, liquidScratch;
+    for (auto& chunk : chunks) {
+        chunk->generateMeshData();
+        MeshData reference = chunk->SolidMesh;
+        chunk->releaseCpuMeshes(&pool);
+
+        chunk->generatePendingSections(ALL_CHUNK_SECTIONS, solidScratch, liquidScratch);
+        chunk->swapPendingMesh(&pool);
+        stagedMatch = stagedMatch && !chunk->needsFullRemesh;
+        for (int s = 0; s < CHUNK_SECTION_COUNT; ++s) {
+            const MeshRange& range = reference.sections[s];
+            stagedMatch = stagedMatch &&
+                std::memcmp(chunk->SolidMesh.sectionVertices(s), &reference.vertices[range.firstVertex], range.vertexCount * sizeof(CompactVertex)) == 0 &&
+                std::memcmp(chunk->SolidMesh.sectionIndices(s), &reference.indices[range.firstIndex], range.indexCapacity * sizeof(uint32_t)) == 0;
+        }
+        chunk->generateMeshData(); // Back to resident meshes for the scenarios after this one
+    }
+
+    // A patch that empties a section of a released mesh (the only block in it broken) stages no
+    // vertices but a whole slot of degenerate indices, that slot and its dirty bit have to
+    // survive the release after an upload that didn't happen yet
+    bool emptiedSectionStaged = true, firstBlockPatched = false;
+    {
+        Chunk lone(glm::ivec3(0));
+        const glm::ivec3 block(8, 200, 8);
+        const int section = block.y / CHUNK_SECTION_SIZE;
+        lone.setBlock(block, Block::Type::STONE);
+        lone.generateMeshData();
+        const MeshRange range = lone.SolidMesh.sections[section];
+        lone.releaseCpuMeshes(&pool);
+
+        lone.setBlock(block, Block::Type::AIR);
+        lone.generatePendingSections(Chunk::sectionsTouchedBy(block), solidScratch, liquidScratch);
+        lone.swapPendingMesh(&pool);
+        lone.releaseCpuMeshes(&pool); // Nothing uploaded in between : must keep the staging
+        const MeshData& mesh = lone.SolidMesh;
+        emptiedSectionStaged = !lone.needsFullRemesh && range.indexCapacity > 0 &&
+            (mesh.dirtySections & (1u << section)) && mesh.sections[section].vertexCount == 0 &&
+            mesh.indices.size() >= mesh.staged[section].indexOffset + range.indexCapacity;
+        for (unsigned int i = 0; emptiedSectionStaged && i < range.indexCapacity; ++i)
+            emptiedSectionStaged = mesh.sectionIndices(section)[i] == range.firstVertex;
+
+        // First block in the empty section above : has slack, patched in place (no full remesh)
+        const glm::ivec3 above = block + glm::ivec3(0, CHUNK_SECTION_SIZE, 0);
+        lone.setBlock(above, Block::Type::STONE);
+        lone.generatePendingSections(Chunk::sectionsTouchedBy(above), solidScratch, liquidScratch);
+        lone.swapPendingMesh(&pool);
+        firstBlockPatched = !lone.needsFullRemesh && lone.SolidMesh.sections[section + 1].vertexCount > 0;
+    }
+
+    report.beginScenario("mesh_memory");
+    report.field("removed_reserve_bytes_per_chunk", oldReserveBytes);
+    report.field("built_mesh_bytes_per_chunk", static_cast<double>(builtBytes) / chunks.size());
+    report.field("resident_mesh_bytes_per_chunk", static_cast<double>(residentBytes) / chunks.size());
+    report.field("pool_second_round_hit_rate", secondRoundHitRate);
+    report.field("pool_dropped", static_cast<double>(stats.dropped));
+    report.field("pooled_bytes", static_cast<double>(stats.pooledBytes));
+    report.field("staged_patches_match_full_build", stagedMatch);
+    report.field("emptied_section_staged", emptiedSectionStaged);
+    report.field("first_block_in_empty_section_patched", firstBlockPatched);
+    report.endScenario();
+}
+
+// 3c) Chunk pool : walking simulation over a window of loaded chunks, every step evicts the
+// oldest one and loads a new one (stone up to y 64 stands in for the terrain generator).
+// make_shared per load like the streaming thread used to do, against recycling through ChunkPool
+void benchChunkPool(JsonReport& report) {
+    const int window = 81;
+    const int steps = 512;
+    auto fillTerrain = [](Chunk& chunk) {
+        for (int y = 0; y < 64; ++y)
+            for (int z = 0; z < CHUNK_SIZE; ++z)
+                for (int x = 0; x < CHUNK_SIZE; ++x) chunk.setBlock({ x, y, z }, Block::Type::STONE);
+    };
+    auto positionOf = [](int i) { return glm::ivec3(i * CHUNK_SIZE, -BASE_GROUND_HEIGHT, 0); };
+
+    std::deque<std::shared_ptr<Chunk>> live;
+    for (int i = 0; i < window; ++i) live.push_back(std::make_shared<Chunk>(positionOf(i)));
+    auto start = Clock::now();
+    for (int i = 0; i < steps; ++i) {
+        live.pop_front();
+        live.push_back(std::make_shared<Chunk>(positionOf(window + i)));
+        fillTerrain(*live.back());
+    }
+    double allocMs = msSince(start);
+    live.clear();
+
+    ChunkPool pool;
+    for (int i = 0; i < window; ++i) live.push_back(pool.acquire(positionOf(i)));
+    start = Clock::now();
+    for (int i = 0; i < steps; ++i) {
+        pool.recycle(std::move(live.front()), nullptr);
+        live.pop_front();
+        live.push_back(pool.acquire(positionOf(window + i)));
+        fillTerrain(*live.back());
+    }
+    double poolMs = msSince(start);
+    ChunkPool::Stats stats = pool.getStats();
+
+    report.beginScenario("chunk_pool");
+    report.field("loads", static_cast<double>(steps));
+    report.field("make_shared_ms_per_load", allocMs / steps);
+    report.field("pooled_ms_per_load", poolMs / steps);
+    report.field("hit_rate", stats.hitRate());
+    report.field("high_water_mark", static_cast<double>(pool.getHighWaterMark()));
+    report.field("dropped", static_cast<double>(stats.dropped));
+    report.endScenario();
+}
+
+// 3d) Frustum culling : the meshed grid seen from its centre in 8 directions, culled per whole
+// chunk column vs per section slice (tightened in y). Then the raw plane test on a big batch
+// of boxes, SSE against one box at a time, with a check that both agree
+void benchFrustum(std::vector<std::shared_ptr<Chunk>>& chunks, JsonReport& report) {
+    std::vector<Chunk*> candidates;
+    for (auto& chunk : chunks) candidates.push_back(chunk.get());
+
+    glm::vec3 eye(CHUNK_SIZE * 0.5f, 90.0f - BASE_GROUND_HEIGHT, CHUNK_SIZE * 0.5f);
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+    ChunkCuller culler;
+    BoxList columns;
+    std::vector<uint8_t> columnVisible;
+    size_t slicesTested = 0, slicesDrawn = 0, columnsDrawn = 0, chunksDrawn = 0;
+    double cullMs = 0.0;
+    const int directions = 8;
+    for (int d = 0; d < directions; ++d) {
+        float yaw = glm::two_pi<float>() * d / directions;
+        glm::vec3 forward(std::cos(yaw), -0.3f, std::sin(yaw));
+        glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        auto start = Clock::now();
+        culler.setCaveCulling(false);
+        culler.setOcclusionCulling(false);
+        culler.cull(viewProjection, eye, candidates);
+        cullMs += msSince(start);
+        slicesTested += culler.getStats().slicesTested;
+        slicesDrawn += culler.getStats().slicesDrawn;
+        chunksDrawn += culler.getStats().chunksDrawn;
+
+        // What one full height box per chunk would have kept
+        columns.clear();
+        for (Chunk* chunk : candidates) {
+            glm::vec3 origin = chunk->getPosition();
+            columns.add(origin, origin + glm::vec3(CHUNK_SIZE, CHUNK_DEPTH, CHUNK_SIZE));
+        }
+        cullBoxes(Frustum::fromViewProjection(viewProjection), columns, columnVisible);
+        for (uint8_t v : columnVisible) columnsDrawn += v;
+    }
+
+    // Raw plane test, boxes scattered over a render distance of 32
+    const int boxCount = 1 << 16;
+    const int repeats = 50;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> spread(-512.0f, 512.0f);
+    std::uniform_real_distribution<float> height(0.0f, 368.0f);
+    BoxList boxes;
+    for (int i = 0; i < boxCount; ++i) {
+        glm::vec3 min(spread(rng), height(rng) - BASE_GROUND_HEIGHT, spread(rng));
+        boxes.add(min, min + glm::vec3(16.0f));
+    }
+    Frustum frustum = Frustum::fromViewProjection(projection * glm::lookAt(eye, eye + glm::vec3(1.0f, -0.2f, 0.3f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    std::vector<uint8_t> simd, scalar;
+    auto start = Clock::now();
+    for (int r = 0; r < repeats; ++r) cullBoxes(frustum, boxes, simd);
+    double simdMs = msSince(start);
+    start = Clock::now();
+    for (int r = 0; r < repeats; ++r) cullBoxesScalar(frustum, boxes, scalar);
+    double scalarMs = msSince(start);
+
+    double columnTotal = static_cast<double>(candidates.size()) * directions;
+    report.beginScenario("frustum");
+    report.field("chunks", static_cast<double>(candidates.size()));
+    report.field("column_culled_fraction", 1.0 - columnsDrawn / columnTotal);
+    report.field("chunk_culled_fraction", 1.0 - chunksDrawn / columnTotal);
+    report.field("slices_per_chunk", static_cast<double>(slicesTested) / columnTotal);
+    report.field("slice_culled_fraction", slicesTested ? 1.0 - static_cast<double>(slicesDrawn) / slicesTested : 0.0);
+    report.field("cull_ms_per_frame", cullMs / directions);
+    report.field("simd_ns_per_box", simdMs * 1e6 / (static_cast<double>(boxCount) * repeats));
+    report.field("scalar_ns_per_box", scalarMs * 1e6 / (static_cast<double>(boxCount) * repeats));
+    report.field("simd_matches_scalar", simd == scalar);
+    report.endScenario();
+}
+
+// 3e) Cave culling : cost of the per section connectivity flood fill, then the slices drawn with
+// the frustum alone vs frustum + cave culling, from above the surface and from inside the rock
+// at the centre of the grid (8 view directions each)
+void benchCaveCulling(std::vector<std::shared_ptr<Chunk>>& chunks, JsonReport& report) {
+    std::vector<Chunk*> candidates;
+    Chunk* centre = nullptr;
+    for (auto& chunk : chunks) {
+        candidates.push_back(chunk.get());
+        glm::vec3 pos = chunk->getPosition();
+        if (pos.x == 0.0f && pos.z == 0.0f) centre = chunk.get();
+    }
+    if (!centre) centre = candidates.front();
+
+    auto start = Clock::now();
+    uint32_t checksum = 0;
+    for (Chunk* chunk : candidates) {
+        for (int s = 0; s < CHUNK_SECTION_COUNT; ++s) checksum += SectionVisibility::compute(*chunk, s);
+    }
+    double visibilityMs = msSince(start);
+    size_t sectionCount = candidates.size() * CHUNK_SECTION_COUNT;
+
+    int surface = CHUNK_DEPTH - 1;
+    while (surface > 0 && !Block::occludesView(centre->getBlockType(8, 8, surface))) --surface;
+    glm::vec3 origin = centre->getPosition();
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+    ChunkCuller culler;
+    culler.setOcclusionCulling(false);
+    auto run = [&](const glm::vec3& eye, bool cave, size_t& drawn, size_t& visited, double& ms) {
+        drawn = visited = 0;
+        ms = 0.0;
+        culler.setCaveCulling(cave);
+        const int directions = 8;
+        for (int d = 0; d < directions; ++d) {
+            float yaw = glm::two_pi<float>() * d / directions;
+            glm::vec3 forward(std::cos(yaw), -0.2f, std::sin(yaw));
+            glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+            auto frame = Clock::now();
+            culler.cull(viewProjection, eye, candidates);
+            ms += msSince(frame) / directions;
+            drawn += culler.getStats().slicesDrawn;
+            visited += culler.getStats().sectionsVisited;
+        }
+    };
+
+    glm::vec3 aboveGround = origin + glm::vec3(8.5f, surface + 3.5f, 8.5f);
+    glm::vec3 underground = origin + glm::vec3(8.5f, std::max(surface / 3, 1) + 0.5f, 8.5f);
+    size_t surfaceFrustum, surfaceCave, undergroundFrustum, undergroundCave, visited, unused;
+    double frustumMs, caveMs, ms;
+    run(aboveGround, false, surfaceFrustum, unused, ms);
+    run(aboveGround, true, surfaceCave, unused, ms);
+    run(underground, false, undergroundFrustum, unused, frustumMs);
+    run(underground, true, undergroundCave, visited, caveMs);
+
+    report.beginScenario("cave_culling");
+    report.field("visibility_us_per_section", visibilityMs * 1000.0 / sectionCount);
+    report.field("visibility_checksum", static_cast<double>(checksum));
+    report.field("surface_slices_frustum", static_cast<double>(surfaceFrustum) / 8);
+    report.field("surface_slices_cave", static_cast<double>(surfaceCave) / 8);
+    report.field("underground_slices_frustum", static_cast<double>(undergroundFrustum) / 8);
+    report.field("underground_slices_cave", static_cast<double>(undergroundCave) / 8);
+    report.field("underground_bfs_sections", static_cast<double>(visited) / 8);
+    report.field("frustum_cull_ms", frustumMs);
+    report.field("cave_cull_ms", caveMs);
+    report.endScenario();
+}
+
+// 3f) Occlusion buffer : synthetic scenes first (a wall with boxes behind, in front, above and
+// sticking out past its edge, expected results known up front), same depth buffer from 1 and 4
+// threads, then the culler on the grid from just above the surface (8 view directions)
+void benchOcclusion(std::vector<std::shared_ptr<Chunk>>& chunks, JsonReport& report) {
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+    glm::vec3 eye(0.0f, 10.0f, 0.0f);
+    glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    OcclusionBuffer buffer;
+    buffer.beginFrame(viewProjection, eye);
+    buffer.addOccluder(glm::vec3(-10.0f, 0.0f, 20.0f), glm::vec3(10.0f, 20.0f, 22.0f));
+    buffer.rasterize(1);
+    buffer.buildHiZ();
+    bool syntheticOk =
+        !buffer.isVisible(glm::vec3(-4.0f, 6.0f, 60.0f), glm::vec3(4.0f, 14.0f, 64.0f)) &&  // Right behind
+        buffer.isVisible(glm::vec3(-4.0f, 6.0f, 5.0f), glm::vec3(4.0f, 14.0f, 10.0f)) &&    // In front
+        buffer.isVisible(glm::vec3(-4.0f, 45.0f, 60.0f), glm::vec3(4.0f, 53.0f, 64.0f)) &&  // Above the top edge
+        buffer.isVisible(glm::vec3(25.0f, 6.0f, 60.0f), glm::vec3(45.0f, 14.0f, 64.0f));    // Past the side
+    std::vector<float> singleThread = buffer.getDepth();
+    buffer.rasterize(4);
+    bool threadsMatch = singleThread == buffer.getDepth();
+
+    std::vector<Chunk*> candidates;
+    Chunk* centre = nullptr;
+    for (auto& chunk : chunks) {
+        candidates.push_back(chunk.get());
+        glm::vec3 pos = chunk->getPosition();
+        if (pos.x == 0.0f && pos.z == 0.0f) centre = chunk.get();
+    }
+    if (!centre) centre = candidates.front();
+    int surface = CHUNK_DEPTH - 1;
+    while (surface > 0 && !Block::occludesView(centre->getBlockType(8, 8, surface))) --surface;
+    glm::vec3 groundEye = centre->getPosition() + glm::vec3(8.5f, surface + 2.6f, 8.5f);
+
+    ChunkCuller culler;
+    auto run = [&](bool cave, bool occlusion, int threads, size_t& drawn, size_t& triangles, double& rasterMs, double& cullMs) {
+        drawn = triangles = 0;
+        rasterMs = cullMs = 0.0;
+        culler.setCaveCulling(cave);
+        culler.setOcclusionCulling(occlusion);
+        culler.setOcclusionThreads(threads);
+        const int directions = 8;
+        for (int d = 0; d < directions; ++d) {
+            float yaw = glm::two_pi<float>() * d / directions;
+            glm::vec3 forward(std::cos(yaw), -0.1f, std::sin(yaw));
+            glm::mat4 vp = projection * glm::lookAt(groundEye, groundEye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+            auto frame = Clock::now();
+            culler.cull(vp, groundEye, candidates);
+            cullMs += msSince(frame) / directions;
+            rasterMs += culler.getStats().occlusionMs / directions;
+            drawn += culler.getStats().slicesDrawn;
+            triangles += culler.getStats().occluderTriangles;
+        }
+    };
+    size_t frustumDrawn, frustumOcclusionDrawn, withoutDrawn, drawn, triangles, unused;
+    double cullMs, rasterMs, threadedCullMs, threadedRasterMs, ms;
+    run(false, false, 1, frustumDrawn, unused, ms, ms);
+    run(false, true, 1, frustumOcclusionDrawn, unused, ms, ms);
+    run(true, false, 1, withoutDrawn, unused, ms, ms);
+    run(true, true, 1, drawn, triangles, rasterMs, cullMs);
+    run(true, true, 4, unused, unused, threadedRasterMs, threadedCullMs);
+
+    report.beginScenario("occlusion");
+    report.field("synthetic_scene_ok", syntheticOk);
+    report.field("threads_match_single", threadsMatch);
+    report.field("buffer_width", static_cast<double>(buffer.getWidth()));
+    report.field("buffer_height", static_cast<double>(buffer.getHeight()));
+    report.field("occlusion_rate_over_frustum", frustumDrawn ? 1.0 - static_cast<double>(frustumOcclusionDrawn) / frustumDrawn : 0.0);
+    report.field("slices_without_occlusion", static_cast<double>(withoutDrawn) / 8);
+    report.field("slices_with_occlusion", static_cast<double>(drawn) / 8);
+    report.field("occlusion_rate_over_cave", withoutDrawn ? 1.0 - static_cast<double>(drawn) / withoutDrawn : 0.0);
+    report.field("occluder_triangles", static_cast<double>(triangles) / 8);
+    report.field("raster_ms_1_thread", rasterMs);
+    report.field("raster_ms_4_threads", threadedRasterMs);
+    report.field("cull_ms_per_frame", cullMs);
+    report.endScenario();
+}
+
+// Mesh arena : the sub-allocator ChunkRenderer keeps every mesh in, churned with the real mesh
+// sizes of the grid (loads, remeshes that grow / shrink, evictions). Same alignment and doubling
+// as the renderer, starting at a quarter of what the grid needs so the growth path runs too
+void benchMeshArena(const std::vector<std::shared_ptr<Chunk>>& chunks, const BenchConfig& cfg, JsonReport& report) {
+    const uint32_t alignment = 256;
+    std::vector<uint32_t> sizes;
+    uint64_t totalVertices = 0;
+    for (const auto& chunk : chunks) {
+        for (const MeshData* mesh : { &chunk->SolidMesh, &chunk->LiquidMesh }) {
+            if (mesh->vertexcount == 0) continue;
+            sizes.push_back(static_cast<uint32_t>(mesh->vertexcount));
+            totalVertices += mesh->vertexcount;
+        }
+    }
+
+    RangeAllocator arena(static_cast<uint32_t>(std::max<uint64_t>(alignment, totalVertices / 4)), alignment);
+    std::vector<RangeAllocator::Range> slots(sizes.size() * 2); // room for meshes that come and go
+    size_t growths = 0;
+    auto allocate = [&](uint32_t size) {
+        RangeAllocator::Range range = arena.allocate(size);
+        if (!range.valid()) {
+            arena.grow(std::max(arena.getCapacity() * 2, arena.getCapacity() + size + alignment));
+            ++growths;
+            range = arena.allocate(size);
+        }
+        return range;
+    };
+
+    std::mt19937 rng(cfg.seed + 5);
+    std::uniform_int_distribution<size_t> pickSlot(0, slots.size() - 1);
+    std::uniform_int_distribution<size_t> pickSize(0, sizes.size() - 1);
+    std::uniform_real_distribution<float> remeshScale(0.8f, 1.25f);
+    std::uniform_int_distribution<int> action(0, 3);
+
+    const int operations = 200000;
+    double peakFragmentation = 0.0;
+    size_t remeshesInPlace = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < operations; ++i) {
+        RangeAllocator::Range& slot = slots[pickSlot(rng)];
+        if (!slot.valid()) {
+            slot = allocate(sizes[pickSize(rng)]);
+        }
+        else if (action(rng) == 0) {
+            arena.free(slot); // Evicted
+        }
+        else {
+            // Remesh, the range is kept while the new mesh still fits (ChunkRenderer::uploadMesh)
+            uint32_t size = std::max(1u, static_cast<uint32_t>(slot.size * remeshScale(rng)));
+            if (size <= slot.size) {
+                ++remeshesInPlace;
+                continue;
+            }
+            arena.free(slot);
+            slot = allocate(size);
+        }
+        if ((i & 1023) == 0) peakFragmentation = std::max(peakFragmentation, arena.getFragmentation());
+    }
+    double ms = msSince(start);
+
+    // Live ranges never overlap and stay inside the arena
+    std::vector<RangeAllocator::Range> live;
+    uint64_t liveSize = 0;
+    for (const auto& slot : slots) {
+        if (!slot.valid()) continue;
+        live.push_back(slot);
+        liveSize += slot.size;
+    }
+    std::sort(live.begin(), live.end(), [](const RangeAllocator::Range& a, const RangeAllocator::Range& b) { return a.offset < b.offset; });
+    bool consistent = liveSize == arena.getUsed();
+    for (size_t i = 0; i < live.size(); ++i) {
+        if (live[i].offset + live[i].size > arena.getCapacity()) consistent = false;
+        if (i > 0 && live[i - 1].offset + live[i - 1].size > live[i].offset) consistent = false;
+    }
+
+    RangeAllocator::Stats stats = arena.getStats();
+    report.beginScenario("mesh_arena");
+    report.field("mesh_sizes", static_cast<double>(sizes.size()));
+    report.field("operations", static_cast<double>(operations));
+    report.field("ns_per_operation", ms * 1e6 / operations);
+    report.field("allocations", static_cast<double>(stats.allocations));
+    report.field("frees", static_cast<double>(stats.frees));
+    report.field("remeshes_in_place", static_cast<double>(remeshesInPlace));
+    report.field("growths", static_cast<double>(growths));
+    report.field("capacity_vertices", static_cast<double>(arena.getCapacity()));
+    report.field("utilization", static_cast<double>(arena.getUsed()) / arena.getCapacity());
+    report.field("free_blocks", static_cast<double>(stats.freeBlocks));
+    report.field("peak_fragmentation", peakFragmentation);
+    report.field("final_fragmentation", arena.getFragmentation());
+    report.field("ranges_consistent", consistent);
+    report.endScenario();
+}
+
+// Render list : what the render loop pays per frame to get the chunks to draw. The old loop copied
+// chunkCache (hash map + a shared_ptr refcount per chunk), the published list is one atomic load
+// and only gets rebuilt when the set of chunks changes
+void benchRenderList(World& world, JsonReport& report) {
+    const int frames = 2000;
+    world.invalidateRenderList();
+    auto start = Clock::now();
+    world.publishRenderList();
+    double rebuildMs = msSince(start);
+
+    size_t copied = 0;
+    start = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        auto snapshot = world.chunkCache;
+        for (const auto& entry : snapshot) {
+            if (entry.second.chunk && entry.second.chunk->isActive()) ++copied;
+        }
+    }
+    double copyMs = msSince(start);
+
+    size_t listed = 0;
+    uint64_t firstVersion = world.getRenderList()->version;
+    bool versionStable = true;
+    start = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        world.publishRenderList(); // Nothing changed -> no rebuild, same version
+        std::shared_ptr<const RenderList> list = world.getRenderList();
+        versionStable = versionStable && list->version == firstVersion;
+        for (Chunk* chunk : list->chunks) {
+            if (chunk->isActive()) ++listed;
+        }
+    }
+    double listMs = msSince(start);
+
+    report.beginScenario("render_list");
+    report.field("chunks", static_cast<double>(world.getRenderList()->chunks.size()));
+    report.field("copy_us_per_frame", copyMs * 1000.0 / frames);
+    report.field("list_us_per_frame", listMs * 1000.0 / frames);
+    report.field("rebuild_us", rebuildMs * 1000.0);
+    report.field("same_chunks", copied == listed);
+    report.field("version_stable", versionStable);
+    report.endScenario();
+}
+
+// 4) Queries : block lookups, raycasts and entity collision against the loaded grid
+void benchQueries(World& world, const BenchConfig& cfg, JsonReport& report) {
+    const float extent = static_cast<float>(cfg.radius * CHUNK_SIZE);
+    std::mt19937 rng(cfg.seed);
+    std::uniform_real_distribution<float> horizontal(-extent, extent);
+    std::uniform_real_distribution<float> vertical(40.0f, 140.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // getBlockAtPos
+    std::vector<glm::ivec3> blockQueries(cfg.queries);
+    for (auto& q : blockQueries) q = glm::ivec3(glm::floor(glm::vec3(horizontal(rng), vertical(rng), horizontal(rng))));
+
+    size_t solid = 0;
+    auto start = Clock::now();
+    for (const auto& q : blockQueries) {
+        if (world.getBlockAtPos(q) != Block::Type::AIR) ++solid;
+    }
+    double blockMs = msSince(start);
+
+    // Raycasts (same reach as the block interaction)
+    const int rayCount = std::max(1, cfg.queries / 10);
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays(rayCount);
+    for (auto& r : rays) {
+        glm::vec3 dir(unit(rng), unit(rng), unit(rng));
+        if (glm::length(dir) < 1e-3f) dir = glm::vec3(0.0f, -1.0f, 0.0f);
+        r = { glm::vec3(horizontal(rng), vertical(rng), horizontal(rng)), glm::normalize(dir) };
+    }
+
+    size_t hits = 0;
+    start = Clock::now();
+    for (const auto& r : rays) {
+        if (World::RayCaster::castRay(r.first, r.second, 5.0f, world.chunkCache).hit) ++hits;
+    }
+    double rayMs = msSince(start);
+
+    // Entity vs block collision
+    Entity probe(&world);
+    std::vector<glm::vec3> probes(rayCount);
+    for (auto& p : probes) p = glm::vec3(horizontal(rng), vertical(rng), horizontal(rng));
+
+    size_t collisions = 0;
+    start = Clock::now();
+    for (const auto& p : probes) {
+        glm::vec3 normal;
+        if (probe.checkBlockCollision(p, normal)) ++collisions;
+    }
+    double collisionMs = msSince(start);
+
+    report.beginScenario("queries");
+    report.field("block_queries", static_cast<double>(blockQueries.size()));
+    report.field("block_queries_per_sec", blockQueries.size() / (blockMs / 1000.0));
+    report.field("block_solid_ratio", static_cast<double>(solid) / blockQueries.size());
+    report.field("raycasts", static_cast<double>(rayCount));
+    report.field("raycasts_per_sec", rayCount / (rayMs / 1000.0));
+    report.field("raycast_hit_ratio", static_cast<double>(hits) / rayCount);
+    report.field("collision_checks", static_cast<double>(rayCount));
+    report.field("collision_checks_per_sec", rayCount / (collisionMs / 1000.0));
+    report.field("collision_ratio", static_cast<double>(collisions) / rayCount);
+    report.endScenario();
+}
+
+// 5) Cache lookups at scale : isChunkLoaded against a cache much bigger than any render distance.
+// Only keys matter for the hash map so the entries don't own chunks (keeps the RAM flat).
+void benchCache(const BenchConfig& cfg, JsonReport& report) {
+    World world(cfg.seed);
+    const int side = 128;
+    for (int x = 0; x < side; ++x)
+        for (int z = 0; z < side; ++z)
+            world.chunkCache[{ x * CHUNK_SIZE, -BASE_GROUND_HEIGHT, z * CHUNK_SIZE }];
+
+    std::mt19937 rng(cfg.seed);
+    std::uniform_int_distribution<int> coord(-side / 2, side + side / 2); // ~25% hits (half per axis)
+    std::vector<glm::ivec3> lookups(cfg.queries);
+    for (auto& l : lookups) l = { coord(rng) * CHUNK_SIZE, -BASE_GROUND_HEIGHT, coord(rng) * CHUNK_SIZE };
+
+    size_t hits = 0;
+    auto start = Clock::now();
+    for (const auto& l : lookups) {
+        if (world.isChunkLoaded(l)) ++hits;
+    }
+    double ms = msSince(start);
+
+    report.beginScenario("cache");
+    report.field("entries", static_cast<double>(world.chunkCache.size()));
+    report.field("buckets", static_cast<double>(world.chunkCache.bucket_count()));
+    report.field("lookups", static_cast<double>(lookups.size()));
+    report.field("lookups_per_sec", lookups.size() / (ms / 1000.0));
+    report.field("hit_ratio", static_cast<double>(hits) / lookups.size());
+    report.endScenario();
+}
+
+// Keeps "rendering" (updateChunks) until the remesh queue and the workers are drained, returns the ms it took
+double drainRemeshes(World& world, double& worstUpdateMs, int& frames) {
+    auto start = Clock::now();
+    while (true) {
+        World::CacheStats stats = world.getCacheStats();
+        if (stats.remeshQueue == 0 && stats.remeshesInFlight == 0 && stats.meshedChunks == 0) break;
+        auto frame = Clock::now();
+        world.updateChunks();
+        worstUpdateMs = std::max(worstUpdateMs, msSince(frame));
+        ++frames;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return msSince(start);
+}
+
+// Byte compare of every section, patched meshes must match a from scratch build
+bool sameSections(const MeshData& a, const MeshData& b) {
+    for (int s = 0; s < CHUNK_SECTION_COUNT; ++s) {
+        const MeshRange& ra = a.sections[s];
+        const MeshRange& rb = b.sections[s];
+        if (ra.vertexCount != rb.vertexCount || ra.indexCount != rb.indexCount) return false;
+        if (ra.vertexCount && std::memcmp(&a.vertices[ra.firstVertex], &b.vertices[rb.firstVertex], ra.vertexCount * sizeof(CompactVertex)) != 0) return false;
+        for (unsigned int i = 0; i < ra.indexCount; ++i) {
+            if (a.indices[ra.firstIndex + i] - ra.firstVertex != b.indices[rb.firstIndex + i] - rb.firstVertex) return false;
+        }
+    }
+    return true;
+}
+
+// 6) Remesh : main thread cost of block edits through the off-thread remesh queue (against the
+// synchronous generateMeshData the edit path used to pay), then edit-to-swap latency of a
+// section remesh vs a whole chunk remesh, and a check that patched meshes match a full rebuild.
+// Own world and chunks, so nothing the other scenarios did to the grid leaks into the check
+void benchRemesh(const BenchConfig& cfg, JsonReport& report) {
+    World world(cfg.seed);
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (const auto& pos : chunkGrid(cfg.radius)) {
+        auto chunk = std::make_shared<Chunk>(pos);
+        world.generateChunkData(*chunk);
+        LightEngine::lightNewChunk(*chunk);
+        chunks.push_back(chunk);
+    }
+    for (auto& chunk : chunks) world.insertChunk(chunk);
+    for (auto& chunk : chunks) chunk->generateMeshData();
+
+    const int edits = 64;
+    std::mt19937 rng(cfg.seed + 1);
+    std::uniform_int_distribution<size_t> pickChunk(0, chunks.size() - 1);
+    std::uniform_int_distribution<int> local(0, CHUNK_SIZE - 1);
+    std::uniform_int_distribution<int> height(40, 140);
+
+    std::vector<std::pair<Chunk*, glm::ivec3>> targets(edits);
+    for (auto& t : targets) t = { chunks[pickChunk(rng)].get(), glm::ivec3(local(rng), height(rng), local(rng)) };
+
+    auto start = Clock::now();
+    for (auto& t : targets) t.first->generateMeshData();
+    double syncMs = msSince(start);
+
+    // insertChunk queued a neighbour refresh for most of the grid, get rid of that first
+    world.startRemeshWorkers();
+    double worstUpdateMs = 0.0;
+    int frames = 0;
+    double backlogMs = drainRemeshes(world, worstUpdateMs, frames);
+
+    // Burst of edits, one per frame (relight included)
+    double mainMs = 0.0;
+    for (auto& t : targets) {
+        auto frame = Clock::now();
+        world.editBlock(glm::ivec3(t.first->getPosition()) + t.second, Block::Type::AIR);
+        world.updateChunks();
+        double ms = msSince(frame);
+        mainMs += ms;
+        worstUpdateMs = std::max(worstUpdateMs, ms);
+    }
+    frames = 0;
+    double burstMs = drainRemeshes(world, worstUpdateMs, frames);
+
+    // Latency of a lone edit : only the touched sections vs the whole chunk
+    const int latencyEdits = 16;
+    double sectionLatencyMs = 0.0, fullLatencyMs = 0.0;
+    int latencyFrames = 0;
+    for (int i = 0; i < latencyEdits; ++i) {
+        auto& t = targets[i];
+        glm::ivec3 below = t.second - glm::ivec3(0, 1, 0);
+        world.editBlock(glm::ivec3(t.first->getPosition()) + below, Block::Type::AIR);
+        sectionLatencyMs += drainRemeshes(world, worstUpdateMs, latencyFrames);
+
+        world.requestRemesh(t.first->getPosition(), RemeshPriority::EDIT);
+        fullLatencyMs += drainRemeshes(world, worstUpdateMs, latencyFrames);
+    }
+
+    // Section patched meshes vs a fresh full build, after one more round of section edits. The
+    // lava ones light up sections (and neighbour chunks) the edit itself doesn't touch
+    for (int i = 0; i < edits; ++i) {
+        auto& t = targets[i];
+        world.editBlock(glm::ivec3(t.first->getPosition()) + t.second, (i % 4 == 3) ? Block::Type::LAVA : Block::Type::STONE);
+    }
+    drainRemeshes(world, worstUpdateMs, frames);
+    bool patchesMatch = true;
+    for (auto& chunk : chunks) {
+        MeshData solid = chunk->SolidMesh;
+        MeshData liquid = chunk->LiquidMesh;
+        chunk->generateMeshData();
+        patchesMatch = patchesMatch && sameSections(solid, chunk->SolidMesh) && sameSections(liquid, chunk->LiquidMesh);
+    }
+
+    report.beginScenario("remesh");
+    report.field("edits", static_cast<double>(edits));
+    report.field("sync_ms_per_edit", syncMs / edits);
+    report.field("main_thread_ms_per_edit", mainMs / edits);
+    report.field("worst_update_ms", worstUpdateMs);
+    report.field("backlog_drain_ms", backlogMs);
+    report.field("burst_drain_ms", burstMs);
+    report.field("section_edit_latency_ms", sectionLatencyMs / latencyEdits);
+    report.field("full_edit_latency_ms", fullLatencyMs / latencyEdits);
+    report.check("patches_match_full_build", patchesMatch);
+    report.endScenario();
+}
+
+// Sky irradiance : SH9 projection of an HDR sky on the CPU (what replaced the irradiance cubemap
+// pre-pass), one thread against all of them, and the SH result against a brute force cosine
+// convolution of the same image in a set of directions
+void benchSkyIrradiance(const BenchConfig& cfg, JsonReport& report) {
+    const int width = 2048, height = 1024;
+    const double pi = 3.14159265358979323846;
+
+    // Synthetic sky : blue gradient over a dark ground, a small sun way brighter than the rest
+    std::vector<float> sky(static_cast<size_t>(width) * height * 3);
+    std::mt19937 rng(cfg.seed + 11);
+    std::uniform_real_distribution<float> noise(0.9f, 1.1f);
+    const glm::vec3 sunDirection = glm::normalize(glm::vec3(0.4f, 0.6f, -0.5f));
+    auto direction = [&](int x, int y) {
+        double lat = ((y + 0.5) / height - 0.5) * pi;
+        double phi = ((x + 0.5) / width - 0.5) * 2.0 * pi;
+        return glm::vec3(std::cos(lat) * std::cos(phi), std::sin(lat), std::cos(lat) * std::sin(phi));
+    };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            glm::vec3 d = direction(x, y);
+            glm::vec3 color = d.y > 0.0f ? glm::mix(glm::vec3(0.8f, 0.9f, 1.0f), glm::vec3(0.2f, 0.4f, 0.9f), d.y) : glm::vec3(0.15f, 0.12f, 0.1f);
+            if (glm::dot(d, sunDirection) > 0.999f) color = glm::vec3(60.0f, 55.0f, 45.0f);
+            color *= noise(rng);
+            float* pixel = &sky[(static_cast<size_t>(y) * width + x) * 3];
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+        }
+    }
+
+    const int repeats = 5;
+    unsigned int threads = std::max(4u, std::thread::hardware_concurrency()); // At least a few bands to compare
+    IrradianceSH single, parallel;
+    auto start = Clock::now();
+    for (int i = 0; i < repeats; ++i) single = IrradianceSH::fromEquirect(sky.data(), width, height, 1);
+    double singleMs = msSince(start) / repeats;
+    start = Clock::now();
+    for (int i = 0; i < repeats; ++i) parallel = IrradianceSH::fromEquirect(sky.data(), width, height, static_cast<int>(threads));
+    double parallelMs = msSince(start) / repeats;
+
+    bool threadsMatch = true;
+    for (int k = 0; k < 9; ++k) {
+        glm::vec3 diff = glm::abs(single.coefficients[k] - parallel.coefficients[k]);
+        threadsMatch = threadsMatch && glm::all(glm::lessThanEqual(diff, glm::abs(single.coefficients[k]) * 1e-4f + 1e-6f));
+    }
+
+    // Reference : irradiance / PI, brute force over every pixel (same cap as the projection)
+    std::vector<glm::vec3> normals = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+        { 1, 1, 1 }, { -1, 1, 1 }, { 1, 1, -1 }, { -1, 1, -1 }, { 1, -1, 1 }, { -1, -1, -1 }, sunDirection
+    };
+    const double pixelArea = (2.0 * pi / width) * (pi / height);
+    double maxError = 0.0, errorSum = 0.0;
+    start = Clock::now();
+    for (glm::vec3 n : normals) {
+        n = glm::normalize(n);
+        glm::dvec3 reference(0.0);
+        for (int y = 0; y < height; ++y) {
+            double weight = pixelArea * std::cos(((y + 0.5) / height - 0.5) * pi) / pi;
+            for (int x = 0; x < width; ++x) {
+                double cosine = glm::dot(direction(x, y), n);
+                if (cosine <= 0.0) continue;
+                const float* pixel = &sky[(static_cast<size_t>(y) * width + x) * 3];
+                reference += weight * cosine * glm::dvec3(std::min(pixel[0], IrradianceSH::MAX_RADIANCE),
+                    std::min(pixel[1], IrradianceSH::MAX_RADIANCE), std::min(pixel[2], IrradianceSH::MAX_RADIANCE));
+            }
+        }
+        glm::dvec3 sh(parallel.evaluate(n));
+        double error = glm::length(sh - reference) / std::max(1e-6, glm::length(reference));
+        maxError = std::max(maxError, error);
+        errorSum += error;
+    }
+    double referenceMs = msSince(start) / normals.size();
+
+    report.beginScenario("sky_irradiance");
+    report.field("pixels", static_cast<double>(width) * height);
+    report.field("threads", static_cast<double>(threads));
+    report.field("single_thread_ms", singleMs);
+    report.field("parallel_ms", parallelMs);
+    report.field("mpixels_per_sec", width * static_cast<double>(height) / (parallelMs * 1000.0));
+    report.field("brute_force_ms_per_direction", referenceMs);
+    report.field("mean_relative_error", errorSum / normals.size());
+    report.field("max_relative_error", maxError);
+    report.field("threads_match", threadsMatch);
+    report.endScenario();
+}
+
+// Synthetic character for the animation scenarios : random tree of nodes (parents before
+// children), most of them bones, and clips keying every bone
+struct BenchCharacter {
+    Skeleton skeleton;
+    std::vector<AnimationClip> clips;
+};
+
+BenchCharacter makeBenchCharacter(unsigned int seed, int nodes, int clipCount, int keys, float duration) {
+    BenchCharacter character;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int n = 0; n < nodes; ++n) {
+        int parent = n == 0 ? -1 : static_cast<int>(rng() % n);
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(unit(rng), 1.0f + unit(rng), unit(rng)) * 0.3f)
+            * glm::toMat4(glm::angleAxis(unit(rng), glm::normalize(glm::vec3(unit(rng), unit(rng), 1.0f))));
+        int index = character.skeleton.addNode("node" + std::to_string(n), parent, local);
+        if (n % 4 != 3) { // Some plain nodes in between, like a real rig
+            character.skeleton.boneIndex[index] = character.skeleton.boneCount++;
+            character.skeleton.offsets[index] = glm::inverse(local);
+        }
+    }
+    for (int c = 0; c < clipCount; ++c) {
+        std::vector<Bone> channels;
+        for (int n = 0; n < nodes; ++n) {
+            if (character.skeleton.boneIndex[n] < 0) continue;
+            std::vector<KeyPosition> positions;
+            std::vector<KeyRotation> rotations;
+            std::vector<KeyScale> scales;
+            glm::vec3 base = character.skeleton.bindPose[n].translation;
+            glm::vec3 axis = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 0.0f, 1.5f));
+            float phase = unit(rng) * 3.0f;
+            for (int k = 0; k < keys; ++k) {
+                float t = duration * k / (keys - 1);
+                float wave = std::sin(t * 0.2f + phase);
+                positions.push_back({ base + glm::vec3(0.0f, 0.05f * wave, 0.0f), t });
+                rotations.push_back({ glm::angleAxis(0.8f * wave, axis), t });
+                scales.push_back({ glm::vec3(1.0f), t });
+            }
+            channels.push_back(Bone(character.skeleton.names[n], character.skeleton.boneIndex[n], positions, rotations, scales));
+        }
+        character.clips.push_back(AnimationClip("clip" + std::to_string(c), duration, 25.0f, std::move(channels)));
+        character.clips.back().bind(character.skeleton);
+    }
+    return character;
+}
+
+// What Animator did before the flattened skeleton : recursive walk, per node vectors, bones
+// looked up by name in the clip and in a map, and every local matrix decomposed again
+struct LegacyNode {
+    std::string name;
+    glm::mat4 transformation;
+    std::vector<LegacyNode> children;
+};
+
+LegacyNode buildLegacyNode(const Skeleton& skeleton, int node) {
+    LegacyNode result{ skeleton.names[node], skeleton.bindPose[node].toMat4(), {} };
+    for (size_t child = 0; child < skeleton.nodeCount(); ++child)
+        if (skeleton.parents[child] == node) result.children.push_back(buildLegacyNode(skeleton, static_cast<int>(child)));
+    return result;
+}
+
+void legacyBlend(const LegacyNode& node, const glm::mat4& parentTransform, std::vector<Bone>* clips[], const float* times,
+    const float* weights, int layerCount, const std::map<std::string, std::pair<int, glm::mat4>>& boneMap, std::vector<glm::mat4>& palette) {
+    std::vector<glm::vec3> scales, trans;
+    std::vector<glm::quat> rots;
+    std::vector<float> layerWeights;
+    for (int l = 0; l < layerCount; ++l) {
+        glm::mat4 local = node.transformation;
+        for (Bone& bone : *clips[l]) {
+            if (bone.GetBoneName() == node.name) {
+                bone.Update(times[l]);
+                local = bone.GetLocalTransform();
+                break;
+            }
+        }
+        glm::vec3 scale, translation, skew;
+        glm::quat rotation;
+        glm::vec4 perspective;
+        glm::decompose(local, scale, rotation, translation, skew, perspective);
+        scales.push_back(scale);
+        trans.push_back(translation);
+        if (!rots.empty() && glm::dot(rots[0], rotation) < 0.0f) rotation = -rotation;
+        rots.push_back(rotation);
+        layerWeights.push_back(weights[l]);
+    }
+    glm::vec3 blendedScale(0.0f), blendedTrans(0.0f);
+    for (size_t i = 0; i < layerWeights.size(); ++i) {
+        blendedScale += scales[i] * layerWeights[i];
+        blendedTrans += trans[i] * layerWeights[i];
+    }
+    glm::quat blendedRot = rots[0];
+    float accum = layerWeights[0];
+    for (size_t i = 1; i < rots.size(); ++i) {
+        blendedRot = glm::slerp(blendedRot, rots[i], layerWeights[i] / (accum + layerWeights[i]));
+        accum += layerWeights[i];
+    }
+    glm::mat4 global = parentTransform * glm::translate(glm::mat4(1.0f), blendedTrans) * glm::toMat4(blendedRot)
+        * glm::scale(glm::mat4(1.0f), blendedScale);
+    auto it = boneMap.find(node.name);
+    if (it != boneMap.end()) palette[it->second.first] = global * it->second.second;
+    for (const LegacyNode& child : node.children)
+        legacyBlend(child, global, clips, times, weights, layerCount, boneMap, palette);
+}
+
+float maxPaletteDiff(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i)
+        for (int c = 0; c < 4; ++c)
+            diff = std::max(diff, glm::length(a[i][c] - b[i][c]));
+    return diff;
+}
+
+// Animation blend : bone palettes of a crowd of characters playing 2 blended clips, the
+// flattened PoseEvaluator against the old recursive Animator walk, plus the heap allocations
+// of the steady state update (should be 0)
+void benchAnimationBlend(const BenchConfig& cfg, JsonReport& report) {
+    const int nodes = 64, keys = 60, characters = 256, frames = 40;
+    const float duration = 60.0f;
+    BenchCharacter character = makeBenchCharacter(cfg.seed + 13, nodes, 2, keys, duration);
+    const Skeleton& skeleton = character.skeleton;
+
+    std::vector<PoseEvaluator> evaluators(characters);
+    std::vector<std::vector<glm::mat4>> palettes(characters, std::vector<glm::mat4>(skeleton.boneCount, glm::mat4(1.0f)));
+    auto layersAt = [&](int c, int frame, PoseLayer* layers) {
+        float time = std::fmod(c * 0.37f + frame * 0.5f, duration);
+        layers[0] = { &character.clips[0], time, 0.7f };
+        layers[1] = { &character.clips[1], std::fmod(time * 1.3f, duration), 0.3f };
+    };
+
+    PoseLayer layers[2];
+    for (int c = 0; c < characters; ++c) { // Warm up, the scratch buffers grow once
+        layersAt(c, 0, layers);
+        evaluators[c].evaluate(skeleton, layers, 2, palettes[c].data());
+    }
+    size_t allocationsBefore = g_allocations.load();
+    auto start = Clock::now();
+    for (int frame = 1; frame <= frames; ++frame) {
+        for (int c = 0; c < characters; ++c) {
+            layersAt(c, frame, layers);
+            evaluators[c].evaluate(skeleton, layers, 2, palettes[c].data());
+        }
+    }
+    double flatMs = msSince(start);
+    size_t allocations = g_allocations.load() - allocationsBefore;
+
+    // Legacy walk, fewer characters (it's a lot slower)
+    LegacyNode root = buildLegacyNode(skeleton, 0);
+    std::map<std::string, std::pair<int, glm::mat4>> boneMap;
+    for (size_t n = 0; n < skeleton.nodeCount(); ++n)
+        if (skeleton.boneIndex[n] >= 0) boneMap[skeleton.names[n]] = { skeleton.boneIndex[n], skeleton.offsets[n] };
+    std::vector<Bone> legacyClips[2] = { character.clips[0].getChannels(), character.clips[1].getChannels() };
+    std::vector<Bone>* clipPointers[2] = { &legacyClips[0], &legacyClips[1] };
+    std::vector<glm::mat4> legacyPalette(skeleton.boneCount, glm::mat4(1.0f));
+    const int legacyCharacters = characters / 8;
+    allocationsBefore = g_allocations.load();
+    start = Clock::now();
+    for (int frame = 1; frame <= frames; ++frame) {
+        for (int c = 0; c < legacyCharacters; ++c) {
+            layersAt(c, frame, layers);
+            float times[2] = { layers[0].time, layers[1].time };
+            float weights[2] = { layers[0].weight, layers[1].weight };
+            legacyBlend(root, glm::mat4(1.0f), clipPointers, times, weights, 2, boneMap, legacyPalette);
+        }
+    }
+    double legacyMs = msSince(start);
+    double legacyAllocations = static_cast<double>(g_allocations.load() - allocationsBefore) / (frames * legacyCharacters);
+
+    // Same result : one layer is exact up to float noise, two layers differ by nlerp vs slerp
+    PoseEvaluator check;
+    std::vector<glm::mat4> flat(skeleton.boneCount, glm::mat4(1.0f));
+    layersAt(5, 3, layers);
+    float times[2] = { layers[0].time, layers[1].time };
+    float weights[2] = { layers[0].weight, layers[1].weight };
+    PoseLayer single = { layers[0].clip, layers[0].time, 1.0f };
+    check.evaluate(skeleton, &single, 1, flat.data());
+    legacyBlend(root, glm::mat4(1.0f), clipPointers, times, &single.weight, 1, boneMap, legacyPalette);
+    float singleDiff = maxPaletteDiff(flat, legacyPalette);
+    check.evaluate(skeleton, layers, 2, flat.data());
+    legacyBlend(root, glm::mat4(1.0f), clipPointers, times, weights, 2, boneMap, legacyPalette);
+    float blendDiff = maxPaletteDiff(flat, legacyPalette);
+
+    report.beginScenario("animation_blend");
+    report.field("nodes", static_cast<double>(nodes));
+    report.field("bones", static_cast<double>(skeleton.boneCount));
+    report.field("layers", 2.0);
+    report.field("flat_us_per_character", flatMs * 1000.0 / (frames * characters));
+    report.field("legacy_us_per_character", legacyMs * 1000.0 / (frames * legacyCharacters));
+    report.field("speedup", (legacyMs / legacyCharacters) / (flatMs / characters));
+    report.field("allocations_per_update", static_cast<double>(allocations) / (frames * characters));
+    report.field("legacy_allocations_per_update", legacyAllocations);
+    report.field("single_layer_max_diff", singleDiff);
+    report.field("two_layer_max_diff", blendDiff);
+    report.endScenario();
+}
+
+// Animation clips : cost of sampling a pose from the raw keys (binary search per bone) against
+// the compiled tracks (one frame index per sample) for a short and a long clip, the memory
+// and error compile() reports with and without quantized rotations, and sampling at / past
+// the end of the clip (used to assert)
+void benchAnimationClips(const BenchConfig& cfg, JsonReport& report) {
+    const int nodes = 64, samples = 20000;
+    const int keyCounts[2] = { 30, 1200 };
+    std::vector<Transform> pose;
+
+    report.beginScenario("animation_clips");
+    for (int k = 0; k < 2; ++k) {
+        const float duration = static_cast<float>(keyCounts[k]);
+        BenchCharacter character = makeBenchCharacter(cfg.seed + 14 + k, nodes, 1, keyCounts[k], duration);
+        const Skeleton& skeleton = character.skeleton;
+        pose.resize(skeleton.nodeCount());
+        std::mt19937 rng(cfg.seed + 16 + k);
+        std::uniform_real_distribution<float> time(0.0f, duration);
+        std::vector<float> times(samples);
+        for (float& t : times) t = time(rng);
+
+        auto samplePoses = [&](const AnimationClip& clip) {
+            auto start = Clock::now();
+            for (float t : times) clip.samplePose(skeleton, t, pose.data());
+            return msSince(start) * 1000.0 / samples;
+        };
+
+        AnimationClip compiled = character.clips[0];
+        ClipCompileReport full = compiled.compile();
+        AnimationClip quantized = character.clips[0];
+        ClipCompileOptions options;
+        options.quantizeRotations = true;
+        ClipCompileReport packed = quantized.compile(options);
+
+        double keysUs = samplePoses(character.clips[0]);
+        double compiledUs = samplePoses(compiled);
+        double quantizedUs = samplePoses(quantized);
+
+        // Last key and past it : holds the last key, nothing reads out of the keys
+        bool endOk = true;
+        for (const AnimationClip* clip : { &character.clips[0], &compiled, &quantized }) {
+            for (float t : { duration, duration + 10.0f, -1.0f }) {
+                clip->samplePose(skeleton, t, pose.data());
+                for (const Transform& transform : pose)
+                    endOk = endOk && std::isfinite(transform.rotation.w) && std::isfinite(transform.translation.x);
+            }
+        }
+
+        std::string prefix = k == 0 ? "short_" : "long_";
+        report.field(prefix + "keys", static_cast<double>(keyCounts[k]));
+        report.field(prefix + "frames", static_cast<double>(full.frames));
+        report.field(prefix + "keys_us_per_pose", keysUs);
+        report.field(prefix + "compiled_us_per_pose", compiledUs);
+        report.field(prefix + "quantized_us_per_pose", quantizedUs);
+        report.field(prefix + "source_kb", full.sourceBytes / 1024.0);
+        report.field(prefix + "compiled_kb", full.compiledBytes / 1024.0);
+        report.field(prefix + "quantized_kb", packed.compiledBytes / 1024.0);
+        report.field(prefix + "constant_tracks", static_cast<double>(full.constantTracks));
+        report.field(prefix + "max_translation_error", full.maxTranslationError);
+        report.field(prefix + "max_rotation_error_deg", full.maxRotationError);
+        report.field(prefix + "quantized_max_rotation_error_deg", packed.maxRotationError);
+        report.field(prefix + "compile_ms", full.compileMs);
+        report.field(prefix + "end_of_clip_ok", endOk);
+    }
+    report.endScenario();
+}
+
+// Animation crowd : a crowd of characters on 2 blended clips at random phases, strung out
+// from the camera. Every pose evaluated one after the other on this thread against the
+// AnimationScheduler with only its threads, then with pose sharing + distance LOD on top
+void benchAnimationCrowd(const BenchConfig& cfg, JsonReport& report) {
+    const int nodes = 64, keys = 60, characters = 512, frames = 40;
+    const float duration = 60.0f, dt = 1.0f / 60.0f;
+    BenchCharacter character = makeBenchCharacter(cfg.seed + 18, nodes, 2, keys, duration);
+    const Skeleton& skeleton = character.skeleton;
+    for (AnimationClip& clip : character.clips) clip.compile();
+
+    std::mt19937 rng(cfg.seed + 19);
+    std::uniform_real_distribution<float> phase(0.0f, duration);
+    std::vector<float> phases(characters);
+    std::vector<glm::vec3> positions(characters);
+    for (int c = 0; c < characters; ++c) {
+        phases[c] = phase(rng);
+        positions[c] = glm::vec3(0.0f, 0.0f, 2.0f + 150.0f * c / characters);
+    }
+    auto layersAt = [&](int c, int frame, PoseLayer* layers) {
+        float time = std::fmod(phases[c] + frame * dt * 25.0f, duration);
+        float walk = c % 4 == 0 ? 0.0f : 1.0f; // A quarter idle
+        layers[0] = { &character.clips[0], time, walk };
+        layers[1] = { &character.clips[1], time, 1.0f - walk };
+    };
+
+    // Reference : every pose every frame, one thread
+    PoseEvaluator evaluator;
+    std::vector<glm::mat4> palettes(static_cast<size_t>(characters) * skeleton.boneCount, glm::mat4(1.0f));
+    PoseLayer layers[2];
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int c = 0; c < characters; ++c) {
+            layersAt(c, frame, layers);
+            evaluator.evaluate(skeleton, layers, 2, palettes.data() + static_cast<size_t>(c) * skeleton.boneCount);
+        }
+    }
+    double serialMs = msSince(start);
+
+    auto runScheduler = [&](AnimationScheduler& scheduler, AnimationSchedulerStats& totals) {
+        for (int c = 0; c < characters; ++c) {
+            scheduler.add(skeleton);
+            scheduler.setPosition(c, positions[c]);
+        }
+        auto begin = Clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (int c = 0; c < characters; ++c) {
+                layersAt(c, frame, layers);
+                scheduler.setLayers(c, layers, 2);
+            }
+            scheduler.update(glm::vec3(0.0f));
+            totals.evaluated += scheduler.stats().evaluated;
+            totals.shared += scheduler.stats().shared;
+            totals.skipped += scheduler.stats().skipped;
+            totals.threads = scheduler.stats().threads;
+        }
+        return msSince(begin);
+    };
+
+    AnimationScheduler parallel;
+    parallel.shareBucket = 0.0f;
+    parallel.lods = { { 1e9f, 1 } };
+    AnimationSchedulerStats parallelTotals;
+    double parallelMs = runScheduler(parallel, parallelTotals);
+
+    // Same last frame as the reference, every pose evaluated : only the threads differ
+    auto paletteOf = [&](const AnimationScheduler& scheduler, int c) {
+        return std::vector<glm::mat4>(scheduler.getPalette(c), scheduler.getPalette(c) + skeleton.boneCount);
+    };
+    float parallelDiff = 0.0f;
+    for (int c = 0; c < characters; ++c) {
+        auto reference = palettes.begin() + static_cast<size_t>(c) * skeleton.boneCount;
+        parallelDiff = std::max(parallelDiff, maxPaletteDiff(paletteOf(parallel, c), std::vector<glm::mat4>(reference, reference + skeleton.boneCount)));
+    }
+
+    AnimationScheduler crowd;
+    AnimationSchedulerStats crowdTotals;
+    double crowdMs = runScheduler(crowd, crowdTotals);
+
+    // Sharing error : one update with everyone due (fresh scheduler), poses snapped to their
+    // bucket against the exact ones
+    AnimationScheduler snapped;
+    for (int c = 0; c < characters; ++c) {
+        snapped.add(skeleton);
+        layersAt(c, 0, layers);
+        snapped.setLayers(c, layers, 2);
+    }
+    snapped.update(glm::vec3(0.0f));
+    float shareDiff = 0.0f;
+    std::vector<glm::mat4> exact(skeleton.boneCount);
+    for (int c = 0; c < characters; ++c) {
+        layersAt(c, 0, layers);
+        evaluator.evaluate(skeleton, layers, 2, exact.data());
+        shareDiff = std::max(shareDiff, maxPaletteDiff(paletteOf(snapped, c), exact));
+    }
+
+    report.beginScenario("animation_crowd");
+    report.field("characters", static_cast<double>(characters));
+    report.field("bones", static_cast<double>(skeleton.boneCount));
+    report.field("threads", static_cast<double>(parallelTotals.threads + 1));
+    report.field("serial_ms_per_frame", serialMs / frames);
+    report.field("parallel_ms_per_frame", parallelMs / frames);
+    report.field("crowd_ms_per_frame", crowdMs / frames);
+    report.field("parallel_speedup", serialMs / parallelMs);
+    report.field("crowd_speedup", serialMs / crowdMs);
+    report.field("evaluated_per_frame", static_cast<double>(crowdTotals.evaluated) / frames);
+    report.field("shared_per_frame", static_cast<double>(crowdTotals.shared) / frames);
+    report.field("skipped_per_frame", static_cast<double>(crowdTotals.skipped) / frames);
+    report.field("parallel_max_diff", parallelDiff);
+    report.field("shared_max_diff", shareDiff);
+    report.endScenario();
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& cfg) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) cfg.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--radius" && hasValue) cfg.radius = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--iterations" && hasValue) cfg.iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--queries" && hasValue) cfg.queries = std::max(10, std::atoi(argv[++i]));
+        else if (arg == "--out" && hasValue) cfg.outPath = argv[++i];
+        else {
+            std::cerr << "usage : voxel_bench [--seed N] [--radius R] [--iterations N] [--queries N] [--out file.json]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) return 1;
+
+    JsonReport report;
+    World world(cfg.seed);
+
+    auto chunks = benchGenerate(world, cfg, report);
+    benchLighting(world, chunks, cfg, report);
+    benchMesh(chunks, cfg, report);
+    benchStorage(chunks, report);
+    benchMeshMemory(chunks, report);
+    benchChunkPool(report);
+    benchFrustum(chunks, report);
+    benchCaveCulling(chunks, report);
+    benchOcclusion(chunks, report);
+    benchMeshArena(chunks, cfg, report);
+    benchRenderList(world, report);
+    benchQueries(world, cfg, report);
+    benchRemesh(cfg, report);
+    benchCache(cfg, report);
+    benchSkyIrradiance(cfg, report);
+    benchAnimationBlend(cfg, report);
+    benchAnimationClips(cfg, report);
+    benchAnimationCrowd(cfg, report);
+
+    std::string json = report.str(cfg);
+    if (cfg.outPath.empty()) {
+        std::cout << json;
+    }
+    else {
+        std::ofstream out(cfg.outPath);
+        out << json;
+        std::cerr << "voxel_bench : results written to " << cfg.outPath << "\n";
+    }
+    for (const std::string& failure : report.failures()) std::cerr << "voxel_bench : check failed : " << failure << "\n";
+    return report.failures().empty() ? 0 : 1;
+}
@@ -3,82 +3,71 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include "AnimationClip.h"
 #include "Bone.h"
 #include "Model.h"
-#include <assimp/Importer.hpp>  
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include "ModelCache.h"
 #include <glm/gtx/quaternion.hpp>
+#include <cassert>
+#include <iostream>
 #include <map>
+#include <memory>
 
-struct AssimpNodeData
-{
-    glm::mat4 transformation;
-    std::string name;
-    int childrenCount;
-    std::vector<AssimpNodeData> children;
-};
-
+/*NOTE : One clip of a model file + the skeleton it plays on (both from ModelCache).
+  The clip is bound to the skeleton on load, so Animator never looks a bone up by name,
+  and compiled (AnimationClip::compile) so sampling a bone doesn't depend on its key count.
+*/
 class Animation
 {
 public:
+    // Used by every clip loaded after it's set (--quantize-clips in main)
+    static inline ClipCompileOptions compileOptions;
+    static inline bool printReports = true;
+
     Animation() = default;
 
-    Animation(const std::string& animationPath, Model* model, unsigned int animationIndex = 0)
+    // Clip animationIndex of the file, through ModelCache (one import for the model and all its clips)
+    Animation(const std::string& animationPath, unsigned int animationIndex = 0)
     {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(animationPath, aiProcess_Triangulate);
-        assert(scene && scene->mRootNode);
-        assert(animationIndex < scene->mNumAnimations);
-
-        auto animation = scene->mAnimations[animationIndex];
-        m_Duration = animation->mDuration;
-        m_TicksPerSecond = animation->mTicksPerSecond;
-        m_Name = animation->mName.C_Str();
-        ReadHeirarchyData(m_RootNode, scene->mRootNode);
-        ReadMissingBones(animation, *model);
+        std::shared_ptr<const ModelData> data = ModelCache::Get(animationPath);
+        assert(data);
+        Load(*data, animationIndex);
     }
 
-    // Add a name field
-    inline const std::string& GetName() const { return m_Name; }
-
-    ~Animation()
+    Animation(const ModelData& data, unsigned int animationIndex = 0)
     {
+        Load(data, animationIndex);
     }
 
-    std::vector<const aiAnimation*> LoadAllAnimations(const std::string& path)
+    // Add a name field
+    inline const std::string& GetName() const { return m_Clip.getName(); }
+
+    ~Animation()
     {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate);
-        assert(scene && scene->mRootNode);
-
-        std::vector<const aiAnimation*> animations;
-        for (unsigned int i = 0; i < scene->mNumAnimations; ++i)
-        {
-            animations.push_back(scene->mAnimations[i]);
-        }
-        return animations;
     }
 
 
-    Bone* FindBone(const std::string& name)
+    const Bone* FindBone(const std::string& name) const
     {
-        auto iter = std::find_if(m_Bones.begin(), m_Bones.end(),
+        const std::vector<Bone>& bones = m_Clip.getChannels();
+        auto iter = std::find_if(bones.begin(), bones.end(),
             [&](const Bone& Bone)
             {
                 return Bone.GetBoneName() == name;
             }
         );
-        if (iter == m_Bones.end()) return nullptr;
+        if (iter == bones.end()) return nullptr;
         else return &(*iter);
     }
 
 
-    inline float GetTicksPerSecond() { return m_TicksPerSecond; }
+    inline float GetTicksPerSecond() const { return m_Clip.getTicksPerSecond(); }
+
+    inline float GetDuration() const { return m_Clip.getDuration(); }
 
-    inline float GetDuration() { return m_Duration; }
+    inline const AnimationClip& GetClip() const { return m_Clip; }
 
-    inline const AssimpNodeData& GetRootNode() { return m_RootNode; }
+    inline const Skeleton& GetSkeleton() const { return *m_Skeleton; }
 
     inline const std::map<std::string, BoneInfo>& GetBoneIDMap()
     {
@@ -87,63 +76,43 @@ public:
 
     float get_duration() const
     {
-        return m_Duration;
+        return m_Clip.getDuration();
     }
 
     int get_ticks_per_second() const
     {
-        return m_TicksPerSecond;
+        return static_cast<int>(m_Clip.getTicksPerSecond());
     }
 
 
 private:
-    std::string m_Name; // Animation name
-
-    void ReadMissingBones(const aiAnimation* animation, Model& model)
+    void Load(const ModelData& data, unsigned int animationIndex)
     {
-        int size = animation->mNumChannels;
-
-        /*First extract the bone info and the bone count*/
-        auto& boneInfoMap = model.GetBoneInfoMap();
-        int& boneCount = model.GetBoneCount();
-
-        //reading channels(bones responsible for an animation and their keyframes)
-        for (int i = 0; i < size; i++)
-        {
-            auto channel = animation->mChannels[i];
-            std::string boneName = channel->mNodeName.data;
-
-            if (boneInfoMap.find(boneName) == boneInfoMap.end())
-            {
-                boneInfoMap[boneName].id = boneCount;
-                boneCount++;
-            }
-            m_Bones.push_back(Bone(channel->mNodeName.data,
-                boneInfoMap[channel->mNodeName.data].id, channel));
+        assert(animationIndex < data.clips.size());
+        assert(data.skeleton);
+        const ModelData::Clip& clip = data.clips[animationIndex];
+        // Already holds the bones of every clip of the file (ModelCache::ReadClip)
+        m_BoneInfoMap = data.boneInfoMap;
+        m_Skeleton = data.skeleton;
+
+        std::vector<Bone> bones;
+        for (const ModelData::Channel& channel : clip.channels)
+            bones.push_back(Bone(channel.name, channel.boneID, channel.positions, channel.rotations, channel.scales));
+        m_Clip = AnimationClip(clip.name, clip.duration, static_cast<float>(clip.ticksPerSecond), std::move(bones));
+        m_Clip.bind(*m_Skeleton);
+
+        ClipCompileReport report = m_Clip.compile(compileOptions);
+        if (printReports) {
+            std::cout << "Clip '" << report.name << "' : " << report.channels << " channels, " << report.frames << " frames, "
+                << report.constantTracks << "/" << report.tracks << " constant tracks, "
+                << report.sourceBytes / 1024.0f << " KB keys -> " << report.compiledBytes / 1024.0f << " KB, max error "
+                << report.maxTranslationError << " / " << report.maxRotationError << " deg / " << report.maxScaleError
+                << " (" << report.compileMs << " ms)\n";
         }
-
-        m_BoneInfoMap = boneInfoMap;
     }
 
-    void ReadHeirarchyData(AssimpNodeData& dest, const aiNode* src)
-    {
-        assert(src);
-
-        dest.name = src->mName.data;
-        dest.transformation = AssimpGLMHelpers::ConvertMatrixToGLMFormat(src->mTransformation);
-        dest.childrenCount = src->mNumChildren;
-
-        for (int i = 0; i < src->mNumChildren; i++)
-        {
-            AssimpNodeData newData;
-            ReadHeirarchyData(newData, src->mChildren[i]);
-            dest.children.push_back(newData);
-        }
-    }
-    float m_Duration;
-    int m_TicksPerSecond;
-    std::vector<Bone> m_Bones;
-    AssimpNodeData m_RootNode;
+    AnimationClip m_Clip;
+    std::shared_ptr<const Skeleton> m_Skeleton;
     std::map<std::string, BoneInfo> m_BoneInfoMap;
 };
-#endif
\ No newline at end of file
+#endif
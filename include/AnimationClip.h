@@ -0,0 +1,98 @@
+#ifndef ANIMATION_CLIP_CLASS_H
+#define ANIMATION_CLIP_CLASS_H
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/gtc/type_precision.hpp>
+#include "AnimationPose.h"
+#include "Bone.h"
+
+// How compile() resamples a clip
+struct ClipCompileOptions {
+    float sampleRate = 30.0f;        // Samples per second of animation
+    bool quantizeRotations = false;  // snorm16 x4 per rotation instead of 4 floats
+    float tolerance = 1e-4f;         // A track that never moves more than this from its first sample keeps only that one
+};
+
+// Memory / accuracy of one compile(), errors are against the source keys sampled between the frames
+struct ClipCompileReport {
+    std::string name;
+    int channels = 0;
+    int frames = 0;             // Samples of a track that moves
+    int tracks = 0;             // 3 per channel
+    int constantTracks = 0;     // Reduced to one sample
+    size_t sourceKeys = 0;
+    size_t sourceBytes = 0;
+    size_t compiledBytes = 0;
+    float maxTranslationError = 0.0f;
+    float maxRotationError = 0.0f; // Degrees
+    float maxScaleError = 0.0f;
+    double compileMs = 0.0;
+};
+
+/*NOTE : Keyframes of one animation, resolved against a Skeleton.
+
+  bind() maps every skeleton node to the channel that drives it (by name, once), after that
+  samplePose() is a straight loop over the nodes : the channel's keys when there is one,
+  the bind pose otherwise.
+
+  compile() resamples every channel at a fixed rate into flat arrays (all translations, all
+  rotations, all scales of the clip back to back, one track = first sample + count), so a
+  sample is frame = time * samplesPerTick, two loads and a lerp / nlerp, whatever the key
+  count, instead of finding the keys around the time. Tracks that don't move collapse to a
+  single sample and rotations can be stored as snorm16. Without compile() samplePose()
+  reads the Bones (binary search over their keys).
+*/
+class AnimationClip {
+public:
+    AnimationClip() = default;
+    AnimationClip(std::string name, float duration, float ticksPerSecond, std::vector<Bone> channels);
+
+    // Resolves node -> channel, call again when the clip moves to another skeleton
+    void bind(const Skeleton& skeleton);
+
+    // Builds the resampled tracks, samplePose() uses them from then on
+    ClipCompileReport compile(const ClipCompileOptions& options = ClipCompileOptions());
+    bool isCompiled() const { return !compiled.empty(); }
+
+    // pose = one Transform per skeleton node, time in ticks (clamped to the clip)
+    void samplePose(const Skeleton& skeleton, float time, Transform* pose) const;
+
+    const std::string& getName() const { return name; }
+    float getDuration() const { return duration; }
+    float getTicksPerSecond() const { return ticksPerSecond; }
+    const std::vector<Bone>& getChannels() const { return channels; }
+
+private:
+    struct Track {
+        uint32_t first;
+        uint32_t count; // 1 = constant, frameCount otherwise
+    };
+    struct CompiledChannel {
+        Track translation;
+        Track rotation;
+        Track scale;
+    };
+
+    void sampleCompiled(int channel, float time, Transform& transform) const;
+    glm::quat rotationAt(uint32_t index) const;
+
+    std::string name;
+    float duration = 0.0f;
+    float ticksPerSecond = 0.0f;
+    std::vector<Bone> channels;
+    std::vector<int> nodeChannels; // -1 = bind pose
+
+    // compile() output, empty until then
+    std::vector<CompiledChannel> compiled;
+    std::vector<glm::vec3> translations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::quat> rotations;         // Consecutive samples on the same hemisphere
+    std::vector<glm::i16vec4> packedRotations; // Same, quantized (quantizeRotations)
+    float samplesPerTick = 0.0f;
+    int frameCount = 0;
+};
+
+#endif
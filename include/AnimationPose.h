@@ -0,0 +1,75 @@
+#ifndef ANIMATION_POSE_CLASS_H
+#define ANIMATION_POSE_CLASS_H
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <string>
+#include <vector>
+
+class AnimationClip;
+
+// Local transform of a node, what clips are sampled and blended in
+struct Transform {
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    glm::mat4 toMat4() const;
+    static Transform fromMat4(const glm::mat4& matrix);
+};
+
+/*NOTE : Node hierarchy of a model flattened into arrays, parents always before their children.
+
+  Built once per model file (ModelCache) : walking the nodes in order and doing
+  global[i] = global[parents[i]] * local[i] gives every global transform without recursion,
+  and nodes that are bones know their palette slot (boneIndex) and offset matrix up front,
+  so nothing is looked up by name after load.
+*/
+struct Skeleton {
+    std::vector<std::string> names;
+    std::vector<int> parents;          // -1 for the root
+    std::vector<Transform> bindPose;   // Node transformation as TRS, used where a clip has no channel
+    std::vector<int> boneIndex;        // Slot in the bone palette, -1 for plain nodes
+    std::vector<glm::mat4> offsets;    // Model space -> bone space (identity for plain nodes)
+    int boneCount = 0;                 // Palette size
+
+    // Returns the node index, parent must already be in
+    int addNode(const std::string& name, int parent, const glm::mat4& transformation);
+    int findNode(const std::string& name) const;
+    size_t nodeCount() const { return parents.size(); }
+};
+
+// One clip playing on a character
+struct PoseLayer {
+    const AnimationClip* clip = nullptr;
+    float time = 0.0f;     // In ticks
+    float weight = 1.0f;
+};
+
+/*NOTE : Turns the layers of one character into its bone palette, without allocating.
+
+  evaluate() samples every layer into its own pose (one Transform per node), blends them in
+  TRS space (translation / scale weighted sums, rotations weighted and normalized with their
+  sign lined up on the first layer) and walks the flattened hierarchy once for the globals
+  and the palette. The scratch poses are kept between calls, so after the first frame (or
+  a new highest layer count) it runs without touching the heap.
+
+  Layer weights are used as they are, the caller normalizes them (Animator does).
+*/
+class PoseEvaluator {
+public:
+    // palette gets skeleton.boneCount matrices, bones of nodes no layer reaches stay untouched
+    void evaluate(const Skeleton& skeleton, const PoseLayer* layers, int layerCount, glm::mat4* palette);
+
+    // Blended local pose of the last evaluate()
+    const std::vector<Transform>& getLocalPose() const { return blended; }
+
+private:
+    std::vector<std::vector<Transform>> layerPoses;
+    std::vector<Transform> blended;
+    std::vector<glm::mat4> globals;
+};
+
+#endif
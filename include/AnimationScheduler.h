@@ -0,0 +1,104 @@
+#ifndef ANIMATION_SCHEDULER_CLASS_H
+#define ANIMATION_SCHEDULER_CLASS_H
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "AnimationPose.h"
+#include "ThreadPool.h"
+
+// How often a character at least this close to the camera gets a new pose (1 = every update)
+struct AnimationLod {
+    float distance;
+    int interval;
+};
+
+// Last update()
+struct AnimationSchedulerStats {
+    int instances = 0;
+    int evaluated = 0;  // Poses actually computed
+    int shared = 0;     // Due, but got the pose of another character in the same clip / time bucket
+    int skipped = 0;    // Not due this update (LOD), kept their last palette
+    unsigned int threads = 0;
+    double updateMs = 0.0;
+};
+
+/*NOTE : Bone palettes of a crowd, evaluated on worker threads.
+
+  Every character (instance) says what it plays (PoseLayers, advanced by its own Animator)
+  and where it stands, update() then :
+  - LOD : picks who is due, from the distance to the camera (lods, staggered by instance so a
+    far group doesn't all land on the same update). The others keep their palette.
+  - Sharing : snaps the due layers to a time bucket (shareBucket seconds) and sorts them, the
+    characters with the same skeleton, clips, bucket and weights are evaluated once and the
+    others copy that palette. A crowd walking the same cycle costs a handful of evaluations.
+  - Evaluates the unique poses in chunks on the pool, one PoseEvaluator per chunk.
+
+  Palettes sit back to back in one array (getPalette), ready to be copied into a shared GPU
+  buffer (BonePaletteBuffer.h).
+*/
+class AnimationScheduler {
+public:
+    static constexpr int MAX_LAYERS = 4;
+
+    // 0 = one per core, minus the main thread
+    explicit AnimationScheduler(unsigned int threadCount = 0);
+
+    // Returns the instance, its palette starts as the identity
+    int add(const Skeleton& skeleton);
+    // What the instance plays, read by the next update() (at most MAX_LAYERS layers)
+    void setLayers(int instance, const PoseLayer* layers, int layerCount);
+    void setPosition(int instance, const glm::vec3& position);
+
+    void update(const glm::vec3& camera);
+
+    const glm::mat4* getPalette(int instance) const { return palettes.data() + instances[instance].paletteOffset; }
+    int getBoneCount(int instance) const { return instances[instance].skeleton->boneCount; }
+    size_t getInstanceCount() const { return instances.size(); }
+    const AnimationSchedulerStats& stats() const { return lastStats; }
+
+    // Closest first, past the last distance the last interval is used
+    std::vector<AnimationLod> lods = { { 16.0f, 1 }, { 32.0f, 2 }, { 64.0f, 4 }, { 128.0f, 8 } };
+    float shareBucket = 1.0f / 30.0f; // Seconds, 0 = no sharing (every due instance evaluated)
+    int minChunk = 8;                 // Fewer poses than this per thread are evaluated on the caller
+
+private:
+    // Compared as bytes : every field is set, unused layers zeroed, no padding
+    struct PoseKey {
+        const Skeleton* skeleton;
+        const void* clips[MAX_LAYERS];
+        int32_t buckets[MAX_LAYERS];
+        int32_t weights[MAX_LAYERS];
+        int32_t layerCount;
+        int32_t unused;
+    };
+
+    struct Instance {
+        const Skeleton* skeleton;
+        size_t paletteOffset;
+        PoseLayer layers[MAX_LAYERS];
+        int layerCount;
+        glm::vec3 position;
+        bool evaluated; // Has a pose at all, due on the next update until then
+        PoseLayer snapped[MAX_LAYERS]; // Layers the shared pose is evaluated with
+        PoseKey key;
+    };
+
+    void makeKey(Instance& instance);
+    void evaluate(const int* owners, size_t count, PoseEvaluator& evaluator);
+    int intervalFor(float distance) const;
+
+    std::vector<Instance> instances;
+    std::vector<glm::mat4> palettes;
+    std::vector<int> due;
+    std::vector<int> owners;                  // First due instance of every distinct key
+    std::vector<std::pair<int, int>> copies;  // { instance, owner it takes the palette of }
+    std::vector<PoseEvaluator> evaluators;    // One per chunk, the caller's included
+    uint64_t frame = 0;
+    AnimationSchedulerStats lastStats;
+    ThreadPool pool;
+};
+
+#endif
@@ -2,10 +2,10 @@
 #define ANIMATOR_H
 
 #include "Animation.h"
+#include "AnimationPose.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
-#include <glm/gtx/matrix_decompose.hpp>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -76,6 +76,17 @@ public:
      * Call once per frame
      */
     void UpdateAnimation(float dt) {
+        Advance(dt);
+        m_FinalBoneMatrices.assign(m_BoneCount, glm::mat4(1.0f));
+        if (m_Layers.empty()) return;
+        m_Evaluator.evaluate(GetSkeleton(), m_Layers.data(), static_cast<int>(m_Layers.size()), m_FinalBoneMatrices.data());
+    }
+
+    /**
+     * Advance all animation states and remove disabled ones, without evaluating the pose
+     * Crowd characters do this, then hand GetLayers() to an AnimationScheduler
+     */
+    void Advance(float dt) {
         for (auto& s : m_ActiveAnimations) {
             if (!s.enabled) continue;
             s.currentTime += s.anim->GetTicksPerSecond() * dt * s.speed;
@@ -92,10 +103,25 @@ public:
                 [](auto& s) { return !s.enabled; }),
             m_ActiveAnimations.end());
 
-        m_FinalBoneMatrices.assign(m_BoneCount, glm::mat4(1.0f));
-        if (m_ActiveAnimations.empty()) return;
+        // Layers in a reused vector, the evaluator keeps its own scratch : no allocation per frame
+        m_Layers.clear();
+        for (const auto& s : m_ActiveAnimations)
+            m_Layers.push_back({ &s.anim->GetClip(), s.currentTime, s.weight });
+    }
 
-        CalculateBlendedNodeTransforms(&m_ActiveAnimations.front().anim->GetRootNode(), glm::mat4(1.0f));
+    /**
+     * Clips, times and weights after the last Advance / UpdateAnimation
+     */
+    const std::vector<PoseLayer>& GetLayers() const {
+        return m_Layers;
+    }
+
+    /**
+     * Skeleton of the first animation played (all the layers share it)
+     */
+    const Skeleton& GetSkeleton() const {
+        assert(m_Skeleton);
+        return *m_Skeleton;
     }
 
     /**
@@ -107,13 +133,17 @@ public:
 
 private:
     size_t m_BoneCount = 0;
+    const Skeleton* m_Skeleton = nullptr;
     std::vector<AnimationState> m_ActiveAnimations;
     std::vector<glm::mat4> m_FinalBoneMatrices;
+    std::vector<PoseLayer> m_Layers;
+    PoseEvaluator m_Evaluator;
 
-    // If bone count not set, derive from animation's bone map
+    // If bone count not set, take the skeleton and palette size of the animation
     void initializeBoneCount(Animation* animation) {
         if (m_BoneCount == 0 && animation) {
-            m_BoneCount = animation->GetBoneIDMap().size();
+            m_Skeleton = &animation->GetSkeleton();
+            m_BoneCount = static_cast<size_t>(m_Skeleton->boneCount);
             assert(m_BoneCount > 0);
             m_FinalBoneMatrices.assign(m_BoneCount, glm::mat4(1.0f));
         }
@@ -124,71 +154,6 @@ private:
         for (auto& s : m_ActiveAnimations) if (s.enabled) sum += s.weight;
         if (sum > 0.0f) for (auto& s : m_ActiveAnimations) if (s.enabled) s.weight /= sum;
     }
-
-    // Recursively blend and write bone transforms
-    void CalculateBlendedNodeTransforms(const AssimpNodeData* node, const glm::mat4& parentTransform) {
-        const std::string& name = node->name;
-        std::vector<glm::vec3> scales;
-        std::vector<glm::vec3> trans;
-        std::vector<glm::quat> rots;
-        std::vector<float> weights;
-
-        for (auto& s : m_ActiveAnimations) {
-            if (!s.enabled || s.weight <= 0.0f) continue;
-            glm::mat4 local = node->transformation;
-            if (Bone* b = s.anim->FindBone(name)) {
-                b->Update(s.currentTime);
-                local = b->GetLocalTransform();
-            }
-            glm::vec3 scale, translation, skew;
-            glm::quat rotation;
-            glm::vec4 perspective;
-            glm::decompose(local, scale, rotation, translation, skew, perspective);
-
-            scales.push_back(scale);
-            trans.push_back(translation);
-            if (!rots.empty() && glm::dot(rots[0], rotation) < 0.0f) rotation = -rotation;
-            rots.push_back(rotation);
-            weights.push_back(s.weight);
-        }
-
-        glm::vec3 blendedScale(0.0f);
-        glm::vec3 blendedTrans(0.0f);
-        for (size_t i = 0; i < weights.size(); ++i) {
-            blendedScale += scales[i] * weights[i];
-            blendedTrans += trans[i] * weights[i];
-        }
-        glm::quat blendedRot(1, 0, 0, 0);
-        if (!rots.empty()) {
-            blendedRot = rots[0];
-            float accum = weights[0];
-            for (size_t i = 1; i < rots.size(); ++i) {
-                float w = weights[i];
-                float factor = w / (accum + w);
-                blendedRot = glm::slerp(blendedRot, rots[i], factor);
-                accum += w;
-            }
-        }
-
-        glm::mat4 localBlend = glm::translate(glm::mat4(1.0f), blendedTrans)
-            * glm::toMat4(blendedRot)
-            * glm::scale(glm::mat4(1.0f), blendedScale);
-        glm::mat4 globalTransform = parentTransform * localBlend;
-
-        auto& boneMap = m_ActiveAnimations.front().anim->GetBoneIDMap();
-        auto it = boneMap.find(name);
-        if (it != boneMap.end()) {
-            int idx = it->second.id;
-            assert(idx >= 0 && idx < static_cast<int>(m_BoneCount));
-            if (idx >= 0 && idx < static_cast<int>(m_BoneCount)) {
-                m_FinalBoneMatrices[idx] = globalTransform * it->second.offset;
-            }
-        }
-
-        for (int i = 0; i < node->childrenCount; ++i) {
-            CalculateBlendedNodeTransforms(&node->children[i], globalTransform);
-        }
-    }
 };
 
 #endif // ANIMATOR_H
@@ -0,0 +1,190 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+/*NOTE : Startup asset loading, decode on a thread pool and GPU upload on the main thread.
+
+  add() takes the CPU half of an asset (stb / FreeType / Assimp decode into a staging
+  object, no GL call allowed) and runs it on a worker. It returns the GL half as an
+  UploadStep, queued once the decode is done. upload() is called by the main thread
+  (the only one with the context) and runs the queued steps until budgetMs is spent,
+  at least one per call so the queue always drains. finish() keeps calling it, with a
+  frame in between, until every asset is on the GPU.
+
+  Whatever a job writes into is owned by the caller and must not be touched before its
+  UploadStep ran (the ready queue's mutex hands the decoded data over to the main thread).
+
+  Per asset timings : queued (waiting for a worker), decode (worker), waited (decoded,
+  waiting for the main thread) and upload. The decode wall time vs the decode total
+  is the speedup from the pool.
+*/
+class AssetLoader {
+public:
+    using UploadStep = std::function<void()>;
+    using DecodeStep = std::function<UploadStep()>;
+
+    struct Timing {
+        std::string name;
+        double queuedMs = 0.0;
+        double decodeMs = 0.0;
+        double waitedMs = 0.0;
+        double uploadMs = 0.0;
+    };
+
+    struct Stats {
+        size_t assets = 0;
+        unsigned int threads = 0;
+        double decodeMs = 0.0;      // Sum over the assets
+        double decodeWallMs = 0.0;  // First add() to the last decode done
+        double uploadMs = 0.0;
+        double wallMs = 0.0;        // First add() to the last upload done
+        int frames = 0;             // Frames finish() drew while waiting
+    };
+
+    // 0 threads = one per core minus the main thread
+    explicit AssetLoader(unsigned int threadCount = 0) : pool(threadCount) {
+    }
+
+    void add(const std::string& name, DecodeStep decode) {
+        Clock::time_point queuedAt = Clock::now();
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (timings.empty()) start = queuedAt;
+            timings.push_back({ name });
+            index = timings.size() - 1;
+            remaining++;
+        }
+        pool.submit([this, index, queuedAt, decode = std::move(decode)]() {
+            Clock::time_point decodeStart = Clock::now();
+            UploadStep upload = decode();
+            Clock::time_point decodeEnd = Clock::now();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            timings[index].queuedMs = msBetween(queuedAt, decodeStart);
+            timings[index].decodeMs = msBetween(decodeStart, decodeEnd);
+            decodeDone = std::max(decodeDone, decodeEnd);
+            ready.push_back({ index, std::move(upload), decodeEnd });
+        });
+    }
+
+    // Main thread, returns how many assets went up
+    size_t upload(double budgetMs) {
+        Clock::time_point budgetStart = Clock::now();
+        size_t uploaded = 0;
+        while (true) {
+            Ready job;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ready.empty()) break;
+                job = std::move(ready.front());
+                ready.pop_front();
+            }
+
+            Clock::time_point uploadStart = Clock::now();
+            if (job.upload) job.upload();
+            Clock::time_point uploadEnd = Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                timings[job.index].waitedMs = msBetween(job.readyAt, uploadStart);
+                timings[job.index].uploadMs = msBetween(uploadStart, uploadEnd);
+                uploadDone = uploadEnd;
+                remaining--;
+            }
+            uploaded++;
+            if (msBetween(budgetStart, uploadEnd) >= budgetMs) break;
+        }
+        return uploaded;
+    }
+
+    bool done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return remaining == 0;
+    }
+
+    // Uploads under the budget, frame() in between (poll events + present a loading frame)
+    void finish(double budgetMs, const std::function<void()>& frame) {
+        while (!done()) {
+            upload(budgetMs);
+            if (done()) break;
+            if (frame) frame();
+            frames++;
+        }
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats result;
+        result.assets = timings.size();
+        result.threads = pool.getThreadCount();
+        result.frames = frames;
+        for (const Timing& timing : timings) {
+            result.decodeMs += timing.decodeMs;
+            result.uploadMs += timing.uploadMs;
+        }
+        if (!timings.empty()) {
+            result.decodeWallMs = msBetween(start, std::max(start, decodeDone));
+            result.wallMs = msBetween(start, std::max(start, uploadDone));
+        }
+        return result;
+    }
+
+    void printReport(std::ostream& out) {
+        Stats total = stats();
+        std::vector<Timing> rows;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rows = timings;
+        }
+        char line[160];
+        out << "Assets : " << total.assets << " loaded in " << total.wallMs << " ms on " << total.threads << " threads\n";
+        std::snprintf(line, sizeof(line), "  %-28s %9s %9s %9s %9s\n", "asset", "queued", "decode", "waited", "upload");
+        out << line;
+        for (const Timing& row : rows) {
+            std::snprintf(line, sizeof(line), "  %-28s %9.2f %9.2f %9.2f %9.2f\n",
+                row.name.c_str(), row.queuedMs, row.decodeMs, row.waitedMs, row.uploadMs);
+            out << line;
+        }
+        double speedup = total.decodeWallMs > 0.0 ? total.decodeMs / total.decodeWallMs : 1.0;
+        std::snprintf(line, sizeof(line), "  decode %.2f ms of work in %.2f ms (x%.2f) | upload %.2f ms over %d loading frames\n",
+            total.decodeMs, total.decodeWallMs, speedup, total.uploadMs, total.frames);
+        out << line;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Ready {
+        size_t index = 0;
+        UploadStep upload;
+        Clock::time_point readyAt;
+    };
+
+    static double msBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    std::mutex mutex;
+    std::vector<Timing> timings;
+    std::deque<Ready> ready;
+    size_t remaining = 0;
+    int frames = 0;
+    Clock::time_point start;
+    Clock::time_point decodeDone;
+    Clock::time_point uploadDone;
+
+    // Last member : its destructor joins the workers before the rest goes away
+    ThreadPool pool;
+};
+
+#endif
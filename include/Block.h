@@ -4,6 +4,7 @@
 #include <array>
 #include <glm/glm.hpp>
 #include <vector>
+#include <cstdint>
 
 const int CHUNK_SIZE = 32;
 
@@ -82,13 +83,18 @@ public:
     }
 
     bool isTransparent() const;
-    int lightLevel[6] = {15 , 15 , 15 , 15 , 15 ,15};
-    int getFaceLightLevel(Face face) const {
-        return lightLevel[static_cast<int>(face)];
-    }
-    
  
-    GeometryType determineGeometryType(Type blockType);
+    static GeometryType determineGeometryType(Type blockType);
+
+    // Full opaque cube -> darkens the corners of the faces next to it (baked AO)
+    static bool castsAmbientOcclusion(Type blockType);
+
+    // Stops sky / block light (the flood fill doesn't enter it). Billboards and water let it through
+    static bool blocksLight(Type blockType);
+    // Block light given off by the block (0 - 15)
+    static uint8_t lightEmission(Type blockType);
+    // Nothing behind it can be seen (cave culling / occluders). Leaves are alpha tested, so they don't count
+    static bool occludesView(Type blockType);
 
     void initializeFaceNormals();
     //For Cubes
@@ -3,38 +3,13 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <string>
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+#include <cassert>
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
-namespace AssimpGLMHelpers {
-
-
-    inline glm::vec3 GetGLMVec(const aiVector3D& vec)
-    {
-        return glm::vec3(vec.x, vec.y, vec.z);
-    }
-
-    inline glm::quat GetGLMQuat(const aiQuaternion& quat)
-    {
-        return glm::quat(quat.w, quat.x, quat.y, quat.z);
-    }
-
-    inline glm::mat4 ConvertMatrixToGLMFormat(const aiMatrix4x4& from)
-    {
-        glm::mat4 to;
-        to[0][0] = from.a1; to[1][0] = from.a2; to[2][0] = from.a3; to[3][0] = from.a4;
-        to[0][1] = from.b1; to[1][1] = from.b2; to[2][1] = from.b3; to[3][1] = from.b4;
-        to[0][2] = from.c1; to[1][2] = from.c2; to[2][2] = from.c3; to[3][2] = from.c4;
-        to[0][3] = from.d1; to[1][3] = from.d2; to[2][3] = from.d3; to[3][3] = from.d4;
-        return to;
-    }
-
-}
 struct KeyPosition
 {
     glm::vec3 position;
@@ -69,46 +44,20 @@ private:
 
 public:
 
-    /*reads keyframes from aiNodeAnim*/
-    Bone(const std::string& name, int ID, const aiNodeAnim* channel)
+    /*keyframes of one channel, read from the scene by ModelCache*/
+    Bone(const std::string& name, int ID, std::vector<KeyPosition> positions,
+        std::vector<KeyRotation> rotations, std::vector<KeyScale> scales)
         :
+        m_Positions(std::move(positions)),
+        m_Rotations(std::move(rotations)),
+        m_Scales(std::move(scales)),
+        m_LocalTransform(1.0f),
         m_Name(name),
-        m_ID(ID),
-        m_LocalTransform(1.0f)
+        m_ID(ID)
     {
-        m_NumPositions = channel->mNumPositionKeys;
-
-        for (int positionIndex = 0; positionIndex < m_NumPositions; ++positionIndex)
-        {
-            aiVector3D aiPosition = channel->mPositionKeys[positionIndex].mValue;
-            float timeStamp = channel->mPositionKeys[positionIndex].mTime;
-            KeyPosition data;
-            data.position = AssimpGLMHelpers::GetGLMVec(aiPosition);
-            data.timeStamp = timeStamp;
-            m_Positions.push_back(data);
-        }
-
-        m_NumRotations = channel->mNumRotationKeys;
-        for (int rotationIndex = 0; rotationIndex < m_NumRotations; ++rotationIndex)
-        {
-            aiQuaternion aiOrientation = channel->mRotationKeys[rotationIndex].mValue;
-            float timeStamp = channel->mRotationKeys[rotationIndex].mTime;
-            KeyRotation data;
-            data.orientation = AssimpGLMHelpers::GetGLMQuat(aiOrientation);
-            data.timeStamp = timeStamp;
-            m_Rotations.push_back(data);
-        }
-
-        m_NumScalings = channel->mNumScalingKeys;
-        for (int keyIndex = 0; keyIndex < m_NumScalings; ++keyIndex)
-        {
-            aiVector3D scale = channel->mScalingKeys[keyIndex].mValue;
-            float timeStamp = channel->mScalingKeys[keyIndex].mTime;
-            KeyScale data;
-            data.scale = AssimpGLMHelpers::GetGLMVec(scale);
-            data.timeStamp = timeStamp;
-            m_Scales.push_back(data);
-        }
+        m_NumPositions = static_cast<int>(m_Positions.size());
+        m_NumRotations = static_cast<int>(m_Rotations.size());
+        m_NumScalings = static_cast<int>(m_Scales.size());
     }
 
     /*interpolates  b/w positions,rotations & scaling keys based on the curren time of
@@ -122,84 +71,88 @@ public:
         m_LocalTransform = translation * rotation * scale;
     }
 
+    /*same keys as Update() but left as translation / rotation / scale, for blending
+    several clips without going through a matrix (AnimationClip::samplePose)*/
+    void Sample(float animationTime, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) const
+    {
+        translation = SamplePosition(animationTime);
+        rotation = SampleRotation(animationTime);
+        scale = SampleScaling(animationTime);
+    }
+
     glm::mat4 GetLocalTransform() { return m_LocalTransform; }
     std::string GetBoneName() const { return m_Name; }
     int GetBoneID() { return m_ID; }
 
 
-    /* Gets the current index on mKeyPositions to interpolate to based on
-    the current animation time*/
-    int GetPositionIndex(float animationTime)
+    /* Gets the index on mKeyPositions to interpolate from : the last key at or before the
+    time, binary search, clamped to the first / last pair outside the keys (a clip's end
+    lands on its last key instead of running off the array)*/
+    int GetPositionIndex(float animationTime) const
     {
-        for (int index = 0; index < m_NumPositions - 1; ++index)
-        {
-            if (animationTime < m_Positions[index + 1].timeStamp)
-                return index;
-        }
-        assert(0);
+        return FindKeyIndex(m_Positions, animationTime);
     }
 
-    /* Gets the current index on mKeyRotations to interpolate to based on the
-    current animation time*/
-    int GetRotationIndex(float animationTime)
+    /* Gets the index on mKeyRotations to interpolate from*/
+    int GetRotationIndex(float animationTime) const
     {
-        for (int index = 0; index < m_NumRotations - 1; ++index)
-        {
-            if (animationTime < m_Rotations[index + 1].timeStamp)
-                return index;
-        }
-        assert(0);
+        return FindKeyIndex(m_Rotations, animationTime);
     }
 
-    /* Gets the current index on mKeyScalings to interpolate to based on the
-    current animation time */
-    int GetScaleIndex(float animationTime)
+    /* Gets the index on mKeyScalings to interpolate from*/
+    int GetScaleIndex(float animationTime) const
     {
-        for (int index = 0; index < m_NumScalings - 1; ++index)
-        {
-            if (animationTime < m_Scales[index + 1].timeStamp)
-                return index;
-        }
-        assert(0);
+        return FindKeyIndex(m_Scales, animationTime);
     }
 
+    const std::vector<KeyPosition>& GetPositionKeys() const { return m_Positions; }
+    const std::vector<KeyRotation>& GetRotationKeys() const { return m_Rotations; }
+    const std::vector<KeyScale>& GetScaleKeys() const { return m_Scales; }
+
 private:
 
     /* Gets normalized value for Lerp & Slerp*/
-    float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime)
+    float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime) const
     {
         float scaleFactor = 0.0f;
         float midWayLength = animationTime - lastTimeStamp;
         float framesDiff = nextTimeStamp - lastTimeStamp;
+        if (framesDiff <= 0.0f) return 0.0f;
         scaleFactor = midWayLength / framesDiff;
-        return scaleFactor;
+        return std::min(std::max(scaleFactor, 0.0f), 1.0f); // Holds the first / last key outside the keys
     }
 
-    /*figures out which position keys to interpolate b/w and performs the interpolation
-    and returns the translation matrix*/
-    glm::mat4 InterpolatePosition(float animationTime)
+    template <typename Key>
+    static int FindKeyIndex(const std::vector<Key>& keys, float animationTime)
     {
+        auto next = std::upper_bound(keys.begin() + 1, keys.end() - 1, animationTime,
+            [](float time, const Key& key) { return time < key.timeStamp; });
+        return static_cast<int>(next - keys.begin()) - 1;
+    }
+
+    /*figures out which position keys to interpolate b/w and performs the interpolation*/
+    glm::vec3 SamplePosition(float animationTime) const
+    {
+        if (0 == m_NumPositions)
+            return glm::vec3(0.0f);
         if (1 == m_NumPositions)
-            return glm::translate(glm::mat4(1.0f), m_Positions[0].position);
+            return m_Positions[0].position;
 
         int p0Index = GetPositionIndex(animationTime);
         int p1Index = p0Index + 1;
         float scaleFactor = GetScaleFactor(m_Positions[p0Index].timeStamp,
             m_Positions[p1Index].timeStamp, animationTime);
-        glm::vec3 finalPosition = glm::mix(m_Positions[p0Index].position,
+        return glm::mix(m_Positions[p0Index].position,
             m_Positions[p1Index].position, scaleFactor);
-        return glm::translate(glm::mat4(1.0f), finalPosition);
     }
 
-    /*figures out which rotations keys to interpolate b/w and performs the interpolation
-    and returns the rotation matrix*/
-    glm::mat4 InterpolateRotation(float animationTime)
+    /*figures out which rotations keys to interpolate b/w and performs the interpolation*/
+    glm::quat SampleRotation(float animationTime) const
     {
+        if (0 == m_NumRotations)
+            return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
         if (1 == m_NumRotations)
-        {
-            auto rotation = glm::normalize(m_Rotations[0].orientation);
-            return glm::toMat4(rotation);
-        }
+            return glm::normalize(m_Rotations[0].orientation);
 
         int p0Index = GetRotationIndex(animationTime);
         int p1Index = p0Index + 1;
@@ -207,24 +160,38 @@ private:
             m_Rotations[p1Index].timeStamp, animationTime);
         glm::quat finalRotation = glm::slerp(m_Rotations[p0Index].orientation,
             m_Rotations[p1Index].orientation, scaleFactor);
-        finalRotation = glm::normalize(finalRotation);
-        return glm::toMat4(finalRotation);
+        return glm::normalize(finalRotation);
     }
 
-    /*figures out which scaling keys to interpolate b/w and performs the interpolation
-    and returns the scale matrix*/
-    glm::mat4 InterpolateScaling(float animationTime)
+    /*figures out which scaling keys to interpolate b/w and performs the interpolation*/
+    glm::vec3 SampleScaling(float animationTime) const
     {
+        if (0 == m_NumScalings)
+            return glm::vec3(1.0f);
         if (1 == m_NumScalings)
-            return glm::scale(glm::mat4(1.0f), m_Scales[0].scale);
+            return m_Scales[0].scale;
 
         int p0Index = GetScaleIndex(animationTime);
         int p1Index = p0Index + 1;
         float scaleFactor = GetScaleFactor(m_Scales[p0Index].timeStamp,
             m_Scales[p1Index].timeStamp, animationTime);
-        glm::vec3 finalScale = glm::mix(m_Scales[p0Index].scale, m_Scales[p1Index].scale
+        return glm::mix(m_Scales[p0Index].scale, m_Scales[p1Index].scale
             , scaleFactor);
-        return glm::scale(glm::mat4(1.0f), finalScale);
+    }
+
+    glm::mat4 InterpolatePosition(float animationTime)
+    {
+        return glm::translate(glm::mat4(1.0f), SamplePosition(animationTime));
+    }
+
+    glm::mat4 InterpolateRotation(float animationTime)
+    {
+        return glm::toMat4(SampleRotation(animationTime));
+    }
+
+    glm::mat4 InterpolateScaling(float animationTime)
+    {
+        return glm::scale(glm::mat4(1.0f), SampleScaling(animationTime));
     }
 
 };
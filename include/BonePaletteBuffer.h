@@ -0,0 +1,80 @@
+#ifndef BONE_PALETTE_BUFFER_H
+#define BONE_PALETTE_BUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+/*NOTE : Model matrix + bone palette of every instance of a skinned draw, in one texture buffer.
+
+  A uniform array holds one palette (MAX_BONES in model.vert), so a crowd used to mean a
+  glUniformMatrix4fv + draw per character. Here every instance is a block of 1 + boneCount
+  matrices (model first) in a single RGBA32F buffer texture, filled on the CPU each frame
+  and uploaded with one glBufferSubData. model.vert reads block gl_InstanceID with
+  texelFetch (instancedSkin), so one glDrawElementsInstanced per mesh draws them all.
+
+  Every instance of a batch has the same bone count (same model), that's the block stride.
+*/
+class BonePaletteBuffer {
+public:
+    void Create() {
+        glGenBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void Begin(int boneCount) {
+        matrices.clear();
+        stride = boneCount + 1;
+        count = 0;
+    }
+
+    void Append(const glm::mat4& model, const glm::mat4* palette) {
+        matrices.push_back(model);
+        matrices.insert(matrices.end(), palette, palette + (stride - 1));
+        count++;
+    }
+
+    // Grows the buffer when needed (doubling), orphans it otherwise so the last frame's draw isn't waited on
+    void Upload() {
+        GLsizeiptr bytes = static_cast<GLsizeiptr>(matrices.size() * sizeof(glm::mat4));
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        if (bytes > capacity) capacity = std::max(bytes, capacity * 2);
+        glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        if (bytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, matrices.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void Bind(GLuint unit) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void Delete() {
+        glDeleteTextures(1, &texture);
+        glDeleteBuffers(1, &buffer);
+        texture = buffer = 0;
+        capacity = 0;
+    }
+
+    int GetStride() const { return stride; }   // Matrices per instance
+    int GetCount() const { return count; }     // Instances since Begin
+    size_t GetBytes() const { return matrices.size() * sizeof(glm::mat4); }
+
+private:
+    GLuint buffer = 0;
+    GLuint texture = 0;
+    GLsizeiptr capacity = 0;
+    std::vector<glm::mat4> matrices;
+    int stride = 1;
+    int count = 0;
+};
+
+#endif
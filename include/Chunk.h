@@ -5,14 +5,18 @@
 #include <array>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Block.h"
-#include "VAO.h"
-#include "VBO.h"
-#include "EBO.h"
-#include "Shaders.h"
+#include "ChunkLight.h"
+#include "SectionVisibility.h"
+#include "RangeAllocator.h"
+
+class MeshBufferPool;
 
 
 /*NOTE : THE Chunk has currently 2 meshes for SOLID and LIQUID type blocks
@@ -20,6 +24,10 @@
  messed up when the transparent geometry and solid is in the same mesh.
 
  Also now I have more control on the meshes on the indivisual level
+
+ NOTE : Chunk is part of voxel_core, so it must stay free of GL/platform headers.
+ It only builds the CPU side MeshData, the GPU objects are created and owned by
+ the renderer layer (see ChunkRenderer.h), GPUMesh just carries their names.
 */
 
 // The saviour ! ultimate compact vertex ->
@@ -30,20 +38,115 @@ struct CompactVertex {
     uint16_t u, v;
     // Normal a: 8-bit signed values (-128 to 127 maps to -1.0 to 1.0)
     int8_t nx, ny, nz;
-    // Padding (gap between bits)
-    int8_t padding = 0;
+    // Baked corner AO (took the padding byte) : 2 bits, 0 = fully occluded , 3 = open
+    uint8_t ao = 3;
+    // Baked smooth light of the corner : low nibble sky , high nibble block light
+    uint8_t light = ChunkLight::OPEN_SKY;
+    uint8_t padding = 0;
+};
+
+// A chunk is meshed as 24 sections of 16x16x16 so an edit only rebuilds the section(s) it touches
+constexpr int CHUNK_SECTION_SIZE = 16;
+constexpr int CHUNK_SECTION_COUNT = 384 / CHUNK_SECTION_SIZE;
+constexpr uint32_t ALL_CHUNK_SECTIONS = (1u << CHUNK_SECTION_COUNT) - 1;
+
+// Faces of one section, indices are relative to the section's first vertex
+struct SectionMesh {
+    std::vector<CompactVertex> vertices;
+    std::vector<uint32_t> indices;
+    int minY = 0;  // Lowest / highest non-air block of the section that went into this mesh
+    int maxY = -1; // (maxY < minY -> none), the culler's slice boxes are tightened to it
+    uint16_t visibility = SectionVisibility::ALL_CONNECTED; // Face to face connectivity for cave culling
+    bool opaque = false; // Every cell blocks the view -> the whole section is an occluder
 };
+
+// Where a section lives inside the chunk mesh. Every section gets some slack so
+// an edit can usually be patched in place, the unused indices are degenerate triangles
+struct MeshRange {
+    unsigned int firstVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int vertexCapacity = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    unsigned int indexCapacity = 0;
+    int minY = 0;  // Same as SectionMesh
+    int maxY = -1;
+    uint16_t visibility = SectionVisibility::ALL_CONNECTED;
+    bool opaque = false;
+};
+
+// Where a patched section sits in the staging buffers of a released mesh
+struct StagedSection {
+    unsigned int vertexOffset = 0;
+    unsigned int indexOffset = 0;
+};
+
 struct MeshData {
     std::vector<CompactVertex> vertices;
     std::vector<uint32_t> indices;
-    unsigned int vertexcount;
-    unsigned int indexcount;
+    unsigned int vertexcount = 0; // Buffer sizes, slack included (indexcount is what gets drawn)
+    unsigned int indexcount = 0;
+
+    std::array<MeshRange, CHUNK_SECTION_COUNT> sections{};
+    uint32_t dirtySections = 0;   // Ranges patched in place -> glBufferSubData
+    bool layoutChanged = false;   // Ranges moved -> the whole buffer gets re-specified
+
+    // Once the GPU has it only the layout is kept, vertices/indices then just stage
+    // the patched sections until the next upload (see sectionVertices/sectionIndices)
+    bool released = false;
+    std::array<StagedSection, CHUNK_SECTION_COUNT> staged{};
+
+    unsigned int usedVertexCount() const;
+    unsigned int usedIndexCount() const;
+
+    void clear();
+    // Sizes the buffers for a whole chunk (slack included) so appending never reallocates
+    void allocateFor(const std::array<SectionMesh, CHUNK_SECTION_COUNT>& src, MeshBufferPool* pool);
+    // Appends section `section` of the chunk at the end of the buffers (used while building the
+    // chunk section by section, the neighbouring sections decide the slack of an empty one)
+    void appendSection(int section, const std::array<SectionMesh, CHUNK_SECTION_COUNT>& chunkSections);
+    // Overwrites a section in its slot, false if it doesn't fit anymore
+    bool patchSection(int section, const SectionMesh& src);
+    // Rebuilds the whole layout with fresh slack, swapping in the given section (CPU copy required)
+    void relayoutWithSection(int section, const SectionMesh& src);
+
+    // Data to upload for a section, the slot of a resident mesh or the staged copy of a released one
+    const CompactVertex* sectionVertices(int section) const;
+    const uint32_t* sectionIndices(int section) const;
+
+    // Drops the CPU copy after the upload, the layout stays so sections can still be patched.
+    // Kept as long as patched sections haven't been uploaded (dirtySections)
+    void releaseCpuCopy(MeshBufferPool* pool);
+    // Gives everything back (the mesh is empty afterwards)
+    void release(MeshBufferPool* pool);
+
+    size_t cpuBytes() const;
+
+private:
+    void dropCpuCopy(MeshBufferPool* pool);
+};
+
+// Terrain under each 4x4 tile of columns that is solid in every column of the tile, [bottom, top) in
+// chunk y. The occlusion rasterizer draws them as boxes (top <= bottom -> the tile has none)
+constexpr int OCCLUDER_TILE_SIZE = 4;
+constexpr int OCCLUDER_TILES_PER_SIDE = CHUNK_SECTION_SIZE / OCCLUDER_TILE_SIZE;
+struct OccluderColumns {
+    std::array<int16_t, OCCLUDER_TILES_PER_SIDE * OCCLUDER_TILES_PER_SIDE> bottom{};
+    std::array<int16_t, OCCLUDER_TILES_PER_SIDE * OCCLUDER_TILES_PER_SIDE> top{};
 };
 
+// A remeshed section waiting to be patched into the front mesh
+struct SectionPatch {
+    int section = 0;
+    SectionMesh solid;
+    SectionMesh liquid;
+};
+
+// Where the mesh sits in the renderer's shared vertex / index buffers, filled in by ChunkRenderer
+// (ranges are in vertices / indices, invalid = nothing uploaded yet)
 struct GPUMesh {
-    VAO vao;
-    VBO vbo;
-    EBO ebo;
+    RangeAllocator::Range vertexRange;
+    RangeAllocator::Range indexRange;
     bool buffers_Initialised = false;
     bool needsUpload = false;
 };
@@ -59,10 +162,6 @@ private:
 
     std::vector<Block::Type> blocks; //Flat array , the index is determied by a util method -> blockIndex()
 
-    std::vector<CompactVertex> vertices;
-    std::vector<uint32_t> indices; // Changed to uint32_t
-    unsigned int vertexCount = 0;
-    unsigned int indexCount = 0;
     glm::ivec3 position;
     bool active = true;
 
@@ -80,37 +179,49 @@ public:
     GPUMesh LiquidBuffers;
     std::mutex dataMutex;
 
+    // Back buffers of the double buffered mesh : remesh workers publish into these and
+    // the main thread swaps them with SolidMesh/LiquidMesh right before the upload
+    MeshData PendingSolidMesh;
+    MeshData PendingLiquidMesh;
+    bool hasPendingFullMesh = false;          // Guarded by meshSwapMutex
+    std::vector<SectionPatch> PendingSections; // Guarded by meshSwapMutex
+    std::mutex meshSwapMutex;
+    std::atomic<bool> hasPendingMesh{ false };
+    bool needsFullRemesh = false; // Main thread : a patch didn't fit a released mesh, only a full remesh can fix it
+
+    // Occluder boxes matching the front mesh, published by the mesher like the meshes are
+    OccluderColumns occluders;
+    OccluderColumns PendingOccluders; // Guarded by meshSwapMutex
+    bool hasPendingOccluders = false;  // Guarded by meshSwapMutex
+
+    // Sky + block light, written by the LightEngine (see LightEngine.h for who may touch it when)
+    ChunkLight light;
+
     std::array<Chunk*, 4> neighbors = {nullptr , nullptr , nullptr , nullptr }; // North | South | East | West //
 
     bool isUploadedToGPU() const;
 
     int getVertexCount() const {
-        return SolidMesh.vertexcount + LiquidMesh.vertexcount;
+        return SolidMesh.usedVertexCount() + LiquidMesh.usedVertexCount();
     }
 
     int getIndexCount() const {
-        return SolidMesh.indexcount + LiquidMesh.indexcount;
+        return SolidMesh.usedIndexCount() + LiquidMesh.usedIndexCount();
     }
 
 
     Chunk(glm::ivec3 pos) : position(pos) {
         blocks.resize(TOTAL_BLOCKS, Block::Type::AIR);
-        int estimatedVisibleFaces = 2 * CHUNK_SIZE * CHUNK_SIZE +
-            4 * CHUNK_SIZE * CHUNK_DEPTH;
-        vertices.reserve(estimatedVisibleFaces * 4);
-        indices.reserve(estimatedVisibleFaces * 6); // Using 32bit int now so yeah...
-    }
-
-    ~Chunk() {
-        freeGLResources();
     }
 
     bool hasAllNeighbours();
-    void freeGLResources();
 
+    // Clears the CPU meshes, GPU buffers must be released through the renderer
     void reset();
 
-    bool isValid() const;
+    // Turns an evicted chunk back into an empty one at pos (ChunkPool). The GL object
+    // names stay, the next upload respecifies the buffers
+    void recycle(const glm::ivec3& pos);
 
     // Convert 3D position to flat array index //
     inline int blockIndex(int x, int z, int y) const;
@@ -119,17 +230,29 @@ public:
 
     Block::Type getBlockType(int x, int z, int y) const;
 
-    void generateMeshData();
-    std::vector<float> getVertexData() const;
-    void uploadToGPU();
+    // Meshes straight into SolidMesh/LiquidMesh, only for chunks nobody else can see yet
+    void generateMeshData(MeshBufferPool* pool = nullptr);
 
-    void setupVertexAttributes();
+    // Worker side of a remesh : builds a right sized mesh and publishes it as the pending mesh
+    void generatePendingMeshData(MeshBufferPool* pool = nullptr);
 
-    std::vector<float> getFlatVertexData(const std::vector<CompactVertex>& vertices) const;
+    // Worker side of an edit : rebuilds only the sections in sectionMask and publishes them as patches
+    void generatePendingSections(uint32_t sectionMask, SectionMesh& solidScratch, SectionMesh& liquidScratch);
+
+    // Sections whose mesh can change when the block at localPos changes (vertical neighbours included)
+    static uint32_t sectionsTouchedBy(const glm::ivec3& localPos);
+
+    // Main thread : swaps a published mesh in, returns false if nothing was pending
+    bool swapPendingMesh(MeshBufferPool* pool = nullptr);
+
+    // Main thread, after the upload : the GPU has the meshes, keep only what patching needs
+    void releaseCpuMeshes(MeshBufferPool* pool = nullptr);
 
     void setActive(bool st) { this->active = st; };
     void setPosition(glm::vec3 pos) { this->position = pos; };
     bool isActive() { return this->active; };
+    // Uploaded by the ChunkUploader (either mesh), set/cleared on the main thread only
+    bool hasGpuMesh() const { return SolidBuffers.buffers_Initialised || LiquidBuffers.buffers_Initialised; }
 
     void saveToDisk(const std::string& filePath);
 
@@ -137,14 +260,33 @@ public:
 
 private:
     
+    void buildMeshData(MeshData& solid, MeshData& liquid, MeshBufferPool* pool);
+
+    // Solid runs under the occluder tiles (caller holds dataMutex)
+    void buildOccluderColumns(OccluderColumns& columns) const;
+
+    // Meshes the blocks of one section, positions stay chunk relative
+    void buildSection(int section, SectionMesh& solid, SectionMesh& liquid);
+
+    void addFaceVertices(int x, int y, int z, Block::Face face, const Block& block , SectionMesh& meshdata);
+
+    void addVertex(float x, float y, float z, float u, float v, const glm::vec3& normal , std::vector<CompactVertex>& vertices);
+
+    // Block lookup that follows the 4 neighbour pointers (diagonal chunks count as air)
+    Block::Type getBlockTypeAcrossBorders(int x, int z, int y) const;
+
+    // AO of one face corner from the 2 side blocks + the corner block in front of the face
+    uint8_t cornerAO(int x, int y, int z, const glm::ivec3& normal, const glm::ivec3& corner) const;
 
-    void addFaceVertices(int x, int y, int z, Block::Face face, const Block& block , MeshData& meshdata);
+    // Packed light lookup that follows the neighbour pointers, -1 when it isn't known (diagonal / unloaded chunk)
+    int getLightAcrossBorders(int x, int z, int y) const;
 
-    void addVertex(float x, float y, float z, float u, float v, const glm::vec3& normal , std::vector<CompactVertex>& vertices , unsigned int& vertexCount);
+    // Smooth light of one face corner : average of the front , side and corner cells light can get through
+    uint8_t cornerLight(int x, int y, int z, const glm::ivec3& normal, const glm::ivec3& corner) const;
 
 
 public:
-    Block& getBlockAtLocalPos(const glm::ivec3& localPos);
+    Block getBlockAtLocalPos(const glm::ivec3& localPos);
 
     void setBlockAtLocalPos(const glm::vec3& localPos, Block::Type type);
 
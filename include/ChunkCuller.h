@@ -0,0 +1,116 @@
+#ifndef CHUNK_CULLER_CLASS_H
+#define CHUNK_CULLER_CLASS_H
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "Frustum.h"
+#include "OcclusionBuffer.h"
+
+// A chunk that survived culling, the masks say which of its sections to draw (ALL_CHUNK_SECTIONS = whole mesh)
+struct VisibleChunk {
+    Chunk* chunk = nullptr;
+    uint32_t solidSections = 0;
+    uint32_t liquidSections = 0;
+};
+
+/*NOTE : CPU frustum culling of the chunk meshes, run once per frame before the draws.
+
+  A chunk is 16x384x16 but most of it is air or buried stone, so instead of one box
+  per chunk every 16 high section that has faces gets its own box, tightened in y to
+  the lowest / highest non-air block the mesher saw in it (MeshRange::minY/maxY).
+  All the boxes go through the SIMD plane test in one batch and the result is a
+  single visible list that the solid and the liquid pass both walk.
+
+  Cave culling on top of that : a BFS over the sections starting at the camera's,
+  only stepping out through a face the section connects to the face it was entered
+  by (MeshRange::visibility) and never back towards the camera. Sections it never
+  reaches are hidden behind solid ground, whatever the frustum says.
+
+  Last, the slices still visible are tested against a small software depth buffer
+  (OcclusionBuffer) of the solid terrain near the camera : the column occluders of
+  every chunk (Chunk::occluders) plus its fully opaque sections. That is what hides
+  the valleys behind a hill, which the cave BFS can see into over the top.
+*/
+class ChunkCuller {
+public:
+    struct Stats {
+        size_t chunksTested = 0;
+        size_t chunksDrawn = 0;
+        size_t slicesTested = 0;
+        size_t slicesDrawn = 0;
+        size_t slicesOccluded = 0;  // In the frustum but unreachable from the camera (cave culling)
+        size_t sectionsVisited = 0; // BFS nodes
+        size_t slicesHidden = 0;    // Passed frustum + cave culling, behind the occlusion buffer
+        size_t occluderTriangles = 0;
+        double occlusionMs = 0.0;   // Occluder rasterization + Hi-Z build
+
+        size_t chunksCulled() const { return chunksTested - chunksDrawn; }
+        size_t slicesCulled() const { return slicesTested - slicesDrawn - slicesOccluded - slicesHidden; }
+    };
+
+    // Rebuilds the visible list from the chunks that have a mesh on the GPU
+    const std::vector<VisibleChunk>& cull(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks);
+
+    const std::vector<VisibleChunk>& getVisible() const { return visible; }
+    const Stats& getStats() const { return stats; }
+
+    // Switches for both tests (off = draw what the other one keeps, to compare against)
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+    void setCaveCulling(bool enabled) { caveCulling = enabled; }
+    bool isCaveCulling() const { return caveCulling; }
+    void setOcclusionCulling(bool enabled) { occlusionCulling = enabled; }
+    bool isOcclusionCulling() const { return occlusionCulling; }
+
+    // Threads rasterizing the occlusion buffer (one band of rows each) and how far
+    // from the camera (in chunks) the terrain gets drawn into it
+    void setOcclusionThreads(int threads) { occlusionThreads = threads; }
+    void setOccluderDistance(int chunks) { occluderDistance = chunks; }
+    const OcclusionBuffer& getOcclusionBuffer() const { return occlusion; }
+
+    // World space box of a section (y tightened to its blocks), false if the section has no faces
+    static bool sectionBounds(Chunk& chunk, int section, glm::vec3& min, glm::vec3& max);
+
+private:
+    struct SliceRef {
+        uint32_t chunk;
+        uint32_t section;
+    };
+
+    struct VisibilityNode {
+        uint32_t chunk;
+        int8_t section;
+        int8_t entryFace;   // -1 for the camera's section
+        uint8_t directions; // Faces stepped through so far, the BFS never steps back against one
+    };
+
+    bool enabled = true;
+    bool caveCulling = true;
+    bool occlusionCulling = true;
+    int occlusionThreads = 4;
+    int occluderDistance = 8;
+    OcclusionBuffer occlusion;
+    BoxList boxes;
+    std::vector<SliceRef> slices;
+    std::vector<uint8_t> boxVisible;
+    std::vector<VisibleChunk> visible;
+    Stats stats;
+
+    // Cave culling state : chunk lookup grid (chunk coords -> index into the chunk list or -1)
+    std::vector<int32_t> grid;
+    glm::ivec2 gridMin{ 0 };
+    glm::ivec2 gridSize{ 0 };
+    std::vector<uint32_t> reachable; // Per chunk, bit s = section s reached
+    std::vector<VisibilityNode> queue;
+
+    // Fills reachable, false when the camera isn't inside a loaded section (then nothing gets occluded)
+    bool floodFromCamera(const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks);
+    // Top of the occluder column of a tile, tile coords may be one step into a neighbour chunk
+    static int occluderTopAt(const Chunk& chunk, int tx, int tz);
+    void rasterizeOccluders(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks);
+};
+
+#endif
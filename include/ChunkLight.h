@@ -0,0 +1,115 @@
+#ifndef CHUNK_LIGHT_CLASS_H
+#define CHUNK_LIGHT_CLASS_H
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/*NOTE : Light storage of a chunk. One byte per voxel split in two nibbles
+  (low = skylight , high = block light), allocated per 16^3 section.
+
+  A null section means "open sky" : skylight 15 everywhere and no block light.
+  That is everything above the terrain, so most sections never get allocated.
+
+  Indices use the same layout as Chunk::blockIndex (y * 256 + z * 16 + x), so
+  index >> 12 is the section and index & 4095 the cell inside it.
+
+  Remesh workers read the light of cached chunks (theirs and the neighbours') while the
+  main thread's BFS writes it, so a section is filled before its pointer is published
+  (release store / acquire load) and a reader sees either open sky or the whole filled
+  section. The levels are relaxed atomic bytes (plain loads / stores on anything we run on),
+  a remesh racing an edit can bake a half propagated value but never tears one, and the
+  propagation marks those sections dirty so they get remeshed.
+*/
+
+enum class LightChannel {
+    SKY = 0,
+    BLOCK = 1
+};
+
+// A cell waiting in a BFS queue, level = the light it had when it was queued
+struct LightNode {
+    uint32_t index;
+    uint8_t level;
+};
+
+struct LightSection {
+    std::array<std::atomic<uint8_t>, 4096> levels;
+};
+
+struct ChunkLight {
+    static const int SECTION_COUNT = 24;
+    static const uint8_t OPEN_SKY = 0x0F; // Sky 15 , block 0
+
+    std::array<std::unique_ptr<LightSection>, SECTION_COUNT> owned; // Main thread / owner only
+    std::array<std::atomic<LightSection*>, SECTION_COUNT> sections{}; // What readers go through
+
+    // Work waiting for the LightEngine, per channel. Light crossing in from a
+    // neighbouring chunk is pushed here by the neighbour's BFS.
+    std::array<std::vector<LightNode>, 2> pendingAdds;
+    std::array<std::vector<LightNode>, 2> pendingRemovals;
+    bool queued = false;          // Already in the engine's active list
+
+    const LightSection* getSection(int section) const {
+        return sections[section].load(std::memory_order_acquire);
+    }
+
+    uint8_t getPacked(uint32_t index) const {
+        const LightSection* section = getSection(index >> 12);
+        return section ? section->levels[index & 4095].load(std::memory_order_relaxed) : OPEN_SKY;
+    }
+
+    uint8_t get(uint32_t index, LightChannel channel) const {
+        uint8_t packed = getPacked(index);
+        return channel == LightChannel::SKY ? (packed & 0x0F) : (packed >> 4);
+    }
+
+    void set(uint32_t index, LightChannel channel, uint8_t level) {
+        LightSection* section = owned[index >> 12].get();
+        if (!section) section = allocateSection(index >> 12, OPEN_SKY);
+        // Only one writer, the load + store doesn't need to be a read-modify-write
+        std::atomic<uint8_t>& cell = section->levels[index & 4095];
+        uint8_t packed = cell.load(std::memory_order_relaxed);
+        cell.store(channel == LightChannel::SKY
+            ? static_cast<uint8_t>((packed & 0xF0) | level)
+            : static_cast<uint8_t>((packed & 0x0F) | (level << 4)), std::memory_order_relaxed);
+    }
+
+    // Filled first, published after : a reader never sees the section before its fill
+    LightSection* allocateSection(int section, uint8_t fill) {
+        auto fresh = std::make_unique<LightSection>();
+        for (std::atomic<uint8_t>& cell : fresh->levels) cell.store(fill, std::memory_order_relaxed);
+        sections[section].store(fresh.get(), std::memory_order_release);
+        owned[section] = std::move(fresh);
+        return owned[section].get();
+    }
+
+    // Only on a chunk no reader can reach (new or recycled)
+    void clearSections() {
+        for (int section = 0; section < SECTION_COUNT; section++) {
+            sections[section].store(nullptr, std::memory_order_release);
+            owned[section].reset();
+        }
+    }
+
+    // Back to "nothing lit yet" (a recycled chunk gets relit from scratch anyway)
+    void clear() {
+        clearSections();
+        for (int channel = 0; channel < 2; channel++) {
+            pendingAdds[channel].clear();
+            pendingRemovals[channel].clear();
+        }
+        queued = false;
+    }
+
+    size_t allocatedSections() const {
+        size_t count = 0;
+        for (const auto& section : owned) count += section ? 1 : 0;
+        return count;
+    }
+};
+
+#endif
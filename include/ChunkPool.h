@@ -0,0 +1,61 @@
+#ifndef CHUNK_POOL_CLASS_H
+#define CHUNK_POOL_CLASS_H
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "ChunkUploader.h"
+
+/*NOTE : Recycles evicted chunks instead of freeing them and allocating new ones.
+
+  A chunk is ~400 KB of block storage + its light + mesh buffers, walking around
+  used to free and allocate that for every chunk crossing the render distance.
+  Evicted chunks park here (their ranges in the renderer's mesh buffers included,
+  the next upload reuses them when the new mesh fits) and acquire() hands them back
+  out reset to an empty chunk at the new position.
+
+  recycle() runs on the main thread (GPU ranges of chunks over the high-water mark
+  get released there), acquire() on the streaming thread.
+*/
+class ChunkPool {
+public:
+    struct Stats {
+        size_t acquires = 0;
+        size_t hits = 0;      // acquire served by a recycled chunk
+        size_t recycled = 0;  // chunks parked in the pool
+        size_t dropped = 0;   // chunks freed because the pool was at its high-water mark
+        size_t pooled = 0;    // chunks currently waiting in the pool
+
+        double hitRate() const { return acquires ? static_cast<double>(hits) / acquires : 0.0; }
+    };
+
+    explicit ChunkPool(size_t highWaterMark = 64) : highWaterMark(highWaterMark) {}
+
+    // Empty (all air) chunk at pos, recycled if the pool has one
+    std::shared_ptr<Chunk> acquire(const glm::ivec3& pos);
+
+    // Takes an evicted chunk nobody else references anymore
+    void recycle(std::shared_ptr<Chunk> chunk, ChunkUploader* uploader);
+
+    // Most chunks kept around, the extra ones are freed (lowering it trims the pool right away)
+    void setHighWaterMark(size_t mark, ChunkUploader* uploader);
+    size_t getHighWaterMark() const { return highWaterMark; }
+
+    // Frees every pooled chunk (GL side included when an uploader is given)
+    void clear(ChunkUploader* uploader);
+
+    Stats getStats() const;
+
+private:
+    size_t highWaterMark;
+    std::vector<std::shared_ptr<Chunk>> freeChunks;
+    Stats stats;
+    mutable std::mutex poolMutex;
+
+    void trim(size_t mark, ChunkUploader* uploader);
+};
+
+#endif
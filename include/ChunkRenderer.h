@@ -0,0 +1,95 @@
+#ifndef CHUNK_RENDERER_CLASS_H
+#define CHUNK_RENDERER_CLASS_H
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include "Chunk.h"
+#include "ChunkCuller.h"
+#include "ChunkUploader.h"
+#include "RangeAllocator.h"
+
+/*NOTE : GL side of the chunks.
+
+  Every chunk mesh (solid and liquid) lives in one big vertex buffer + one big index
+  buffer behind a single VAO, each mesh owns a range of both (RangeAllocator). A pass
+  is one glMultiDrawElementsIndirect over a command buffer built from the visible list,
+  the chunk position comes in through an instanced attribute (location 7) picked by
+  the command's baseInstance.
+
+  Without ARB_multi_draw_indirect / ARB_base_instance (plain GL 3.3) the same ranges
+  are drawn one by one with glDrawElementsBaseVertex and the chunk position set as a
+  constant attribute.
+
+  The buffers double when an allocation doesn't fit (glCopyBufferSubData keeps the
+  meshes already in there), releasing a chunk only gives its ranges back.
+*/
+class ChunkRenderer : public ChunkUploader {
+public:
+    struct Stats {
+        size_t drawCalls = 0; // Last frame, both passes
+        size_t ranges = 0;    // Index ranges drawn last frame (= indirect commands)
+        size_t growths = 0;
+        RangeAllocator::Stats vertexArena;
+        RangeAllocator::Stats indexArena;
+        uint32_t vertexCapacity = 0;
+        uint32_t indexCapacity = 0;
+        double vertexFragmentation = 0.0;
+    };
+
+    void upload(Chunk& chunk) override;
+    void release(Chunk& chunk) override;
+
+    // One pass over the visible list (sections picked by the masks ChunkCuller filled in)
+    void drawSolid(const std::vector<VisibleChunk>& visible);
+    void drawLiquid(const std::vector<VisibleChunk>& visible);
+
+    bool usesIndirect() const { return indirect; }
+    Stats getStats() const;
+
+    // Starts counting draw calls for a new frame
+    void beginFrame();
+
+    // Deletes the shared buffers (GL context still current)
+    void shutdown();
+
+private:
+    // Layout of one glMultiDrawElementsIndirect command
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    bool initialised = false;
+    bool indirect = false;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    GLuint commandBuffer = 0;
+    GLuint offsetBuffer = 0;
+    RangeAllocator vertexArena;
+    RangeAllocator indexArena;
+
+    std::vector<DrawCommand> commands;
+    std::vector<float> chunkOffsets;
+    size_t drawCalls = 0;
+    size_t rangesDrawn = 0;
+    size_t growths = 0;
+
+    void initialise();
+    void uploadMesh(MeshData& mesh, GPUMesh& buffers);
+    void releaseMesh(GPUMesh& buffers);
+    void drawPass(const std::vector<VisibleChunk>& visible, bool liquid);
+
+    // Makes room for a range, doubling the GL buffer when the arena is full
+    RangeAllocator::Range allocate(RangeAllocator& arena, GLuint& buffer, GLenum target, size_t elementSize, uint32_t count);
+
+    void setupVertexAttributes();
+
+    std::vector<float> getFlatVertexData(const CompactVertex* vertices, size_t count) const;
+};
+
+#endif
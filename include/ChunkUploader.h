@@ -0,0 +1,23 @@
+#ifndef CHUNK_UPLOADER_CLASS_H
+#define CHUNK_UPLOADER_CLASS_H
+#pragma once
+
+class Chunk;
+
+/*NOTE : This is the only seam between voxel_core (World/Chunk) and the GPU.
+  World calls it from the main thread (inside updateChunks) whenever a mesh is
+  ready or a chunk is thrown out, the game plugs in ChunkRenderer and headless
+  tools (benchmarks etc.) just leave it null so the meshes stay on the CPU.
+*/
+class ChunkUploader {
+public:
+    virtual ~ChunkUploader() = default;
+
+    // Push the chunk's current Solid/Liquid MeshData to the GPU
+    virtual void upload(Chunk& chunk) = 0;
+
+    // Free every GPU object the chunk owns
+    virtual void release(Chunk& chunk) = 0;
+};
+
+#endif
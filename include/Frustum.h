@@ -0,0 +1,35 @@
+#ifndef FRUSTUM_CLASS_H
+#define FRUSTUM_CLASS_H
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// The 6 clip planes of a view-projection matrix, normal pointing inside (a*x + b*y + c*z + d >= 0)
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    static Frustum fromViewProjection(const glm::mat4& viewProjection);
+};
+
+// World space boxes laid out as separate arrays so the plane test can do 4 at a time.
+// The arrays are padded to a multiple of 4, the padding boxes are never reported
+struct BoxList {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    size_t count = 0;
+
+    void clear();
+    void add(const glm::vec3& min, const glm::vec3& max);
+};
+
+// visible[i] = 1 if box i is at least partly inside the frustum. Conservative : a box
+// outside near a frustum corner can still pass (it only gets rejected plane by plane)
+void cullBoxes(const Frustum& frustum, const BoxList& boxes, std::vector<uint8_t>& visible);
+
+// Plain one box at a time version (reference for the bench, and the fallback without SSE)
+void cullBoxesScalar(const Frustum& frustum, const BoxList& boxes, std::vector<uint8_t>& visible);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HASH_H
+#define HASH_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*NOTE : FNV-1a 64 bit, for the keys of the on-disk caches (IBL maps, program binaries).
+  Chain calls by passing the previous result as the seed. Not for anything that has to
+  resist someone picking collisions on purpose.
+*/
+constexpr uint64_t FNV1A64_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV1A64_PRIME = 1099511628211ull;
+
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t hash = FNV1A64_OFFSET) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A64_PRIME;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a64(const std::string& text, uint64_t hash = FNV1A64_OFFSET) {
+    return fnv1a64(text.data(), text.size(), hash);
+}
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef IBL_CACHE_H
+#define IBL_CACHE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Hash.h"
+#include "SphericalHarmonics.h"
+
+/*NOTE : Disk cache of the baked IBL data (environment cubemap, prefilter, BRDF LUT + the SH9 sky irradiance).
+
+  Baking renders a few hundred cube faces at startup and only changes with the HDRI or the
+  shaders doing the bake. The key is a FNV-1a hash of those files + FORMAT_VERSION (bump it
+  when a size / format in RenderEngine or the SH projection changes), it's written in the
+  file header and a file
+  with another key is ignored, then overwritten after the next bake.
+
+  save() reads every mip level back with glGetTexImage as half floats (same as the GPU
+  storage, nothing lost), load() uploads them straight into new textures, no FBO and no
+  shader on that path. The SH coefficients go in as they are.
+
+  File : header | SH coefficients | per texture { desc, per level { width, height, face data } }
+*/
+class IBLCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    struct Maps {
+        GLuint envCubeMap = 0;
+        GLuint prefilterMap = 0;
+        GLuint brdfLUT = 0;
+        IrradianceSH irradiance;
+    };
+
+    // 0 when one of the files can't be read (-> no caching this run)
+    static uint64_t computeKey(const std::vector<std::string>& files) {
+        uint64_t hash = fnv1a64(&FORMAT_VERSION, sizeof(FORMAT_VERSION));
+        for (const std::string& file : files) {
+            std::ifstream in(file, std::ios::binary);
+            if (!in) {
+                std::cerr << "IBL cache : can't read " << file << ", not caching\n";
+                return 0;
+            }
+            std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            uint64_t size = bytes.size();
+            hash = fnv1a64(&size, sizeof(size), hash);
+            hash = fnv1a64(bytes.data(), bytes.size(), hash);
+        }
+        return hash;
+    }
+
+    // Creates the textures from the file, false (and nothing created) on a miss
+    static bool load(const std::string& path, uint64_t key, Maps& maps) {
+        if (key == 0) return false;
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        Reader reader{ file.data(), file.data() + file.size() };
+        Header header;
+        if (!reader.read(header) || header.magic != MAGIC || header.version != FORMAT_VERSION || header.key != key)
+            return false;
+        if (!reader.read(maps.irradiance)) return false;
+
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        GLuint* textures[TEXTURE_COUNT] = { &maps.envCubeMap, &maps.prefilterMap, &maps.brdfLUT };
+        bool ok = true;
+        for (int t = 0; t < TEXTURE_COUNT && ok; t++)
+            ok = loadTexture(reader, *textures[t]);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+        if (!ok) {
+            std::cerr << "IBL cache : " << path << " is truncated, baking again\n";
+            for (GLuint* texture : textures) {
+                if (*texture) glDeleteTextures(1, texture);
+                *texture = 0;
+            }
+        }
+        return ok;
+    }
+
+    static bool save(const std::string& path, uint64_t key, const Maps& maps) {
+        if (key == 0) return false;
+
+        GLint packAlignment;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        std::vector<char> file;
+        Header header{ MAGIC, FORMAT_VERSION, key };
+        append(file, header);
+        append(file, maps.irradiance);
+        saveTexture(file, GL_TEXTURE_CUBE_MAP, maps.envCubeMap);
+        saveTexture(file, GL_TEXTURE_CUBE_MAP, maps.prefilterMap);
+        saveTexture(file, GL_TEXTURE_2D, maps.brdfLUT);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+
+        std::filesystem::path filePath(path);
+        if (filePath.has_parent_path()) std::filesystem::create_directories(filePath.parent_path());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.write(file.data(), file.size())) {
+            std::cerr << "IBL cache : could not write " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x43424949; // "IIBC"
+    static constexpr int TEXTURE_COUNT = 3;
+    static constexpr int MAX_LEVELS = 16;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+    };
+
+    struct TextureDesc {
+        uint32_t target;          // GL_TEXTURE_CUBE_MAP / GL_TEXTURE_2D
+        uint32_t internalFormat;  // GL_RGB16F / GL_RG16F
+        uint32_t format;          // GL_RGB / GL_RG
+        uint32_t minFilter;
+        uint32_t magFilter;
+        uint32_t levels;
+    };
+
+    struct Reader {
+        const char* cursor;
+        const char* end;
+
+        template <typename T>
+        bool read(T& value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+        const char* take(size_t bytes) {
+            if (static_cast<size_t>(end - cursor) < bytes) return nullptr;
+            const char* data = cursor;
+            cursor += bytes;
+            return data;
+        }
+    };
+
+    template <typename T>
+    static void append(std::vector<char>& file, const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        file.insert(file.end(), bytes, bytes + sizeof(T));
+    }
+
+    static int faceCount(GLenum target) { return target == GL_TEXTURE_CUBE_MAP ? 6 : 1; }
+    static GLenum faceTarget(GLenum target, int face) { return target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target; }
+    static size_t channelCount(GLenum format) { return format == GL_RGB ? 3 : format == GL_RG ? 2 : format == GL_RED ? 1 : 4; }
+    static GLenum pixelFormat(GLint internalFormat) {
+        switch (internalFormat) {
+        case GL_RGB16F: return GL_RGB;
+        case GL_RG16F: return GL_RG;
+        case GL_R16F: return GL_RED;
+        default: return GL_RGBA;
+        }
+    }
+
+    static void saveTexture(std::vector<char>& file, GLenum target, GLuint texture) {
+        glBindTexture(target, texture);
+        GLint internalFormat, minFilter, magFilter;
+        glGetTexLevelParameteriv(faceTarget(target, 0), 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        glGetTexParameteriv(target, GL_TEXTURE_MIN_FILTER, &minFilter);
+        glGetTexParameteriv(target, GL_TEXTURE_MAG_FILTER, &magFilter);
+
+        // Every level that's allocated (the prefilter map has its whole mip chain)
+        std::vector<glm::ivec2> sizes;
+        for (int level = 0; level < MAX_LEVELS; level++) {
+            GLint w = 0, h = 0;
+            glGetTexLevelParameteriv(faceTarget(target, 0), level, GL_TEXTURE_WIDTH, &w);
+            glGetTexLevelParameteriv(faceTarget(target, 0), level, GL_TEXTURE_HEIGHT, &h);
+            if (w == 0 || h == 0) break;
+            sizes.push_back(glm::ivec2(w, h));
+            if (w == 1 && h == 1) break;
+        }
+
+        TextureDesc desc{ target, static_cast<uint32_t>(internalFormat), pixelFormat(internalFormat),
+            static_cast<uint32_t>(minFilter), static_cast<uint32_t>(magFilter), static_cast<uint32_t>(sizes.size()) };
+        append(file, desc);
+
+        std::vector<char> pixels;
+        for (uint32_t level = 0; level < desc.levels; level++) {
+            append(file, sizes[level]);
+            pixels.resize(static_cast<size_t>(sizes[level].x) * sizes[level].y * channelCount(desc.format) * sizeof(GLhalf));
+            for (int face = 0; face < faceCount(target); face++) {
+                glGetTexImage(faceTarget(target, face), level, desc.format, GL_HALF_FLOAT, pixels.data());
+                file.insert(file.end(), pixels.begin(), pixels.end());
+            }
+        }
+        glBindTexture(target, 0);
+    }
+
+    static bool loadTexture(Reader& reader, GLuint& texture) {
+        TextureDesc desc;
+        if (!reader.read(desc) || desc.levels == 0 || desc.levels > MAX_LEVELS) return false;
+        GLenum target = desc.target;
+
+        glGenTextures(1, &texture);
+        glBindTexture(target, texture);
+        bool ok = true;
+        for (uint32_t level = 0; level < desc.levels && ok; level++) {
+            glm::ivec2 size;
+            if (!reader.read(size) || size.x <= 0 || size.y <= 0) {
+                ok = false;
+                break;
+            }
+            size_t faceBytes = static_cast<size_t>(size.x) * size.y * channelCount(desc.format) * sizeof(GLhalf);
+            for (int face = 0; face < faceCount(target); face++) {
+                const char* pixels = reader.take(faceBytes);
+                if (!pixels) {
+                    ok = false;
+                    break;
+                }
+                glTexImage2D(faceTarget(target, face), level, desc.internalFormat, size.x, size.y, 0, desc.format, GL_HALF_FLOAT, pixels);
+            }
+        }
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (target == GL_TEXTURE_CUBE_MAP) glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, desc.minFilter);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, desc.magFilter);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, desc.levels - 1);
+        glBindTexture(target, 0);
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef LIGHT_ENGINE_CLASS_H
+#define LIGHT_ENGINE_CLASS_H
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <glm/glm.hpp>
+#include "Block.h"
+#include "ChunkLight.h"
+
+class Chunk;
+
+/*NOTE : Flood fill voxel lighting, skylight + block light (emitters like LAVA).
+
+  - Skylight comes straight down at 15 through air / billboards and loses 1 per block
+    sideways (and in water), block light loses 1 per block in every direction.
+  - Adds and removals are plain BFS queues. A removal zeroes everything that was lit
+    by the removed light and hands the cells lit by something else back to the add
+    queue, so an edit costs time proportional to the volume it changes.
+  - The queues live in the chunks (ChunkLight::pendingAdds/Removals). When the BFS
+    crosses a wall the node goes into the neighbour's pending queue and the neighbour
+    gets activated, chunks that aren't loaded just drop it (stitchNewChunk pulls the
+    light back in once they show up).
+
+  Threads : lightNewChunk runs on the streaming thread on a chunk nobody else can see
+  yet and never leaves it. Everything else writes into cached chunks, so it only ever
+  runs on the main thread (World::updateChunks / World::editBlock). The remesh workers
+  read that light at the same time without a lock, ChunkLight publishes its sections
+  atomically so they never see one half built (see the note there).
+*/
+class LightEngine {
+public:
+    // Initial light of a fresh chunk : direct sky columns, emitters, then the flood fill
+    static void lightNewChunk(Chunk& chunk);
+
+    // Exchange light across the walls between a just-linked chunk and its loaded neighbours
+    void stitchNewChunk(Chunk& chunk);
+
+    // Queue the relight for one block change (call propagate() after)
+    void onBlockChanged(Chunk& chunk, const glm::ivec3& localPos, Block::Type oldType, Block::Type newType);
+
+    // Runs every pending queue until the light settles (all removals first, then the adds)
+    void propagate();
+
+    // Chunks whose baked light went stale since the last call, with the sections to remesh
+    void takeDirtyChunks(std::vector<std::pair<Chunk*, uint32_t>>& out);
+
+    size_t getNodesProcessed() const { return nodesProcessed; }
+
+private:
+    bool crossBorders = true; // Off for lightNewChunk
+    bool trackDirty = true;   // Off for lightNewChunk (it gets meshed right after anyway)
+
+    std::vector<Chunk*> active;
+    // Stale baked light is the engine's own business (not a flag in the chunk), another engine
+    // relighting the same chunks can't leave anything behind that this one would trust
+    std::vector<std::pair<Chunk*, uint32_t>> dirty; // Chunk, sections to remesh, in the order they went stale
+    std::unordered_map<Chunk*, size_t> dirtyIndex;  // Chunk -> its entry in dirty
+    std::vector<LightNode> work;
+    size_t nodesProcessed = 0;
+
+    void activate(Chunk& chunk);
+    void markChanged(Chunk& chunk, int x, int y, int z);
+
+    void runRemovals(Chunk& chunk, LightChannel channel);
+    void runAdds(Chunk& chunk, LightChannel channel);
+};
+
+#endif
@@ -10,7 +10,10 @@
 #include <vector>
 using namespace std;
 
-#define MAX_BONE_INFLUENCE 10
+#include <cstdint>
+
+// Influences kept per vertex, the importer keeps the 4 heaviest and renormalizes them (ModelCache)
+#define MAX_BONE_INFLUENCE 4
 
 struct Vertex {
     // position
@@ -23,10 +26,10 @@ struct Vertex {
     glm::vec3 Tangent;
     // bitangent
     glm::vec3 Bitangent;
-    //bone indexes which will influence this vertex
-    int m_BoneIDs[MAX_BONE_INFLUENCE];
-    //weights from each bone
-    float m_Weights[MAX_BONE_INFLUENCE];
+    //bone indexes which will influence this vertex (an unused slot has weight 0)
+    uint8_t m_BoneIDs[MAX_BONE_INFLUENCE];
+    //weights from each bone, unorm16 summing to 65535 (all 0 = not skinned)
+    uint16_t m_Weights[MAX_BONE_INFLUENCE];
 };
 
 struct Texture {
@@ -41,63 +44,97 @@ public:
     vector<Vertex>       vertices;
     vector<unsigned int> indices;
     vector<Texture>      textures;
-    unsigned int VAO;
 
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    unsigned int VAO = 0;
+
+    // constructor, upload = false leaves the GL side to Upload() (meshes built on a loader thread)
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, bool upload = true)
     {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        this->vertices = std::move(vertices);
+        this->indices = std::move(indices);
+        this->textures = std::move(textures);
 
         // After setup of all required data, we init the buffers via setupMesh()
+        if (upload) setupMesh();
+    }
+
+    void Upload()
+    {
         setupMesh();
     }
 
     // render the mesh
     void Draw(Shader& shader)
+    {
+        bindTextures(shader);
+
+        // draw mesh
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // instanceCount copies in one call, the shader tells them apart with gl_InstanceID (BonePaletteBuffer)
+    void DrawInstanced(Shader& shader, GLsizei instanceCount)
+    {
+        bindTextures(shader);
+
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0, instanceCount);
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    // render data 
+    unsigned int VBO, EBO;
+    vector<string> samplerNames; // "texture_diffuse1", ... one per texture, built once in setupMesh
+
+    void bindTextures(Shader& shader)
     {
         // bind appropriate textures
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr = 1;
-        unsigned int heightNr = 1;
-        unsigned int metallicRoughnessNr = 1;
         unsigned int baseTextureUnit = 0;
 
         for (unsigned int i = 0; i < textures.size(); i++)
         {
             glActiveTexture(GL_TEXTURE0 + baseTextureUnit + i); // 0,1,2,3,4
+            shader.SetInt(samplerNames[i].c_str(), baseTextureUnit + i); // Send 0,1,2,3,4
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        }
+    }
+
+    // Sampler uniform of every texture : type + running number per type
+    void setupSamplerNames()
+    {
+        unsigned int diffuseNr = 1;
+        unsigned int specularNr = 1;
+        unsigned int normalNr = 1;
+        unsigned int metallicRoughnessNr = 1;
+        samplerNames.clear();
+        for (const Texture& texture : textures)
+        {
             string number;
-            string name = textures[i].type;
+            const string& name = texture.type;
             if (name == "texture_diffuse")
                 number = std::to_string(diffuseNr++);
             else if (name == "texture_specular")
-                number = std::to_string(specularNr++); 
+                number = std::to_string(specularNr++);
             else if (name == "texture_normal")
-                number = std::to_string(normalNr++); 
-            else if (name == "texture_metallicRoughness")  
+                number = std::to_string(normalNr++);
+            else if (name == "texture_metallicRoughness")
                 number = std::to_string(metallicRoughnessNr++);
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()),
-                baseTextureUnit + i); // Send 0,1,2,3,4
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            samplerNames.push_back(name + number);
         }
-
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glActiveTexture(GL_TEXTURE0);
     }
 
-private:
-    // render data 
-    unsigned int VBO, EBO;
-
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
+        setupSamplerNames();
+
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -129,11 +166,12 @@ private:
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
 
+        // bone ids as uvec4, weights normalized to 0..1 by the fetch
         glEnableVertexAttribArray(5);
-        glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
+        glVertexAttribIPointer(5, MAX_BONE_INFLUENCE, GL_UNSIGNED_BYTE, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
 
         glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
+        glVertexAttribPointer(6, MAX_BONE_INFLUENCE, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
 
     }
 };
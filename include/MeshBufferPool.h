@@ -0,0 +1,60 @@
+#ifndef MESH_BUFFER_POOL_CLASS_H
+#define MESH_BUFFER_POOL_CLASS_H
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "Chunk.h"
+
+/*NOTE : Recycles the vertex/index vectors of chunk meshes.
+
+  Capacities are rounded up to size classes (4 per power of two, so at most 25%
+  slack) and a released buffer goes back to the bucket of its class, the next mesh
+  of about the same size picks it up instead of hitting the allocator.
+
+  Shared by the meshing threads (streaming + remesh workers) and the main thread,
+  which hands the CPU copies back once they are on the GPU.
+*/
+class MeshBufferPool {
+public:
+    struct Stats {
+        size_t hits = 0;        // acquire served from a bucket
+        size_t misses = 0;      // acquire that had to allocate
+        size_t recycled = 0;    // buffers taken back
+        size_t dropped = 0;     // buffers freed (bucket full / not a size class)
+        size_t pooledBytes = 0; // capacity currently sitting in the buckets
+    };
+
+    // Capacity actually handed out for a request of `count` elements
+    static size_t sizeClass(size_t count);
+
+    std::vector<CompactVertex> acquireVertices(size_t count);
+    std::vector<uint32_t> acquireIndices(size_t count);
+
+    void recycle(std::vector<CompactVertex>&& buffer);
+    void recycle(std::vector<uint32_t>&& buffer);
+
+    Stats getStats() const;
+
+private:
+    static const size_t MIN_CLASS = 256;
+    static const size_t MAX_BUFFERS_PER_CLASS = 8;
+
+    template <typename T>
+    using Buckets = std::unordered_map<size_t, std::vector<std::vector<T>>>;
+
+    Buckets<CompactVertex> vertexBuckets;
+    Buckets<uint32_t> indexBuckets;
+    Stats stats;
+    mutable std::mutex poolMutex;
+
+    template <typename T>
+    std::vector<T> acquire(Buckets<T>& buckets, size_t count);
+
+    template <typename T>
+    void giveBack(Buckets<T>& buckets, std::vector<T>&& buffer);
+};
+
+#endif
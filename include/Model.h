@@ -2,16 +2,14 @@
 #define MODEL_H
 
 //#include <glad/glad.h>
+#include "TextureImp.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <stb/stb_image.h>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#include <assimp/pbrmaterial.h>
 
 #include "Mesh.h"
+#include "ModelCache.h"
 
 #include <string>
 #include <fstream>
@@ -19,21 +17,9 @@
 #include <iostream>
 #include <map>
 #include <vector>
-#define MAX_BONE_WEIGHTS 10
 using namespace std;
 
 
-struct BoneInfo
-{
-    /*id is index in finalBoneMatrices*/
-    int id;
-
-    /*offset matrix transforms vertex from model space to bone space*/
-    glm::mat4 offset;
-
-};
-
-
 class Model
 {
 public:
@@ -45,283 +31,101 @@ public:
 
     Model(string const& path, bool gamma = false) : gammaCorrection(gamma)
     {
-        loadModel(path);
+        if (Import(path)) Upload();
     }
 
-    // For all the meshes in the model
-    void Draw(Shader& shader)
+    // Empty model, for Import() on a loader thread then Upload() on the GL one
+    Model(bool gamma = false) : gammaCorrection(gamma)
     {
-        for (unsigned int i = 0; i < meshes.size(); i++)
-            meshes[i].Draw(shader);
     }
-    auto& GetBoneInfoMap() { return m_BoneInfoMap; }
-    int& GetBoneCount() { return m_BoneCounter; }
-private:
-    Assimp::Importer importer;
-    std::map<string, BoneInfo> m_BoneInfoMap; //
-    int m_BoneCounter = 0;
 
-
-
-    void SetVertexBoneDataToDefault(Vertex& vertex)
+    // CPU half : mesh + bone data from ModelCache (imported once per file) and the decoded texture images, no GL call
+    bool Import(string const& path)
     {
-        for (int i = 0; i < MAX_BONE_WEIGHTS; i++)
-        {
-            vertex.m_BoneIDs[i] = -1;
-            vertex.m_Weights[i] = 0.0f;
-        }
-    }
-
-
+        shared_ptr<const ModelData> data = ModelCache::Get(path);
+        if (!data) return false;
+        directory = data->directory;
+        m_BoneInfoMap = data->boneInfoMap;
+        m_BoneCounter = data->boneCount;
 
-    void SetVertexBoneData(Vertex& vertex, int boneID, float weight)
-    {
-        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        for (const ModelData::MeshData& mesh : data->meshes)
         {
-            if (vertex.m_Weights[i] == 0.0f)
-            {
-                vertex.m_BoneIDs[i] = boneID;
-                vertex.m_Weights[i] = weight;
-                return;
-            }
+            vector<Texture> textures;
+            for (const ModelData::TextureRef& ref : mesh.textures)
+                textures.push_back(loadTexture(ref));
+            meshes.push_back(Mesh(mesh.vertices, mesh.indices, textures, false));
         }
-
-        std::cerr << "[ERROR] Too many bone influences on a vertex. Max allowed: " << MAX_BONE_INFLUENCE << std::endl;
+        return true;
     }
 
-
-    void ExtractBoneWeightForVertices(std::vector<Vertex>& vertices, aiMesh* mesh, const aiScene* scene)
+    // GL half : textures + mesh buffers from what Import() left
+    void Upload()
     {
-        if (mesh->mNumBones == 0)
+        vector<unsigned int> textureIDs;
+        for (const TextureImp::ImageData& image : pendingImages)
         {
-            std::cerr << "Warning: Mesh has no bones. Skipping bone extraction." << std::endl;
-            return;
+            textureIDs.push_back(TextureImp::createTexture(image));
+            std::cout << "Texture loaded | ID : " << textureIDs.back() << "\n";
+            std::cout << "Texture loaded | Path : " << image.path << "\n";
         }
-
-        for (unsigned int boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex)
+        // Texture ids were indices in pendingImages until now
+        for (Texture& texture : textures_loaded)
+            texture.id = textureIDs[texture.id];
+        for (Mesh& mesh : meshes)
         {
-            int boneID = -1;
-            std::string boneName = mesh->mBones[boneIndex]->mName.C_Str();
-            if (m_BoneInfoMap.find(boneName) == m_BoneInfoMap.end())
-            {
-                BoneInfo newBoneInfo;
-                newBoneInfo.id = m_BoneCounter;
-                newBoneInfo.offset = AssimpGLMHelpers::ConvertMatrixToGLMFormat(
-                    mesh->mBones[boneIndex]->mOffsetMatrix);
-                m_BoneInfoMap[boneName] = newBoneInfo;
-                boneID = m_BoneCounter;
-                m_BoneCounter++;
-            }
-            else
-            {
-                boneID = m_BoneInfoMap[boneName].id;
-            }
-            assert(boneID != -1);
-            auto weights = mesh->mBones[boneIndex]->mWeights;
-            int numWeights = mesh->mBones[boneIndex]->mNumWeights;
-
-            for (int weightIndex = 0; weightIndex < numWeights; ++weightIndex)
-            {
-                int vertexId = weights[weightIndex].mVertexId;
-                float weight = weights[weightIndex].mWeight;
-                if (vertexId >= vertices.size())
-                {
-                    std::cerr << "Error: vertexId " << vertexId << " is out of bounds for vertices vector of size " << vertices.size() << std::endl;
-                    continue;
-                }
-                if (vertexId < 0)
-                {
-                    std::cerr << "Error: vertexId " << vertexId << " is negative." << std::endl;
-                    continue;
-                }
-                SetVertexBoneData(vertices[vertexId], boneID, weight);
-            }
+            for (Texture& texture : mesh.textures)
+                texture.id = textureIDs[texture.id];
+            mesh.Upload();
         }
+        pendingImages.clear();
     }
-    void loadModel(string const& path)
-    {
 
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-        // check for errors
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
-        {
-            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-            return;
-        }
-        directory = path.substr(0, path.find_last_of('/'));
-
-        // Now work on the root node
-        processNode(scene->mRootNode, scene);
-    }
-
-    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode* node, const aiScene* scene)
+    // For all the meshes in the model
+    void Draw(Shader& shader)
     {
-        // process each mesh located at the current node
-        for (unsigned int i = 0; i < node->mNumMeshes; i++)
-        {
-            // the node object only contains indices to index the actual objects in the scene. 
-            // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
-        }
-        // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-        for (unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
-        }
-
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].Draw(shader);
     }
-
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene)
+    void DrawInstanced(Shader& shader, GLsizei instanceCount)
     {
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
-
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {
-            Vertex vertex;
-            SetVertexBoneDataToDefault(vertex);
-            vertex.Position = AssimpGLMHelpers::GetGLMVec(mesh->mVertices[i]);
-            vertex.Normal = AssimpGLMHelpers::GetGLMVec(mesh->mNormals[i]);
-
-            if (mesh->mTextureCoords[0])
-            {
-                glm::vec2 vec;
-                vec.x = mesh->mTextureCoords[0][i].x;
-                vec.y = mesh->mTextureCoords[0][i].y;
-                vertex.TexCoords = vec;
-            }
-            else
-                vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-            vertices.push_back(vertex);
-        }
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-        {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
-        }
-        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_NORMALS, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-        aiString fileMetallicRoughness;
-        material->GetTexture(AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, &fileMetallicRoughness);
-        if (fileMetallicRoughness.length > 0) {
-            Texture metallicRoughnessTexture;
-            metallicRoughnessTexture.id = TextureFromFile(fileMetallicRoughness.C_Str(), this->directory);
-            metallicRoughnessTexture.type = "texture_metallicRoughness";
-            metallicRoughnessTexture.path = fileMetallicRoughness.C_Str();
-            textures.push_back(metallicRoughnessTexture);
-            textures_loaded.push_back(metallicRoughnessTexture);
-            //std::cout << "Loaded metallic-roughness texture: " << fileMetallicRoughness.C_Str() << std::endl;
-        }
-
-        if (mesh->mNumBones > 0)
-        {
-            ExtractBoneWeightForVertices(vertices, mesh, scene);
-        }
-        else
-        {
-            std::cerr << "Mesh has no bones, skipping bone weight extraction.\n";
-        }
-
-        return Mesh(vertices, indices, textures);
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].DrawInstanced(shader, instanceCount);
     }
+    auto& GetBoneInfoMap() { return m_BoneInfoMap; }
+    int& GetBoneCount() { return m_BoneCounter; }
+private:
+    std::map<string, BoneInfo> m_BoneInfoMap; //
+    int m_BoneCounter = 0;
+    vector<TextureImp::ImageData> pendingImages; // Decoded by Import(), uploaded by Upload()
 
 
 
-    // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
+    // Each file decoded once, meshes sharing it get the same texture
+    Texture loadTexture(const ModelData::TextureRef& ref)
     {
-        vector<Texture> textures;
-        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+        for (const Texture& texture : textures_loaded)
         {
-            aiString str;
-            mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for (unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
-            }
-            if (!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  
-            }
+            if (texture.path == ref.path)
+                return texture;
         }
-        return textures;
+        Texture texture;
+        texture.id = DecodeTexture(ref.path.c_str(), this->directory);
+        texture.type = ref.type;
+        texture.path = ref.path;
+        textures_loaded.push_back(texture);
+        return texture;
     }
 
-    unsigned int TextureFromFile(const char* path, const string& directory,bool crisp = true)
+    // Index of the image in pendingImages, the GL texture comes in Upload()
+    unsigned int DecodeTexture(const char* path, const string& directory)
     {
         string filename = string(path);
         filename = directory + '/' + filename;
 
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-
-        int width, height, nrComponents;
-        stbi_set_flip_vertically_on_load(false);
-        unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-        if (data)
-        {
-            GLenum format;
-            if (nrComponents == 1)
-                format = GL_RED;
-            else if (nrComponents == 3)
-                format = GL_RGB;
-            else if (nrComponents == 4)
-                format = GL_RGBA;
-
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            if (crisp)
-            {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-            }
-            else
-            {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            }
-
-            stbi_image_free(data);
-            std::cout << "Texture loaded | ID : " << textureID << "\n";
-            std::cout << "Texture loaded | Path : " << path << "\n";
-        }
-        else
-        {
+        pendingImages.push_back(TextureImp::decodeImage(filename, false));
+        if (pendingImages.back().pixels.empty())
             std::cout << "Texture failed to load at path: " << path << std::endl;
-            stbi_image_free(data);
-        }
-
-        return textureID;
+        return static_cast<unsigned int>(pendingImages.size() - 1);
     }
 };
     
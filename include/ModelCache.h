@@ -0,0 +1,747 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/pbrmaterial.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AnimationPose.h"
+#include "Bone.h"
+#include "Hash.h"
+#include "Mesh.h"
+
+namespace AssimpGLMHelpers {
+
+
+    inline glm::vec3 GetGLMVec(const aiVector3D& vec)
+    {
+        return glm::vec3(vec.x, vec.y, vec.z);
+    }
+
+    inline glm::quat GetGLMQuat(const aiQuaternion& quat)
+    {
+        return glm::quat(quat.w, quat.x, quat.y, quat.z);
+    }
+
+    inline glm::mat4 ConvertMatrixToGLMFormat(const aiMatrix4x4& from)
+    {
+        glm::mat4 to;
+        to[0][0] = from.a1; to[1][0] = from.a2; to[2][0] = from.a3; to[3][0] = from.a4;
+        to[0][1] = from.b1; to[1][1] = from.b2; to[2][1] = from.b3; to[3][1] = from.b4;
+        to[0][2] = from.c1; to[1][2] = from.c2; to[2][2] = from.c3; to[3][2] = from.c4;
+        to[0][3] = from.d1; to[1][3] = from.d2; to[2][3] = from.d3; to[3][3] = from.d4;
+        return to;
+    }
+
+}
+
+struct BoneInfo
+{
+    /*id is index in finalBoneMatrices*/
+    int id;
+
+    /*offset matrix transforms vertex from model space to bone space*/
+    glm::mat4 offset;
+
+};
+
+struct AssimpNodeData
+{
+    glm::mat4 transformation;
+    std::string name;
+    int childrenCount;
+    std::vector<AssimpNodeData> children;
+};
+
+// Everything Model and Animation need from a file, no Assimp type left in it
+struct ModelData
+{
+    struct TextureRef {
+        std::string type;   // "texture_diffuse", ...
+        std::string path;   // Relative to the model's directory
+    };
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<TextureRef> textures;
+    };
+    struct Channel {
+        std::string name;
+        int boneID;
+        std::vector<KeyPosition> positions;
+        std::vector<KeyRotation> rotations;
+        std::vector<KeyScale> scales;
+    };
+    struct Clip {
+        std::string name;
+        float duration;
+        int ticksPerSecond;
+        std::vector<Channel> channels;
+    };
+
+    std::string directory;
+    std::vector<MeshData> meshes;
+    std::map<std::string, BoneInfo> boneInfoMap; // Skinned bones + every bone a clip animates
+    int boneCount = 0;
+    AssimpNodeData root;
+    std::vector<Clip> clips;
+    std::shared_ptr<const Skeleton> skeleton; // root flattened, built after the import / bake read (not baked)
+};
+
+// Where the models of this run came from (ModelCache::stats)
+struct ModelCacheStats {
+    size_t imported = 0;    // Assimp imports
+    size_t baked = 0;       // Loaded from a baked file
+    size_t shared = 0;      // Get() calls answered by a file already in memory
+    double importMs = 0.0;
+    double bakedMs = 0.0;
+};
+
+/*NOTE : Model + animation files, imported once per path and shared.
+
+  Get() returns the ModelData of a file : the first call imports it, every later one (the
+  model and each of its clips) gets the same object, from any thread. The Assimp scene
+  only lives for the import, everything is copied out into ModelData.
+
+  Imports are baked to bakeFolder (<file name>.mdl), read back with a single read on the
+  next run without touching Assimp. The key is FORMAT_VERSION + the bytes of the file
+  and of the files next to it with the same stem (Steve.gltf + Steve.bin), a stale bake
+  is imported again and overwritten. Bump FORMAT_VERSION when ModelData or Vertex change.
+
+  Skin weights are trimmed at import to the MAX_BONE_INFLUENCE (4) heaviest per vertex,
+  renormalized and stored as uint8 ids + unorm16 weights (Vertex in Mesh.h).
+
+  Baked clips are quantized : rotations as 4 snorm16, positions / scales as 3 unorm16
+  inside the channel's bounds, key times stay floats.
+
+  File : header | nodes (pre-order) | bones | meshes | clips
+*/
+class ModelCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    static inline bool bakeEnabled = true;
+    static inline std::string bakeFolder = "./model_cache/";
+
+    // nullptr when the file can't be imported
+    static std::shared_ptr<const ModelData> Get(const std::string& path) {
+        std::promise<std::shared_ptr<const ModelData>> promise;
+        std::shared_future<std::shared_ptr<const ModelData>> entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            auto it = entries().find(path);
+            if (it != entries().end()) {
+                loadStats().shared++;
+                entry = it->second;
+            }
+            else {
+                entries()[path] = promise.get_future().share();
+            }
+        }
+        if (entry.valid()) return entry.get(); // Waits when another thread is still loading it
+
+        std::shared_ptr<const ModelData> data = Load(path);
+        promise.set_value(data);
+        return data;
+    }
+
+    static ModelCacheStats stats() {
+        std::lock_guard<std::mutex> lock(mutex());
+        return loadStats();
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x4C444D56; // "VMDL"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+    };
+
+    static std::mutex& mutex() { static std::mutex m; return m; }
+    static std::map<std::string, std::shared_future<std::shared_ptr<const ModelData>>>& entries() {
+        static std::map<std::string, std::shared_future<std::shared_ptr<const ModelData>>> e;
+        return e;
+    }
+    static ModelCacheStats& loadStats() { static ModelCacheStats s; return s; }
+
+    static double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::shared_ptr<const ModelData> Load(const std::string& path) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t key = bakeEnabled ? sourceKey(path) : 0;
+        std::string bakedPath = bakeFolder + std::filesystem::path(path).filename().string() + ".mdl";
+
+        auto data = std::make_shared<ModelData>();
+        if (key != 0 && LoadBaked(bakedPath, key, *data)) {
+            double ms = msSince(start);
+            std::lock_guard<std::mutex> lock(mutex());
+            loadStats().baked++;
+            loadStats().bakedMs += ms;
+        }
+        else {
+            data = std::make_shared<ModelData>();
+            if (!Import(path, *data)) return nullptr;
+            double ms = msSince(start);
+            if (key != 0) SaveBaked(bakedPath, key, *data);
+            std::lock_guard<std::mutex> lock(mutex());
+            loadStats().imported++;
+            loadStats().importMs += ms;
+        }
+        data->directory = path.substr(0, path.find_last_of('/'));
+        data->skeleton = BuildSkeleton(*data);
+        return data;
+    }
+
+    // Pre-order walk, so every parent lands before its children
+    static void flattenNode(const ModelData& data, const AssimpNodeData& node, int parent, Skeleton& skeleton) {
+        int index = skeleton.addNode(node.name, parent, node.transformation);
+        auto bone = data.boneInfoMap.find(node.name);
+        if (bone != data.boneInfoMap.end()) {
+            skeleton.boneIndex[index] = bone->second.id;
+            skeleton.offsets[index] = bone->second.offset;
+        }
+        for (const AssimpNodeData& child : node.children) flattenNode(data, child, index, skeleton);
+    }
+
+    static std::shared_ptr<const Skeleton> BuildSkeleton(const ModelData& data) {
+        auto skeleton = std::make_shared<Skeleton>();
+        skeleton->boneCount = data.boneCount;
+        flattenNode(data, data.root, -1, *skeleton);
+        return skeleton;
+    }
+
+    // 0 when the file can't be read (-> no baking)
+    static uint64_t sourceKey(const std::string& path) {
+        std::filesystem::path source(path);
+        std::vector<std::filesystem::path> files{ source };
+        std::error_code error;
+        std::filesystem::path folder = source.has_parent_path() ? source.parent_path() : std::filesystem::path(".");
+        for (const auto& entry : std::filesystem::directory_iterator(folder, error)) {
+            if (entry.path() != source && entry.path().stem() == source.stem()) files.push_back(entry.path());
+        }
+        std::sort(files.begin() + 1, files.end());
+
+        uint64_t hash = fnv1a64(&FORMAT_VERSION, sizeof(FORMAT_VERSION));
+        for (const auto& file : files) {
+            std::vector<char> bytes;
+            if (!readFile(file.string(), bytes)) return 0;
+            uint64_t size = bytes.size();
+            hash = fnv1a64(&size, sizeof(size), hash);
+            hash = fnv1a64(bytes.data(), bytes.size(), hash);
+        }
+        return hash;
+    }
+
+    static bool readFile(const std::string& path, std::vector<char>& bytes) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        bytes.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        return static_cast<bool>(in.read(bytes.data(), bytes.size()));
+    }
+
+    // ---- Assimp import ----
+
+    static bool Import(const std::string& path, ModelData& data) {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        // check for errors
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+        {
+            std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+            return false;
+        }
+
+        processNode(data, scene->mRootNode, scene);
+        ReadHeirarchyData(data.root, scene->mRootNode);
+        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+            data.clips.push_back(ReadClip(data, scene->mAnimations[i]));
+        return true;
+    }
+
+    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+    static void processNode(ModelData& data, aiNode* node, const aiScene* scene)
+    {
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+        {
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+            data.meshes.push_back(processMesh(data, mesh, scene));
+        }
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            processNode(data, node->mChildren[i], scene);
+        }
+    }
+
+    static ModelData::MeshData processMesh(ModelData& data, aiMesh* mesh, const aiScene* scene)
+    {
+        ModelData::MeshData result;
+
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex vertex{}; // No bone, zero weights
+            vertex.Position = AssimpGLMHelpers::GetGLMVec(mesh->mVertices[i]);
+            vertex.Normal = AssimpGLMHelpers::GetGLMVec(mesh->mNormals[i]);
+
+            if (mesh->mTextureCoords[0])
+            {
+                glm::vec2 vec;
+                vec.x = mesh->mTextureCoords[0][i].x;
+                vec.y = mesh->mTextureCoords[0][i].y;
+                vertex.TexCoords = vec;
+            }
+            else
+                vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+
+            result.vertices.push_back(vertex);
+        }
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            aiFace face = mesh->mFaces[i];
+            for (unsigned int j = 0; j < face.mNumIndices; j++)
+                result.indices.push_back(face.mIndices[j]);
+        }
+        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+        readMaterialTextures(result, material, aiTextureType_DIFFUSE, "texture_diffuse");
+        readMaterialTextures(result, material, aiTextureType_SPECULAR, "texture_specular");
+        readMaterialTextures(result, material, aiTextureType_NORMALS, "texture_normal");
+        aiString fileMetallicRoughness;
+        material->GetTexture(AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, &fileMetallicRoughness);
+        if (fileMetallicRoughness.length > 0)
+            result.textures.push_back({ "texture_metallicRoughness", fileMetallicRoughness.C_Str() });
+
+        if (mesh->mNumBones > 0)
+        {
+            ExtractBoneWeightForVertices(data, result.vertices, mesh);
+        }
+        else
+        {
+            std::cerr << "Mesh has no bones, skipping bone weight extraction.\n";
+        }
+        return result;
+    }
+
+    static void readMaterialTextures(ModelData::MeshData& mesh, aiMaterial* mat, aiTextureType type, const std::string& typeName)
+    {
+        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+        {
+            aiString str;
+            mat->GetTexture(type, i, &str);
+            mesh.textures.push_back({ typeName, str.C_Str() });
+        }
+    }
+
+    struct BoneInfluence {
+        int boneID;
+        float weight;
+    };
+
+    // Keeps the MAX_BONE_INFLUENCE heaviest, renormalized, as unorm16 summing to exactly 65535
+    static void SetVertexBoneData(Vertex& vertex, std::vector<BoneInfluence>& influences, float& droppedWeight)
+    {
+        std::sort(influences.begin(), influences.end(),
+            [](const BoneInfluence& a, const BoneInfluence& b) { return a.weight > b.weight; });
+        size_t kept = std::min<size_t>(influences.size(), MAX_BONE_INFLUENCE);
+
+        float total = 0.0f, keptTotal = 0.0f;
+        for (size_t i = 0; i < influences.size(); i++) {
+            total += influences[i].weight;
+            if (i < kept) keptTotal += influences[i].weight;
+        }
+        droppedWeight = total > 0.0f ? (total - keptTotal) / total : 0.0f;
+        if (keptTotal <= 0.0f) return; // Not skinned, bind pose in model.vert
+
+        int sum = 0;
+        for (size_t i = 0; i < kept; i++) {
+            vertex.m_BoneIDs[i] = static_cast<uint8_t>(influences[i].boneID);
+            vertex.m_Weights[i] = static_cast<uint16_t>(std::lround(influences[i].weight / keptTotal * 65535.0f));
+            sum += vertex.m_Weights[i];
+        }
+        // Rounding leftovers go on the heaviest one
+        vertex.m_Weights[0] = static_cast<uint16_t>(vertex.m_Weights[0] + (65535 - sum));
+    }
+
+    static void ExtractBoneWeightForVertices(ModelData& data, std::vector<Vertex>& vertices, aiMesh* mesh)
+    {
+        // Every influence first, a vertex can have more than MAX_BONE_INFLUENCE in the file
+        std::vector<std::vector<BoneInfluence>> influences(vertices.size());
+        for (unsigned int boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex)
+        {
+            int boneID = -1;
+            std::string boneName = mesh->mBones[boneIndex]->mName.C_Str();
+            if (data.boneInfoMap.find(boneName) == data.boneInfoMap.end())
+            {
+                BoneInfo newBoneInfo;
+                newBoneInfo.id = data.boneCount;
+                newBoneInfo.offset = AssimpGLMHelpers::ConvertMatrixToGLMFormat(
+                    mesh->mBones[boneIndex]->mOffsetMatrix);
+                data.boneInfoMap[boneName] = newBoneInfo;
+                boneID = data.boneCount;
+                data.boneCount++;
+            }
+            else
+            {
+                boneID = data.boneInfoMap[boneName].id;
+            }
+            assert(boneID != -1);
+            if (boneID > UINT8_MAX)
+            {
+                std::cerr << "Error: bone " << boneName << " has id " << boneID << ", vertices only store ids up to " << UINT8_MAX << std::endl;
+                continue;
+            }
+            auto weights = mesh->mBones[boneIndex]->mWeights;
+            unsigned int numWeights = mesh->mBones[boneIndex]->mNumWeights;
+
+            for (unsigned int weightIndex = 0; weightIndex < numWeights; ++weightIndex)
+            {
+                unsigned int vertexId = weights[weightIndex].mVertexId;
+                float weight = weights[weightIndex].mWeight;
+                if (vertexId >= vertices.size())
+                {
+                    std::cerr << "Error: vertexId " << vertexId << " is out of bounds for vertices vector of size " << vertices.size() << std::endl;
+                    continue;
+                }
+                if (weight > 0.0f) influences[vertexId].push_back({ boneID, weight });
+            }
+        }
+
+        size_t trimmed = 0;
+        float maxDropped = 0.0f;
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            float dropped;
+            SetVertexBoneData(vertices[i], influences[i], dropped);
+            if (influences[i].size() > MAX_BONE_INFLUENCE) trimmed++;
+            maxDropped = std::max(maxDropped, dropped);
+        }
+        if (trimmed > 0)
+            std::cout << "Skinning : " << trimmed << " vertices had more than " << MAX_BONE_INFLUENCE
+                << " influences, heaviest dropped share " << maxDropped * 100.0f << "%\n";
+    }
+
+    static void ReadHeirarchyData(AssimpNodeData& dest, const aiNode* src)
+    {
+        assert(src);
+
+        dest.name = src->mName.data;
+        dest.transformation = AssimpGLMHelpers::ConvertMatrixToGLMFormat(src->mTransformation);
+        dest.childrenCount = src->mNumChildren;
+
+        for (unsigned int i = 0; i < src->mNumChildren; i++)
+        {
+            AssimpNodeData newData;
+            ReadHeirarchyData(newData, src->mChildren[i]);
+            dest.children.push_back(newData);
+        }
+    }
+
+    // Bones only animated (not skinned) get an id after the skinned ones, same map for every clip
+    static ModelData::Clip ReadClip(ModelData& data, const aiAnimation* animation)
+    {
+        ModelData::Clip clip;
+        clip.name = animation->mName.C_Str();
+        clip.duration = static_cast<float>(animation->mDuration);
+        clip.ticksPerSecond = static_cast<int>(animation->mTicksPerSecond);
+
+        for (unsigned int i = 0; i < animation->mNumChannels; i++)
+        {
+            const aiNodeAnim* channel = animation->mChannels[i];
+            std::string boneName = channel->mNodeName.data;
+            if (data.boneInfoMap.find(boneName) == data.boneInfoMap.end())
+            {
+                data.boneInfoMap[boneName] = { data.boneCount, glm::mat4(1.0f) }; // Animated, not skinned
+                data.boneCount++;
+            }
+
+            ModelData::Channel result;
+            result.name = boneName;
+            result.boneID = data.boneInfoMap[boneName].id;
+            for (unsigned int k = 0; k < channel->mNumPositionKeys; k++)
+                result.positions.push_back({ AssimpGLMHelpers::GetGLMVec(channel->mPositionKeys[k].mValue), static_cast<float>(channel->mPositionKeys[k].mTime) });
+            for (unsigned int k = 0; k < channel->mNumRotationKeys; k++)
+                result.rotations.push_back({ AssimpGLMHelpers::GetGLMQuat(channel->mRotationKeys[k].mValue), static_cast<float>(channel->mRotationKeys[k].mTime) });
+            for (unsigned int k = 0; k < channel->mNumScalingKeys; k++)
+                result.scales.push_back({ AssimpGLMHelpers::GetGLMVec(channel->mScalingKeys[k].mValue), static_cast<float>(channel->mScalingKeys[k].mTime) });
+            clip.channels.push_back(std::move(result));
+        }
+        return clip;
+    }
+
+    // ---- Baked file ----
+
+    struct Reader {
+        const char* cursor;
+        const char* end;
+
+        template <typename T>
+        bool read(T& value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+        bool read(std::string& text) {
+            uint32_t length;
+            if (!read(length) || static_cast<size_t>(end - cursor) < length) return false;
+            text.assign(cursor, length);
+            cursor += length;
+            return true;
+        }
+        template <typename T>
+        bool readArray(std::vector<T>& values) {
+            uint32_t count;
+            if (!read(count) || static_cast<size_t>(end - cursor) / sizeof(T) < count) return false;
+            values.resize(count);
+            std::memcpy(values.data(), cursor, count * sizeof(T));
+            cursor += count * sizeof(T);
+            return true;
+        }
+    };
+
+    struct Writer {
+        std::vector<char> bytes;
+
+        template <typename T>
+        void write(const T& value) {
+            const char* data = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), data, data + sizeof(T));
+        }
+        void write(const std::string& text) {
+            write(static_cast<uint32_t>(text.size()));
+            bytes.insert(bytes.end(), text.begin(), text.end());
+        }
+        template <typename T>
+        void writeArray(const std::vector<T>& values) {
+            write(static_cast<uint32_t>(values.size()));
+            const char* data = reinterpret_cast<const char*>(values.data());
+            bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+        }
+    };
+
+    // unorm16 inside [min, min + extent], extent 0 for a constant channel
+    static uint16_t quantizeUnorm(float value, float min, float extent) {
+        if (extent <= 0.0f) return 0;
+        float t = std::min(std::max((value - min) / extent, 0.0f), 1.0f);
+        return static_cast<uint16_t>(std::lround(t * 65535.0f));
+    }
+    static float dequantizeUnorm(uint16_t value, float min, float extent) {
+        return min + extent * (value / 65535.0f);
+    }
+    static int16_t quantizeSnorm(float value) {
+        return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+    }
+
+    // Key times, then bounds + 3 unorm16 per key (positions and scales)
+    template <typename Key, glm::vec3 Key::* Value>
+    static void writeVec3Keys(Writer& out, const std::vector<Key>& keys) {
+        std::vector<float> times;
+        glm::vec3 min(0.0f), max(0.0f);
+        for (size_t i = 0; i < keys.size(); i++) {
+            times.push_back(keys[i].timeStamp);
+            min = i == 0 ? keys[i].*Value : glm::min(min, keys[i].*Value);
+            max = i == 0 ? keys[i].*Value : glm::max(max, keys[i].*Value);
+        }
+        glm::vec3 extent = max - min;
+        out.writeArray(times);
+        out.write(min);
+        out.write(extent);
+        for (const Key& key : keys)
+            for (int c = 0; c < 3; c++) out.write(quantizeUnorm((key.*Value)[c], min[c], extent[c]));
+    }
+
+    template <typename Key, glm::vec3 Key::* Value>
+    static bool readVec3Keys(Reader& in, std::vector<Key>& keys) {
+        std::vector<float> times;
+        glm::vec3 min, extent;
+        if (!in.readArray(times) || !in.read(min) || !in.read(extent)) return false;
+        keys.resize(times.size());
+        for (size_t i = 0; i < times.size(); i++) {
+            keys[i].timeStamp = times[i];
+            for (int c = 0; c < 3; c++) {
+                uint16_t value;
+                if (!in.read(value)) return false;
+                (keys[i].*Value)[c] = dequantizeUnorm(value, min[c], extent[c]);
+            }
+        }
+        return true;
+    }
+
+    static void writeRotationKeys(Writer& out, const std::vector<KeyRotation>& keys) {
+        std::vector<float> times;
+        for (const KeyRotation& key : keys) times.push_back(key.timeStamp);
+        out.writeArray(times);
+        for (const KeyRotation& key : keys) {
+            // Sign kept as it is, flipping it would change the slerp between two keys
+            glm::quat q = glm::normalize(key.orientation);
+            out.write(quantizeSnorm(q.x));
+            out.write(quantizeSnorm(q.y));
+            out.write(quantizeSnorm(q.z));
+            out.write(quantizeSnorm(q.w));
+        }
+    }
+
+    static bool readRotationKeys(Reader& in, std::vector<KeyRotation>& keys) {
+        std::vector<float> times;
+        if (!in.readArray(times)) return false;
+        keys.resize(times.size());
+        for (size_t i = 0; i < times.size(); i++) {
+            int16_t q[4];
+            if (!in.read(q)) return false;
+            keys[i].timeStamp = times[i];
+            keys[i].orientation = glm::normalize(glm::quat(q[3] / 32767.0f, q[0] / 32767.0f, q[1] / 32767.0f, q[2] / 32767.0f));
+        }
+        return true;
+    }
+
+    static void writeNode(Writer& out, const AssimpNodeData& node) {
+        out.write(node.name);
+        out.write(node.transformation);
+        out.write(static_cast<uint32_t>(node.children.size()));
+        for (const AssimpNodeData& child : node.children) writeNode(out, child);
+    }
+
+    static bool readNode(Reader& in, AssimpNodeData& node, int depth = 0) {
+        uint32_t children;
+        if (depth > 256 || !in.read(node.name) || !in.read(node.transformation) || !in.read(children)) return false;
+        node.childrenCount = static_cast<int>(children);
+        node.children.resize(children);
+        for (AssimpNodeData& child : node.children)
+            if (!readNode(in, child, depth + 1)) return false;
+        return true;
+    }
+
+    static bool SaveBaked(const std::string& path, uint64_t key, const ModelData& data) {
+        Writer out;
+        out.write(Header{ MAGIC, FORMAT_VERSION, key });
+        writeNode(out, data.root);
+
+        out.write(static_cast<int32_t>(data.boneCount));
+        out.write(static_cast<uint32_t>(data.boneInfoMap.size()));
+        for (const auto& [name, info] : data.boneInfoMap) {
+            out.write(name);
+            out.write(info.id);
+            out.write(info.offset);
+        }
+
+        out.write(static_cast<uint32_t>(data.meshes.size()));
+        for (const ModelData::MeshData& mesh : data.meshes) {
+            out.writeArray(mesh.vertices);
+            out.writeArray(mesh.indices);
+            out.write(static_cast<uint32_t>(mesh.textures.size()));
+            for (const ModelData::TextureRef& texture : mesh.textures) {
+                out.write(texture.type);
+                out.write(texture.path);
+            }
+        }
+
+        out.write(static_cast<uint32_t>(data.clips.size()));
+        for (const ModelData::Clip& clip : data.clips) {
+            out.write(clip.name);
+            out.write(clip.duration);
+            out.write(static_cast<int32_t>(clip.ticksPerSecond));
+            out.write(static_cast<uint32_t>(clip.channels.size()));
+            for (const ModelData::Channel& channel : clip.channels) {
+                out.write(channel.name);
+                out.write(static_cast<int32_t>(channel.boneID));
+                writeVec3Keys<KeyPosition, &KeyPosition::position>(out, channel.positions);
+                writeRotationKeys(out, channel.rotations);
+                writeVec3Keys<KeyScale, &KeyScale::scale>(out, channel.scales);
+            }
+        }
+
+        std::filesystem::path filePath(path);
+        std::error_code error;
+        if (filePath.has_parent_path()) std::filesystem::create_directories(filePath.parent_path(), error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.bytes.data(), out.bytes.size())) {
+            std::cerr << "Model cache : could not write " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    static bool LoadBaked(const std::string& path, uint64_t key, ModelData& data) {
+        std::vector<char> bytes;
+        if (!readFile(path, bytes)) return false;
+        Reader in{ bytes.data(), bytes.data() + bytes.size() };
+
+        Header header;
+        if (!in.read(header) || header.magic != MAGIC || header.version != FORMAT_VERSION || header.key != key) return false;
+
+        bool ok = readNode(in, data.root);
+
+        int32_t boneCount = 0;
+        uint32_t bones = 0;
+        ok = ok && in.read(boneCount) && in.read(bones);
+        data.boneCount = boneCount;
+        for (uint32_t i = 0; i < bones && ok; i++) {
+            std::string name;
+            BoneInfo info;
+            ok = in.read(name) && in.read(info.id) && in.read(info.offset);
+            data.boneInfoMap[name] = info;
+        }
+
+        uint32_t meshes = 0;
+        ok = ok && in.read(meshes);
+        for (uint32_t i = 0; i < meshes && ok; i++) {
+            ModelData::MeshData mesh;
+            uint32_t textures = 0;
+            ok = in.readArray(mesh.vertices) && in.readArray(mesh.indices) && in.read(textures);
+            for (uint32_t t = 0; t < textures && ok; t++) {
+                ModelData::TextureRef texture;
+                ok = in.read(texture.type) && in.read(texture.path);
+                mesh.textures.push_back(texture);
+            }
+            data.meshes.push_back(std::move(mesh));
+        }
+
+        uint32_t clips = 0;
+        ok = ok && in.read(clips);
+        for (uint32_t i = 0; i < clips && ok; i++) {
+            ModelData::Clip clip;
+            int32_t ticksPerSecond = 0;
+            uint32_t channels = 0;
+            ok = in.read(clip.name) && in.read(clip.duration) && in.read(ticksPerSecond) && in.read(channels);
+            clip.ticksPerSecond = ticksPerSecond;
+            for (uint32_t c = 0; c < channels && ok; c++) {
+                ModelData::Channel channel;
+                int32_t boneID = 0;
+                ok = in.read(channel.name) && in.read(boneID)
+                    && readVec3Keys<KeyPosition, &KeyPosition::position>(in, channel.positions)
+                    && readRotationKeys(in, channel.rotations)
+                    && readVec3Keys<KeyScale, &KeyScale::scale>(in, channel.scales);
+                channel.boneID = boneID;
+                clip.channels.push_back(std::move(channel));
+            }
+            data.clips.push_back(std::move(clip));
+        }
+
+        if (!ok) {
+            std::cerr << "Model cache : " << path << " is truncated, importing again\n";
+            data = ModelData();
+        }
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef OCCLUSION_BUFFER_CLASS_H
+#define OCCLUSION_BUFFER_CLASS_H
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/*NOTE : Small CPU depth buffer for occlusion culling (software rasterizer).
+
+  Each frame :
+    1) beginFrame(viewProjection, cameraPosition) clears the depth to far
+    2) addOccluder(min, max) for boxes that are solid all the way through (buried
+       terrain, see OccluderColumns / MeshRange::opaque). Only the faces towards the
+       camera get rasterized, boxes crossing the near plane are skipped
+    3) rasterize(threads) draws them, the screen is cut in horizontal bands and every
+       thread owns one band (no sharing, no locks). The inner loop does 4 pixels at
+       a time with SSE
+    4) buildHiZ() builds the max depth mips, isVisible(min, max) tests a box against
+       the mip where its screen rect is a few texels wide
+
+  Depth is NDC z mapped to [0, 1] (linear in screen space, so it interpolates straight).
+  Pixels are sampled at their centre like the GPU does, so an occluder only counts
+  where it covers pixel centres. Everything else errs on the visible side.
+*/
+class OcclusionBuffer {
+public:
+    // width is rounded up to a multiple of 4 (SSE rows)
+    explicit OcclusionBuffer(int width = 256, int height = 144);
+
+    void beginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+    void addOccluder(const glm::vec3& min, const glm::vec3& max);
+    void rasterize(int threadCount = 1);
+    void buildHiZ();
+
+    // False only if the whole box is behind what was rasterized
+    bool isVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getTriangleCount() const { return triangles.size(); }
+    // Level 0 = full resolution, row 0 is the bottom of the screen
+    const std::vector<float>& getDepth(int level = 0) const { return mips[level].depth; }
+
+private:
+    struct Triangle {
+        glm::vec2 v[3];       // Screen position in pixels, counter-clockwise
+        float z0, dzdx, dzdy; // Depth plane : z0 at v[0]
+        int minY, maxY;       // Pixel rows touched
+    };
+
+    struct Mip {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    int width;
+    int height;
+    glm::mat4 viewProjection{ 1.0f };
+    glm::vec3 cameraPosition{ 0.0f };
+    std::vector<Triangle> triangles;
+    std::vector<Mip> mips;
+
+    void addQuad(const glm::vec4 clip[8], int a, int b, int c, int d);
+    void addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+    void rasterizeBand(int rowBegin, int rowEnd);
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef RANGE_ALLOCATOR_CLASS_H
+#define RANGE_ALLOCATOR_CLASS_H
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+/*NOTE : Free-list sub-allocator over one big arena (offsets / sizes in elements, not bytes).
+
+  The renderer keeps every chunk mesh inside one vertex buffer and one index buffer and
+  hands out ranges of them with this. Best fit (smallest free block that fits, lowest
+  offset on ties), freed blocks merge with their free neighbours right away, so the only
+  fragmentation left is holes between live ranges. Sizes are rounded up to the alignment
+  to keep tiny leftovers out of the free list.
+
+  No GL in here, the GL side grows the arena (grow()) and copies the old buffer over when
+  an allocation fails.
+*/
+class RangeAllocator {
+public:
+    static constexpr uint32_t INVALID_OFFSET = UINT32_MAX;
+
+    struct Range {
+        uint32_t offset = INVALID_OFFSET;
+        uint32_t size = 0;
+
+        bool valid() const { return offset != INVALID_OFFSET; }
+    };
+
+    struct Stats {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t failures = 0; // No free block was big enough
+        uint32_t used = 0;
+        uint32_t freeBlocks = 0;
+        uint32_t largestFreeBlock = 0;
+    };
+
+    explicit RangeAllocator(uint32_t capacity = 0, uint32_t alignment = 1);
+
+    // Invalid range if no free block is big enough (grow() and try again)
+    Range allocate(uint32_t size);
+    void free(Range& range);
+
+    // Makes the arena bigger, the new tail joins the free list
+    void grow(uint32_t newCapacity);
+    void reset(uint32_t capacity);
+
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsed() const { return used; }
+    uint32_t getLargestFreeBlock() const;
+    // 0 = all the free space is one block, -> 1 = free space scattered in small holes
+    double getFragmentation() const;
+    Stats getStats() const;
+
+private:
+    uint32_t capacity = 0;
+    uint32_t alignment = 1;
+    uint32_t used = 0;
+    Stats stats;
+
+    std::map<uint32_t, uint32_t> freeByOffset;    // offset -> size
+    std::set<std::pair<uint32_t, uint32_t>> freeBySize; // (size, offset)
+
+    void insertFree(uint32_t offset, uint32_t size);
+    void eraseFree(std::map<uint32_t, uint32_t>::iterator block);
+};
+
+#endif
@@ -25,6 +25,10 @@
     3) setup_HDRI();
     4) setup_prefilter_map();
     5) init_BRDF_lut();
+
+    3) to 5) (and the HDRI load) only run when IBLCache has no maps for this HDRI + shaders,
+    see main.cpp. The diffuse part isn't a cubemap anymore, it's IrradianceSH (CPU, from the
+    HDRI pixels) in the SkyIrradiance uniform block
 */
 
 struct Element {
@@ -69,7 +73,6 @@ private:
     unsigned int hdrTexture = 0;
     unsigned int cubeFBO;
     unsigned int envCubeMap;
-    unsigned int irradianceMap;
     unsigned int prefilterMap;
     unsigned int brdfLUTTexture;
 
@@ -87,7 +90,6 @@ private:
 
     Shader HDRIShader;
     Shader SkyBoxShader;
-    Shader irradianceShader;
     Shader main;
     Shader prefilterShader;
     Shader brdfShader;
@@ -359,7 +361,7 @@ private:
 
         }
 
-        void setup_HDRI(unsigned int* cubeFBO, unsigned int* envCubeMap, unsigned int* hdrTexture, unsigned int* irradianceMap, Shader HDRIShader, Shader irradianceShader) {
+        void setup_HDRI(unsigned int* cubeFBO, unsigned int* envCubeMap, unsigned int* hdrTexture, Shader& HDRIShader) {
             //HDRI framebuffer
             glGenFramebuffers(1, cubeFBO);
             glBindFramebuffer(GL_FRAMEBUFFER, *cubeFBO);
@@ -392,40 +394,9 @@ private:
             }
 
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-            
-            //Texture for the convoluted irradiance map
-            glGenTextures(1, irradianceMap);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, *irradianceMap);
-            for (unsigned int i = 0; i < 6; ++i) {
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
-            }
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, *cubeFBO);
-
-            //Creating an irradiance map
-            irradianceShader.Use();
-            irradianceShader.SetInt("environmentMap", 0);
-            irradianceShader.SetUniformMatrix4fv("projection", glm::value_ptr(captureProjection));
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, *envCubeMap);
-            glViewport(0, 0, 32, 32);
-            for (unsigned int i = 0; i < 6; ++i) {
-                irradianceShader.SetUniformMatrix4fv("view", glm::value_ptr(captureViews[i]));
-                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                    GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, *irradianceMap, 0);
-                glClear(GL_COLOR_BUFFER_BIT); 
-                renderCube();
-            }
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
 
-        void setup_prefilter_map(unsigned int* prefilterMap, Shader prefilterShader, unsigned int* envCubeMap, unsigned int* cubeFBO, int maxMipLevels = 5) {
+        void setup_prefilter_map(unsigned int* prefilterMap, Shader& prefilterShader, unsigned int* envCubeMap, unsigned int* cubeFBO, int maxMipLevels = 5) {
 
             glGenTextures(1, prefilterMap);
             glBindTexture(GL_TEXTURE_CUBE_MAP, *prefilterMap);
@@ -468,7 +439,7 @@ private:
         }
 
 
-        void init_BRDF_lut(unsigned int* brdfLUTTexture, unsigned int* cubeFBO, unsigned int* rboDepth, Shader brdfShader) {
+        void init_BRDF_lut(unsigned int* brdfLUTTexture, unsigned int* cubeFBO, unsigned int* rboDepth, Shader& brdfShader) {
             // ===== BRDF LUT SETUP =====
             glGenTextures(1, brdfLUTTexture);
             glBindTexture(GL_TEXTURE_2D, *brdfLUTTexture);
@@ -0,0 +1,37 @@
+#ifndef SECTION_VISIBILITY_CLASS_H
+#define SECTION_VISIBILITY_CLASS_H
+#pragma once
+
+#include <cstdint>
+
+class Chunk;
+
+/*NOTE : Which faces of a 16^3 section can see each other through the section.
+
+  Flood fill over the cells you can see through (air, water, billboards, leaves), every
+  region remembers the section faces it touches and each pair of those faces gets
+  connected. 6 faces -> 15 pairs -> 15 bits, computed by the mesher next to the
+  section mesh (MeshRange::visibility) so it's always as fresh as what's drawn.
+
+  Faces use the chunk neighbour order (0 North +Z, 1 South -Z, 2 East +X, 3 West -X)
+  plus 4 Up +Y, 5 Down -Y.
+*/
+class SectionVisibility {
+public:
+    static constexpr int FACE_COUNT = 6;
+    static constexpr uint16_t ALL_CONNECTED = 0x7FFF;
+    static constexpr uint16_t NONE_CONNECTED = 0;
+
+    // Connectivity mask of one section of the chunk (reads the blocks, caller holds the data lock).
+    // fullyOpaque = no see-through cell at all (the section can be an occluder)
+    static uint16_t compute(const Chunk& chunk, int section, bool* fullyOpaque = nullptr);
+
+    static bool connected(uint16_t mask, int faceA, int faceB);
+
+    static int opposite(int face) { return face ^ 1; }
+
+private:
+    static int pairBit(int faceA, int faceB);
+};
+
+#endif
@@ -2,15 +2,74 @@
 #define SHADER_CLASS_MAIN
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+#include "Hash.h"
 
+// Uniform block binding of FrameData (world / water / model shaders)
+const GLuint FRAME_UNIFORMS_BINDING = 0;
+
+// CPU copy of the FrameData block, std140 : vec3 + float share one 16 byte slot
+struct FrameUniforms {
+    glm::mat4 view{ 1.0f };
+    glm::mat4 projection{ 1.0f };
+    glm::vec3 camPos{ 0.0f };
+    float time = 0.0f;
+    glm::vec3 lightDir{ 0.0f };
+    float padding0 = 0.0f;
+    glm::vec3 lightColor{ 1.0f };
+    float padding1 = 0.0f;
+};
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 FrameData block");
+
+// Uniform block binding of SkyIrradiance (world / model shaders)
+const GLuint SKY_IRRADIANCE_BINDING = 1;
+
+// CPU copy of the SkyIrradiance block, the 9 SH coefficients of IrradianceSH (std140 pads vec3 array elements to vec4)
+struct SkyIrradianceUniforms {
+    glm::vec4 coefficients[9] = {};
+};
+static_assert(sizeof(SkyIrradianceUniforms) == 144, "SkyIrradianceUniforms must match the std140 SkyIrradiance block");
+
+// Startup cost of the programs made so far (Shader::loadStats)
+struct ShaderLoadStats {
+    size_t compiled = 0;    // Programs built from source
+    size_t fromBinary = 0;  // Programs loaded from the binary cache
+    double compileMs = 0.0;
+    double binaryLoadMs = 0.0;
+    double savedMs = 0.0;   // Compile time of the cached programs back when they were built, minus their load time
+};
+
+/*NOTE : A linked vertex + fragment program.
+
+  Linked programs are kept on disk (glGetProgramBinary) in binaryCacheFolder, one file per
+  program named after a hash of both sources + the GL vendor / renderer / version strings,
+  so an edited shader or a new driver just means a new file. A file that's missing, damaged
+  or refused by the driver falls back to compiling, and the fresh binary replaces it.
+  Each file keeps how long its compile + link took, that's where ShaderLoadStats::savedMs comes from.
+*/
 class Shader {
  public:
     GLuint ID; 
 
+    // Uniform calls (glUniform* + UBO updates) since the last reset, counted per frame in main
+    static inline size_t uniformCalls = 0;
+
+    // Program binary cache, set before the first Shader is made
+    static inline bool binaryCacheEnabled = true;
+    static inline std::string binaryCacheFolder = "./shader_cache/";
+
+    static inline ShaderLoadStats loadStats;
+
     void CheckCompileErrors(GLuint shader, std::string type) {
         GLint success;
         GLchar infoLog[1024];
@@ -61,6 +120,94 @@ public:
         catch (std::ifstream::failure& e) {
             std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n";
         }
+
+        // Linked binary from an earlier run if there is one, the sources otherwise
+        auto start = std::chrono::steady_clock::now();
+        uint64_t key = binaryCacheSupported() ? binaryKey(vertexCode, fragmentCode) : 0;
+        float builtMs = 0.0f;
+        if (key != 0 && loadBinary(key, builtMs)) {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            loadStats.fromBinary++;
+            loadStats.binaryLoadMs += ms;
+            loadStats.savedMs += builtMs - ms;
+        }
+        else {
+            compile(vertexCode, fragmentCode, key != 0);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            loadStats.compiled++;
+            loadStats.compileMs += ms;
+            if (key != 0) saveBinary(key, static_cast<float>(ms));
+        }
+
+        reflectUniforms();
+    }
+
+    // Location cached at link time, -1 for names the program doesn't use (glUniform ignores those)
+    GLint GetUniformLocation(const std::string& name) const {
+        auto it = uniformLocations.find(name);
+        return it != uniformLocations.end() ? it->second : -1;
+    }
+
+    // Util methods to set uniforms directly //
+    void SetInt(const char* name, int value) {
+        glUniform1i(GetUniformLocation(name), value);
+        uniformCalls++;
+    }
+    void Use() const {
+        glUseProgram(ID);
+    }
+
+    void SetUniform1f(const std::string& name, float value) const {
+        glUniform1f(GetUniformLocation(name), value);
+        uniformCalls++;
+    }
+
+    void SetUniform1i(const std::string& name, int value) const {
+        glUniform1i(GetUniformLocation(name), value);
+        uniformCalls++;
+    }
+
+    void SetUniform3f(const std::string& name, float x, float y, float z) const {
+        glUniform3f(GetUniformLocation(name), x, y, z);
+        uniformCalls++;
+    }
+
+    void SetUniformMatrix4fv(const std::string& name, const GLfloat* matrix) const {
+        glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, matrix);
+        uniformCalls++;
+    }
+
+    // Whole array in one call ("finalBonesMatrices" -> elements 0 .. count-1)
+    void SetUniformMatrix4fvArray(const std::string& name, const GLfloat* matrices, GLsizei count) const {
+        glUniformMatrix4fv(GetUniformLocation(name), count, GL_FALSE, matrices);
+        uniformCalls++;
+    }
+
+    void SetUniform3fv(const std::string& name, const float* value) {
+        glUniform3fv(GetUniformLocation(name), 1, value);
+        uniformCalls++;
+    }
+
+
+    ~Shader() {
+        glDeleteProgram(ID);
+    }
+
+private:
+    static constexpr uint32_t BINARY_MAGIC = 0x42505247; // "GRPB"
+    static constexpr uint32_t BINARY_VERSION = 1;
+
+    struct BinaryHeader {
+        uint32_t magic;
+        GLenum format;
+        uint64_t key;
+        uint32_t length;
+        float builtMs; // Compile + link time when the binary was made
+    };
+
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    void compile(const std::string& vertexCode, const std::string& fragmentCode, bool retrievable) {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
 
@@ -77,6 +224,7 @@ public:
         CheckCompileErrors(fragment, "FRAGMENT");
 
         ID = glCreateProgram();
+        if (retrievable) glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
@@ -86,38 +234,133 @@ public:
         glDeleteShader(fragment);
     }
 
-    // Util methods to set uniforms directly //
-    void SetInt(const char* name, int value) {
-        glUniform1i(glGetUniformLocation(ID, name), value);
+    // glGetProgramBinary is core in 4.1, ARB_get_program_binary brings it to our 3.3 context on most drivers
+    static bool binaryCacheSupported() {
+        if (!binaryCacheEnabled || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
     }
-    void Use() const {
-        glUseProgram(ID);
+
+    static uint64_t binaryKey(const std::string& vertexCode, const std::string& fragmentCode) {
+        uint64_t hash = fnv1a64(&BINARY_VERSION, sizeof(BINARY_VERSION));
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* value = glGetString(name);
+            if (value) hash = fnv1a64(std::string(reinterpret_cast<const char*>(value)), hash);
+        }
+        uint64_t vertexSize = vertexCode.size(); // Keeps "ab" + "c" apart from "a" + "bc"
+        hash = fnv1a64(&vertexSize, sizeof(vertexSize), hash);
+        hash = fnv1a64(vertexCode, hash);
+        return fnv1a64(fragmentCode, hash);
     }
 
-    void SetUniform1f(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    static std::string binaryPath(uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(binaryCacheFolder) / name).string();
     }
 
-    void SetUniform1i(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    bool loadBinary(uint64_t key, float& builtMs) {
+        std::ifstream in(binaryPath(key), std::ios::binary);
+        if (!in) return false;
+        BinaryHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != BINARY_MAGIC || header.key != key)
+            return false;
+        std::vector<char> binary(header.length);
+        if (!in.read(binary.data(), binary.size())) return false;
+
+        ID = glCreateProgram();
+        glProgramBinary(ID, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            // The driver can refuse a binary it made itself (update, other GPU), compile() writes a new one
+            glDeleteProgram(ID);
+            ID = 0;
+            return false;
+        }
+        builtMs = header.builtMs;
+        return true;
     }
 
-    void SetUniform3f(const std::string& name, float x, float y, float z) const {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    void saveBinary(uint64_t key, float builtMs) const {
+        GLint linked = GL_FALSE, length = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+        glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (!linked || length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(ID, length, nullptr, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(binaryCacheFolder, error);
+        std::ofstream out(binaryPath(key), std::ios::binary | std::ios::trunc);
+        BinaryHeader header{ BINARY_MAGIC, format, key, static_cast<uint32_t>(length), builtMs };
+        if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header)) || !out.write(binary.data(), binary.size()))
+            std::cerr << "Shader : could not write the program binary to " << binaryCacheFolder << "\n";
     }
 
-    void SetUniformMatrix4fv(const std::string& name, const GLfloat* matrix) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, matrix);
+    // Every active uniform once, right after the link. Arrays come back as "name[0]", they are
+    // stored under "name" too (element 0, the array setters start there)
+    void reflectUniforms() {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(std::max(maxLength, 1), '\0');
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, &name[0]);
+            std::string uniformName(name.data(), length);
+            GLint location = glGetUniformLocation(ID, uniformName.c_str());
+            if (location < 0) continue; // Lives in a uniform block
+
+            uniformLocations[uniformName] = location;
+            size_t bracket = uniformName.find("[0]");
+            if (bracket != std::string::npos && bracket + 3 == uniformName.size()) {
+                uniformLocations[uniformName.substr(0, bracket)] = location;
+            }
+        }
+
+        GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameData");
+        if (frameBlock != GL_INVALID_INDEX) glUniformBlockBinding(ID, frameBlock, FRAME_UNIFORMS_BINDING);
+        GLuint skyBlock = glGetUniformBlockIndex(ID, "SkyIrradiance");
+        if (skyBlock != GL_INVALID_INDEX) glUniformBlockBinding(ID, skyBlock, SKY_IRRADIANCE_BINDING);
     }
+};
 
-    void SetUniform3fv(const std::string& name, const float* value) {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, value);
+// A uniform buffer bound to its block binding point, every program with that block reads it.
+// FrameData is written once per frame, SkyIrradiance once after the IBL setup
+template <typename T, GLuint Binding>
+class UniformBuffer {
+public:
+    void Create() {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, Binding, ID);
     }
 
+    void Update(const T& data) {
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        Shader::uniformCalls++;
+    }
 
-    ~Shader() {
-        glDeleteProgram(ID);
+    void Delete() {
+        glDeleteBuffers(1, &ID);
+        ID = 0;
     }
+
+private:
+    GLuint ID = 0;
 };
 
+using FrameUniformBuffer = UniformBuffer<FrameUniforms, FRAME_UNIFORMS_BINDING>;
+using SkyIrradianceBuffer = UniformBuffer<SkyIrradianceUniforms, SKY_IRRADIANCE_BINDING>;
+
 #endif
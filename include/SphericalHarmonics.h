@@ -0,0 +1,30 @@
+#ifndef SPHERICAL_HARMONICS_CLASS_H
+#define SPHERICAL_HARMONICS_CLASS_H
+#pragma once
+
+#include <glm/glm.hpp>
+
+/*NOTE : Diffuse sky light as order 2 spherical harmonics (9 RGB coefficients).
+
+  fromEquirect() projects an equirectangular HDR (rows bottom to top, the way loadHDR
+  uploads it, same mapping as Hdri.frag) on the CPU : rows are split in bands, one
+  thread per band, and every row runs 4 pixels at a time with SSE. Radiance is capped
+  at MAX_RADIANCE before it goes in, like the old irradiance.frag convolution did.
+
+  The stored coefficients already have the basis constants and the cosine lobe folded
+  in, and are divided by PI, so evaluate() (and skyIrradiance() in world.frag /
+  model.frag) gives what the old irradiance cubemap held : irradiance / PI, no more
+  than a dot product with the 9 polynomials of the normal.
+*/
+struct IrradianceSH {
+    static constexpr float MAX_RADIANCE = 100.0f;
+
+    glm::vec3 coefficients[9] = {};
+
+    // rgb = width * height * 3 floats
+    static IrradianceSH fromEquirect(const float* rgb, int width, int height, int threadCount = 1);
+
+    glm::vec3 evaluate(const glm::vec3& normal) const;
+};
+
+#endif
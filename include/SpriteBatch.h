@@ -0,0 +1,168 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include "Shaders.h"
+
+/*NOTE : 2D quads of the frame (HUD textures, text glyphs), drawn in as few calls as possible.
+
+  Queue() only records the quad. Flush() sorts the quads by (layer, shader, texture), writes
+  them in that order into one streaming VBO (orphaned then refilled, so the driver never waits
+  on last frame's draw) and issues one glDrawArrays per run of the same shader + texture.
+  Sorting keeps the order of quads with the same key, use the layer when something has to
+  be drawn over something else.
+
+  The VAO/VBO are made on the first flush and reused every frame after that, the VBO only
+  gets reallocated when a frame queues more quads than ever before.
+
+  Vertex layout (both UIpass and Text shaders) : location 0 = vec4 (x, y, u, v),
+  location 1 = vec4 colour.
+*/
+class SpriteBatch {
+public:
+    struct Stats {
+        size_t quads = 0;   // Last flush
+        size_t draws = 0;
+        size_t bufferResizes = 0; // Since start, 0 per frame in steady state
+    };
+
+    // Screen rect (top left, bottom right) and its UV rect, uvMin goes with the top left corner
+    void Queue(const Shader& shader, GLuint texture, const glm::vec2& min, const glm::vec2& max,
+        const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& color = glm::vec4(1.0f), int layer = 0) {
+        quads.push_back({ SortKey{ layer, shader.ID, texture }, &shader, min, max, uvMin, uvMax, color });
+    }
+
+    void Flush() {
+        if (quads.empty()) {
+            lastStats.quads = 0;
+            lastStats.draws = 0;
+            return;
+        }
+        initialise();
+
+        // 1) Sort by key, same key keeps the queue order
+        order.resize(quads.size());
+        for (size_t i = 0; i < quads.size(); i++) order[i] = static_cast<uint32_t>(i);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return quads[a].key < quads[b].key;
+            });
+
+        // 2) Two triangles per quad, in sorted order
+        vertices.clear();
+        vertices.reserve(quads.size() * 6);
+        for (uint32_t index : order) {
+            const Quad& q = quads[index];
+            Vertex topLeft     = { q.min.x, q.min.y, q.uvMin.x, q.uvMin.y, q.color };
+            Vertex topRight    = { q.max.x, q.min.y, q.uvMax.x, q.uvMin.y, q.color };
+            Vertex bottomLeft  = { q.min.x, q.max.y, q.uvMin.x, q.uvMax.y, q.color };
+            Vertex bottomRight = { q.max.x, q.max.y, q.uvMax.x, q.uvMax.y, q.color };
+            vertices.insert(vertices.end(), { bottomLeft, topLeft, topRight, bottomLeft, topRight, bottomRight });
+        }
+
+        // 3) Orphan + refill, the buffer object itself stays
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        size_t bytes = vertices.size() * sizeof(Vertex);
+        if (bytes > capacity) {
+            capacity = std::max(bytes, capacity * 2);
+            stats.bufferResizes++;
+        }
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // 4) One draw per run of the same shader + texture
+        glActiveTexture(GL_TEXTURE0);
+        size_t draws = 0;
+        size_t runStart = 0;
+        for (size_t i = 1; i <= order.size(); i++) {
+            if (i < order.size() && quads[order[i]].key.sameBatch(quads[order[runStart]].key)) continue;
+
+            const Quad& first = quads[order[runStart]];
+            first.shader->Use();
+            glBindTexture(GL_TEXTURE_2D, first.key.texture);
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(runStart * 6), static_cast<GLsizei>((i - runStart) * 6));
+            draws++;
+            runStart = i;
+        }
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        lastStats.quads = quads.size();
+        lastStats.draws = draws;
+        quads.clear();
+    }
+
+    Stats getStats() const {
+        Stats result = lastStats;
+        result.bufferResizes = stats.bufferResizes;
+        return result;
+    }
+
+    void Delete() {
+        if (!initialised) return;
+        glDeleteBuffers(1, &VBO);
+        glDeleteVertexArrays(1, &VAO);
+        VAO = VBO = 0;
+        capacity = 0;
+        initialised = false;
+    }
+
+private:
+    struct SortKey {
+        int layer;
+        GLuint program;
+        GLuint texture;
+
+        bool operator<(const SortKey& other) const {
+            if (layer != other.layer) return layer < other.layer;
+            if (program != other.program) return program < other.program;
+            return texture < other.texture;
+        }
+        // Layers don't need their own draw, only the GL state does
+        bool sameBatch(const SortKey& other) const { return program == other.program && texture == other.texture; }
+    };
+
+    struct Quad {
+        SortKey key;
+        const Shader* shader;
+        glm::vec2 min, max;
+        glm::vec2 uvMin, uvMax;
+        glm::vec4 color;
+    };
+
+    struct Vertex {
+        GLfloat x, y, u, v;
+        glm::vec4 color;
+    };
+
+    bool initialised = false;
+    GLuint VAO = 0, VBO = 0;
+    size_t capacity = 0; // Bytes allocated for VBO
+
+    std::vector<Quad> quads;
+    std::vector<uint32_t> order;
+    std::vector<Vertex> vertices;
+    Stats stats;
+    Stats lastStats;
+
+    void initialise() {
+        if (initialised) return;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(4 * sizeof(GLfloat)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        initialised = true;
+    }
+};
+
+#endif
@@ -6,12 +6,25 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <map>
+#include <algorithm>
+#include <array>
+#include <vector>
 #include "Shaders.h"
+#include "SpriteBatch.h"
 #include <string>
 
+/*NOTE : Bitmap font text, every ASCII glyph packed in one atlas texture at load time.
+
+  Loading is Rasterize() (FreeType + packing, CPU only) then Upload() (the texture), so
+  the first half can go on the AssetLoader's workers.
+
+  AddText() queues one quad per glyph in the SpriteBatch (all of them on the atlas, so the
+  whole frame's text is a single draw when the batch flushes). RenderText() is AddText +
+  a flush of the batch, for a string that has to be on screen right away.
+*/
 struct Character {
-    GLuint TextureID;    // Texture ID storing the glyph
+    glm::vec2 UVMin;     // Top left of the glyph in the atlas
+    glm::vec2 UVMax;     // Bottom right
     glm::ivec2 Size;     // Size of the glyph
     glm::ivec2 Bearing;  // Offset from baseline
     GLuint Advance;      // Advance to the next character
@@ -19,114 +32,150 @@ struct Character {
 
 class TextRenderer {
 public:
-    std::map<char, Character> Characters;
-    GLuint VAO, VBO;
+    static const int GLYPH_COUNT = 128;
+
+    std::array<Character, GLYPH_COUNT> Characters{};
+    GLuint AtlasID = 0;
     Shader& shader;
+    SpriteBatch& batch;
+
+    // Glyph metrics + the atlas pixels, built without GL (Rasterize runs fine on a worker thread)
+    struct FontAtlas {
+        std::array<Character, GLYPH_COUNT> characters{};
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Nothing to draw until Upload() (see AssetLoader)
+    TextRenderer(Shader& textShader, SpriteBatch& spriteBatch)
+        : shader(textShader), batch(spriteBatch) {
+    }
+
+    TextRenderer(Shader& textShader, SpriteBatch& spriteBatch, const std::string& fontPath, GLuint fontSize)
+        : shader(textShader), batch(spriteBatch) {
+        Upload(Rasterize(fontPath, fontSize));
+    }
+
+    static FontAtlas Rasterize(const std::string& fontPath, GLuint fontSize) {
+        FontAtlas result;
 
-    TextRenderer(Shader& textShader, const std::string& fontPath, GLuint fontSize) : shader(textShader) {
-        // Initialize FreeType
+        // Initialize FreeType (a library per call, FT_Library isn't shared between threads)
         FT_Library ft;
         if (FT_Init_FreeType(&ft)) {
             std::cerr << "ERROR::FREETYPE: Could not initialize FreeType library" << std::endl;
-            return;
+            return result;
         }
 
         // Load font
         FT_Face face;
         if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
             std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
-            return;
+            FT_Done_FreeType(ft);
+            return result;
         }
 
         FT_Set_Pixel_Sizes(face, 0, fontSize);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        // Load characters 0-128
-        for (GLubyte c = 0; c < 128; c++) {
+        // 1) Rasterize characters 0-128 and place them on shelves (rows) of a fixed width atlas
+        std::array<std::vector<unsigned char>, GLYPH_COUNT> bitmaps;
+        std::array<glm::ivec2, GLYPH_COUNT> origins{};
+        int penX = ATLAS_PADDING, penY = ATLAS_PADDING, shelfHeight = 0;
+        for (int c = 0; c < GLYPH_COUNT; c++) {
             if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
                 std::cerr << "ERROR::FREETYPE: Failed to load glyph " << c << std::endl;
                 continue;
             }
 
-            GLuint texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            Character character = {
-                texture,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                (GLuint)face->glyph->advance.x
-            };
-            Characters.insert(std::pair<char, Character>(c, character));
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            int w = static_cast<int>(bitmap.width);
+            int h = static_cast<int>(bitmap.rows);
+            if (penX + w + ATLAS_PADDING > ATLAS_WIDTH) {
+                penX = ATLAS_PADDING;
+                penY += shelfHeight + ATLAS_PADDING;
+                shelfHeight = 0;
+            }
+            origins[c] = glm::ivec2(penX, penY);
+            penX += w + ATLAS_PADDING;
+            shelfHeight = std::max(shelfHeight, h);
+
+            // pitch can be bigger than the width (or negative for bottom-up bitmaps)
+            bitmaps[c].resize(static_cast<size_t>(w) * h);
+            for (int row = 0; row < h; row++) {
+                const unsigned char* src = bitmap.buffer + (bitmap.pitch >= 0 ? row : row - h + 1) * bitmap.pitch;
+                std::copy(src, src + w, bitmaps[c].begin() + static_cast<size_t>(row) * w);
+            }
+
+            result.characters[c].Size = glm::ivec2(w, h);
+            result.characters[c].Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+            result.characters[c].Advance = static_cast<GLuint>(face->glyph->advance.x);
         }
+        result.width = ATLAS_WIDTH;
+        result.height = penY + shelfHeight + ATLAS_PADDING;
 
         FT_Done_Face(face);
         FT_Done_FreeType(ft);
 
-        // Configure VAO/VBO for text rendering
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        // 2) Copy every glyph in
+        result.pixels.assign(static_cast<size_t>(result.width) * result.height, 0);
+        for (int c = 0; c < GLYPH_COUNT; c++) {
+            Character& ch = result.characters[c];
+            for (int row = 0; row < ch.Size.y; row++) {
+                std::copy(bitmaps[c].begin() + static_cast<size_t>(row) * ch.Size.x,
+                    bitmaps[c].begin() + static_cast<size_t>(row + 1) * ch.Size.x,
+                    result.pixels.begin() + static_cast<size_t>(origins[c].y + row) * result.width + origins[c].x);
+            }
+            ch.UVMin = glm::vec2(origins[c]) / glm::vec2(result.width, result.height);
+            ch.UVMax = glm::vec2(origins[c] + ch.Size) / glm::vec2(result.width, result.height);
+        }
+        return result;
     }
 
-    void RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
-        shader.Use();
-        shader.SetUniform3f("textColor", color.x, color.y, color.z);
-        glActiveTexture(GL_TEXTURE0);
-        glBindVertexArray(VAO);
+    // 3) One texture upload, main thread
+    void Upload(const FontAtlas& font) {
+        if (font.pixels.empty()) return;
+        Characters = font.characters;
 
-        for (auto c : text) {
-            Character ch = Characters[c];
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &AtlasID);
+        glBindTexture(GL_TEXTURE_2D, AtlasID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, font.width, font.height, 0, GL_RED, GL_UNSIGNED_BYTE, font.pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    ~TextRenderer() {
+        glDeleteTextures(1, &AtlasID);
+    }
+
+    // Queues the quads of a string, nothing is drawn before the batch flushes
+    void AddText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
+        for (char c : text) {
+            unsigned char index = static_cast<unsigned char>(c);
+            if (index >= GLYPH_COUNT) index = '?';
+            const Character& ch = Characters[index];
             GLfloat xpos = x + ch.Bearing.x * scale;
             GLfloat ypos = y - (ch.Bearing.y) * scale;  // Corrected this line
             GLfloat w = ch.Size.x * scale;
             GLfloat h = ch.Size.y * scale;
-
-            float vertices[6][4] = {
-                { xpos,     ypos + h,   0.0f, 0.0f },
-                { xpos,     ypos,       0.0f, 1.0f },
-                { xpos + w, ypos,       1.0f, 1.0f },
-
-                { xpos,     ypos + h,   0.0f, 0.0f },
-                { xpos + w, ypos,       1.0f, 1.0f },
-                { xpos + w, ypos + h,   1.0f, 0.0f }
-            };
-
-            glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-            glDrawArrays(GL_TRIANGLES, 0, 6);
             x += (ch.Advance >> 6) * scale;
+            if (ch.Size.x == 0 || ch.Size.y == 0) continue; // Spaces
+
+            batch.Queue(shader, AtlasID, glm::vec2(xpos, ypos), glm::vec2(xpos + w, ypos + h), ch.UVMin, ch.UVMax, glm::vec4(color, 1.0f));
         }
+    }
 
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+    void RenderText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
+        AddText(text, x, y, scale, color);
+        batch.Flush();
     }
+
+private:
+    static const int ATLAS_WIDTH = 512;
+    static const int ATLAS_PADDING = 1; // Keeps linear filtering from bleeding the neighbours in
 };
 
 #endif
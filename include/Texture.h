@@ -6,6 +6,7 @@
 #include <stb/stb_image.h>
 #include <iostream>
 #include "Shaders.h"
+#include "SpriteBatch.h"
 #include <glm/glm.hpp>
 
 class TextureImp {
@@ -65,41 +66,9 @@ public:
         stbi_image_free(data);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
-    void Draw(const Shader& shader, const glm::vec2& position, const glm::vec2& size) {
-        
-        GLfloat vertices[] = {
-            // Positions          // Texture Coordinates
-            position.x,          position.y + size.y,  0.0f, 1.0f, // Top-left
-            position.x + size.x, position.y + size.y,  1.0f, 1.0f, // Top-right
-            position.x,          position.y,           0.0f, 0.0f, // Bottom-left
-            position.x + size.x, position.y,           1.0f, 0.0f  // Bottom-right
-        };
-
-        GLuint VBO, VAO;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-        // Position (0)
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
-        glEnableVertexAttribArray(0);
-        // TexCoords (1)
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(1);
-
-        shader.Use();
-
-        this->Bind(0);
-
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-      
-        glBindVertexArray(0);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+    // Queues a screen space quad, drawn with everything else at the batch's next Flush()
+    void Draw(SpriteBatch& batch, const Shader& shader, const glm::vec2& position, const glm::vec2& size) const {
+        batch.Queue(shader, ID, position, position + size, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
     }
 
     void Bind(GLuint textureUnit = 0) const {
@@ -5,127 +5,157 @@
 #include <GL/glew.h>
 #include <stb/stb_image.h>
 #include <iostream>
+#include <string>
+#include <vector>
+#include "SpriteBatch.h"
 
 class TextureImp {
 public:
-    GLuint ID;
+    GLuint ID = 0;
     std::string type;
     std::string path;
     bool isTextureFlipped = false;
+
+    // Decoded pixels, nothing on the GL side yet (decodeImage runs fine on a worker thread)
+    struct ImageData {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        bool flipped = false;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Empty texture, filled later by upload() (see AssetLoader)
+    TextureImp() = default;
+
     // Constructor: Loads the texture
     TextureImp(const std::string& texturePath, const std::string& textureType , bool flip)
         : path(texturePath), type(textureType) , isTextureFlipped(flip) {
-        // Load image
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(isTextureFlipped);  
-        
-        unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
+        upload(decodeImage(texturePath, flip), textureType);
+    }
 
+    static ImageData decodeImage(const std::string& texturePath, bool flip) {
+        ImageData image;
+        image.path = texturePath;
+        image.flipped = flip;
+        // The thread local flag, the global one would race with the other workers
+        stbi_set_flip_vertically_on_load_thread(flip);
+        unsigned char* data = stbi_load(texturePath.c_str(), &image.width, &image.height, &image.channels, 0);
         if (data) {
-            std::cout << "Is texture flipped" << ( this->isTextureFlipped ? "Yes" : "No" ) << "\n";
-            std::cout << "Texture loaded successfully from path: " << texturePath << std::endl;
-            std::cout << "Width: " << width << " Height: " << height << " Channels: " << nrChannels << std::endl;
-
-            glGenTextures(1, &ID);
-            glBindTexture(GL_TEXTURE_2D, ID);
-
-            GLenum format = GL_RGB;  // Default to RGB
-
-            // Set the texture format based on the number of channels
-            if (nrChannels == 1) {
-                format = GL_RED;  // For grayscale images
-            }
-            else if (nrChannels == 3) {
-                format = GL_RGB;  // For RGB images
-            }
-            else if (nrChannels == 4) {
-                format = GL_RGBA; // For RGBA images (PNG with alpha)
-            }
-            else {
-                std::cerr << "Unsupported number of channels (" << nrChannels << "). Using GL_RGB." << std::endl;
-            }
-
-            // Set texture parameters
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);  // Crisp minification (nearest mipmap)
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Crisp magnification (nearest)
-
+            image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * image.channels);
+        }
+        else {
+            image.width = image.height = image.channels = 0;
+        }
+        stbi_image_free(data);
+        return image;
+    }
 
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    // Creates the GL texture (crisp, mipmapped, repeating), 0 if the image didn't decode
+    static GLuint createTexture(const ImageData& image) {
+        if (image.pixels.empty()) {
+            std::cerr << "ERROR :: Texture failed to load from path: " << image.path << std::endl;
+            return 0;
+        }
 
-            glGenerateMipmap(GL_TEXTURE_2D);  // Now we generate the mipmaps
+        GLenum format = GL_RGB;  // Default to RGB
 
-            std::cout << "Texture uploaded and mipmaps generated successfully!" << std::endl;
+        // Set the texture format based on the number of channels
+        if (image.channels == 1) {
+            format = GL_RED;  // For grayscale images
+        }
+        else if (image.channels == 3) {
+            format = GL_RGB;  // For RGB images
+        }
+        else if (image.channels == 4) {
+            format = GL_RGBA; // For RGBA images (PNG with alpha)
         }
         else {
-            std::cerr << "ERROR :: Texture failed to load from path: " << texturePath << std::endl;
+            std::cerr << "Unsupported number of channels (" << image.channels << "). Using GL_RGB." << std::endl;
         }
 
-        // Free image data after uploading
-        stbi_image_free(data);
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        // Set texture parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);  // Crisp minification (nearest mipmap)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Crisp magnification (nearest)
+
+        // Rows of 1 / 3 channel images aren't 4 byte aligned
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+        glGenerateMipmap(GL_TEXTURE_2D);  // Now we generate the mipmaps
         glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    void Draw(const Shader& shader, const glm::vec2& position, const glm::vec2& size) {
-        GLfloat vertices[] = {
-            // Positions          // Texture Coordinates
-            position.x,          position.y + size.y,  0.0f, 1.0f, // Top-left
-            position.x + size.x, position.y + size.y,  1.0f, 1.0f, // Top-right
-            position.x,          position.y,           0.0f, 0.0f, // Bottom-left
-            position.x + size.x, position.y,           1.0f, 0.0f  // Bottom-right
-        };
-
-        GLuint VBO, VAO;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-        // Position attribute
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
-        glEnableVertexAttribArray(0);
-        // Texture coord attribute
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(1);
-
-        shader.Use();
-
-        this->Bind(0);
-
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-        glBindVertexArray(0);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+        return texture;
     }
 
-    static unsigned int loadHDR(std::string path) {
-        stbi_set_flip_vertically_on_load(true);
-        int width, height, nrComponents;
-        float* data = stbi_loadf(path.c_str(), &width, &height, &nrComponents, 0);
-        unsigned int hdrTexture = 0;
-        if (data)
-        {
-            glGenTextures(1, &hdrTexture);
-            glBindTexture(GL_TEXTURE_2D, hdrTexture);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
+    // Main thread half of the load
+    void upload(const ImageData& image, const std::string& textureType) {
+        path = image.path;
+        type = textureType;
+        isTextureFlipped = image.flipped;
+        ID = createTexture(image);
+        if (ID) {
+            std::cout << "Texture loaded successfully from path: " << path << std::endl;
+            std::cout << "Width: " << image.width << " Height: " << image.height << " Channels: " << image.channels << std::endl;
+        }
+    }
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Queues a screen space quad, drawn with everything else at the batch's next Flush()
+    void Draw(SpriteBatch& batch, const Shader& shader, const glm::vec2& position, const glm::vec2& size) const {
+        batch.Queue(shader, ID, position, position + size, glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f));
+    }
 
+    // Equirectangular HDR in CPU memory, rows bottom to top (what loadHDR uploads)
+    struct HDRImage {
+        int width = 0;
+        int height = 0;
+        std::vector<float> rgb;
+    };
+
+    static HDRImage loadHDRImage(const std::string& path) {
+        HDRImage image;
+        stbi_set_flip_vertically_on_load_thread(true);
+        int nrComponents;
+        float* data = stbi_loadf(path.c_str(), &image.width, &image.height, &nrComponents, 3);
+        if (data) {
+            image.rgb.assign(data, data + static_cast<size_t>(image.width) * image.height * 3);
             stbi_image_free(data);
-            std::cout << "Loaded HDRI: " + path + "\n";
         }
-        else
-        {
+        else {
             std::cout << "Failed to load HDR image." << std::endl;
+            image.width = image.height = 0;
         }
-        stbi_set_flip_vertically_on_load(false);
+        stbi_set_flip_vertically_on_load_thread(false);
+        return image;
+    }
+
+    static unsigned int uploadHDR(const HDRImage& image) {
+        unsigned int hdrTexture = 0;
+        if (image.rgb.empty()) return hdrTexture;
+
+        glGenTextures(1, &hdrTexture);
+        glBindTexture(GL_TEXTURE_2D, hdrTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, image.width, image.height, 0, GL_RGB, GL_FLOAT, image.rgb.data());
 
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return hdrTexture;
+    }
+
+    static unsigned int loadHDR(std::string path) {
+        unsigned int hdrTexture = uploadHDR(loadHDRImage(path));
+        if (hdrTexture) std::cout << "Loaded HDRI: " + path + "\n";
         return hdrTexture;
     }
 
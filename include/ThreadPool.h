@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_CLASS_H
+#define THREAD_POOL_CLASS_H
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*NOTE : Fixed set of worker threads running jobs in submission order (FIFO).
+
+  Meant for CPU work that can overlap with the main thread (asset decoding at startup,
+  crowd poses in AnimationScheduler). Jobs must not touch GL, whatever they produce goes back to the main thread
+  through the caller's own queue (see AssetLoader). The destructor finishes the jobs
+  already queued before joining.
+*/
+class ThreadPool {
+public:
+    // 0 = one per core, minus the main thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Blocks until the queue is empty and no job is running
+    void waitIdle();
+
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    unsigned int running = 0;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif
@@ -4,7 +4,12 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "Chunk.h"
+#include "ChunkUploader.h"
+#include "LightEngine.h"
+#include "MeshBufferPool.h"
+#include "ChunkPool.h"
 #include "noise/FastNoiseLite.h"
+#include <iostream>
 #include <numeric>
 #include <random>
 #include <thread>
@@ -47,6 +52,39 @@ struct ChunkTaskComparator {
     }
 };
 
+// Chunks the renderer can draw (in the cache, meshes on the GPU). Built by the main thread when
+// that set changes and never touched again once published, see World::getRenderList
+struct RenderList {
+    uint64_t version = 0;
+    std::vector<std::shared_ptr<Chunk>> handles; // Keeps the listed chunks out of the pool
+    std::vector<Chunk*> chunks;                  // Same chunks, what ChunkCuller takes
+};
+
+// Lower value = meshed first (block edits must never wait behind streaming refreshes)
+enum class RemeshPriority {
+    EDIT = 0,
+    NEIGHBOUR = 1
+};
+
+struct RemeshTask {
+    glm::ivec3 position;
+    RemeshPriority priority;
+    float distanceToPlayer;
+};
+
+// What is queued for a chunk : best priority so far + every section asked for
+struct QueuedRemesh {
+    RemeshPriority priority;
+    uint32_t sections;
+};
+
+struct RemeshTaskComparator {
+    bool operator()(const RemeshTask& a, const RemeshTask& b) const {
+        if (a.priority != b.priority) return a.priority > b.priority;
+        return a.distanceToPlayer > b.distanceToPlayer;
+    }
+};
+
 enum class BiomeType {
     PLAINS,
     DESERT,
@@ -73,7 +111,7 @@ public:
     unsigned int seed = 7000;
 
     glm::ivec2 currentPlayerChunk;
-    float generateRandomFloat(float min, float max) {
+    static float generateRandomFloat(float min, float max) {
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_real_distribution<> dis(min, max);
@@ -90,12 +128,10 @@ private:
     float flatTerrainFrequency = 0.0008f;
     float waterLevel = 64;
 
-    glm::vec3 player_position;
+    glm::vec3 player_position{ 0.0f };
     std::mutex chunksMutex;
     std::mutex cacheMutex;
     std::mutex playerChunkMutex;
-    std::unordered_set<Chunk*> dirtyChunks;
-    std::mutex dirtyChunksMutex;
 
     
 
@@ -113,12 +149,53 @@ private:
     // Thread management
     std::thread updateThread;
     std::queue<std::shared_ptr<Chunk>> readyToUploadChunks;
+    std::set<glm::ivec3, Vec3Comparator> queuedChunkPositions; // Generated, not in chunkCache yet (queueMutex)
     std::mutex queueMutex;
     std::condition_variable chunkCV;
     std::atomic<bool> isUpdating{ false };
     std::atomic<bool> stopUpdates{ false };
     std::mutex updateMutex;
 
+    // GPU side hook (null when running headless), only ever touched on the main thread
+    ChunkUploader* uploader = nullptr;
+
+    // Evicted chunks (both eviction paths), the main thread hands them to chunkPool once
+    // no remesh worker holds them anymore
+    std::vector<std::shared_ptr<Chunk>> retiredChunks;
+    std::mutex retiredMutex;
+
+    // Evicted chunks come back from here instead of make_shared (block storage + GPU mesh ranges reused)
+    ChunkPool chunkPool;
+
+    // Remesh queue (edits + neighbour refreshes), serviced by remeshWorkers. Tasks only carry
+    // the chunk position, the worker resolves it through the cache so evicted chunks just drop out
+    std::priority_queue<RemeshTask, std::vector<RemeshTask>, RemeshTaskComparator> remeshQueue;
+    std::unordered_map<glm::ivec3, QueuedRemesh, Vec2Hash> queuedRemeshes;   // Merged request per chunk
+    std::unordered_set<glm::ivec3, Vec2Hash> pendingDirtyChunkPositions;     // Edited borders of chunks not loaded yet
+    std::mutex remeshMutex;
+    std::condition_variable remeshCV;
+    std::vector<std::thread> remeshWorkers;
+    std::atomic<int> remeshesInFlight{ 0 };
+
+    // Chunks with a freshly published back buffer, swapped + uploaded by the main thread
+    std::vector<std::shared_ptr<Chunk>> meshedChunks;
+    std::mutex meshedMutex;
+
+    // Vertex/index buffers of every chunk mesh. Meshes are built right sized from it and the
+    // CPU copies go back into it once they are on the GPU
+    MeshBufferPool meshPool;
+
+    // Last published render list, swapped with atomic_store so readers never lock. renderListDirty
+    // is raised whenever a chunk enters / leaves the cache or gets / loses its GPU mesh
+    std::shared_ptr<const RenderList> renderList = std::make_shared<const RenderList>();
+    std::atomic<bool> renderListDirty{ false };
+    uint64_t renderListVersion = 0;
+
+    // Sky/block light of the cached chunks. Main thread only, always under cacheMutex so the
+    // streaming thread can't evict a chunk the flood fill is walking through
+    LightEngine lightEngine;
+    std::vector<std::pair<Chunk*, uint32_t>> lightDirtyScratch;
+
     size_t MAX_CHUNKS_IN_MEMORY = 1024; //Max chunks in chunk cache
 
     struct ChunkCacheEntry {
@@ -159,8 +236,14 @@ private:
         for (size_t i = 0; i < numToRemove; ++i) {
             auto& pos = chunksWithDistance[i].first;
             if (enableDiskCache) saveChunkToDisk(chunkCache[pos].chunk);
-            chunkCache[pos].chunk->freeGLResources(); // Free GPU resources V.V imp
+            unlinkNeighbors(*chunkCache[pos].chunk);
+            {
+                // GPU side is recycled (or freed) with the chunk in updateChunks V.V imp
+                std::lock_guard<std::mutex> retiredLock(retiredMutex);
+                retiredChunks.push_back(chunkCache[pos].chunk);
+            }
             chunkCache.erase(pos);
+            renderListDirty = true;
         }
     }
 
@@ -213,7 +296,7 @@ private:
                     return nullptr;
                 }
 
-                auto chunk = std::make_shared<Chunk>(pos);
+                auto chunk = chunkPool.acquire(pos);
                 for (int x = 0; x < CHUNK_SIZE; ++x) {
                     for (int y = 0; y < CHUNK_DEPTH; ++y) {
                         for (int z = 0; z < CHUNK_SIZE; ++z) {
@@ -254,6 +337,27 @@ private:
         }
     }
 
+    // Evicted chunk : the neighbours still in the cache must stop pointing at it (the light
+    // flood fill and the mesher follow these pointers)
+    void unlinkNeighbors(Chunk& chunk) {
+        constexpr std::array<int, 4> oppositeIndex = { 1, 0, 3, 2 };
+        for (int i = 0; i < 4; i++) {
+            Chunk* neighbor = chunk.neighbors[i];
+            if (neighbor && neighbor->neighbors[oppositeIndex[i]] == &chunk) {
+                neighbor->neighbors[oppositeIndex[i]] = nullptr;
+            }
+        }
+    }
+
+    // Remeshes whatever the last light change made stale. Caller holds cacheMutex
+    void flushLightRemeshes(RemeshPriority priority) {
+        lightDirtyScratch.clear();
+        lightEngine.takeDirtyChunks(lightDirtyScratch);
+        for (const auto& [chunk, sections] : lightDirtyScratch) {
+            requestRemesh(chunk->getPosition(), priority, sections);
+        }
+    }
+
     void backgroundUpdateLoop() {
         while (!stopUpdates) {
             glm::vec3 currentPlayerPos = this->player_position;
@@ -276,7 +380,14 @@ private:
 
                     if (distanceSq > maxDistanceSq) {
                         if (enableDiskCache) saveChunkToDisk(it->second.chunk);
+                        {
+                            // No GL context on this thread, let the main thread free the buffers
+                            std::lock_guard<std::mutex> retiredLock(retiredMutex);
+                            retiredChunks.push_back(it->second.chunk);
+                        }
+                        unlinkNeighbors(*it->second.chunk);
                         it = chunkCache.erase(it);
+                        renderListDirty = true;
                     }
                     else {
                         ++it;
@@ -310,7 +421,7 @@ private:
             //---Priority based chunk loading (Priority is based on the Player-Chunk distance)---//
             std::priority_queue<ChunkTask, std::vector<ChunkTask>, ChunkTaskComparator> chunkQueue;
             for (const auto& pos : neededChunks) {
-                if (!isChunkLoaded(pos)) {
+                if (!isChunkLoaded(pos) && !isChunkQueued(pos)) {
                     float dist = glm::distance2(
                         glm::vec2(pos.x, pos.z),
                         glm::vec2(currentPlayerPos.x, currentPlayerPos.z)
@@ -335,15 +446,19 @@ private:
 
                 // Else : generate a new chunk
                 if (!chunk) {
-                    chunk = std::make_shared<Chunk>(chunkPos);
+                    chunk = chunkPool.acquire(chunkPos);
                     generateChunkData(*chunk); 
                 }
+                // Own light only, the light coming through the walls gets stitched in once it's cached
+                LightEngine::lightNewChunk(*chunk);
+
                 setNeighborChunks(*chunk); //Find and assign neighbours to that chunk for culling
-                chunk->generateMeshData();
+                chunk->generateMeshData(&meshPool);
 
                 {
                     std::lock_guard<std::mutex> lock(queueMutex);
                     readyToUploadChunks.push(chunk);
+                    queuedChunkPositions.insert(chunkPos);
                 }
 
                 // Flag to the main thread
@@ -354,10 +469,83 @@ private:
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
     }
-    std::unordered_set<glm::ivec3, Vec2Hash> pendingDirtyChunkPositions;
+
+    void remeshWorkerLoop() {
+        // Section scratch owned by this worker (full meshes build in Chunk's thread_local scratch)
+        SectionMesh solidSectionScratch;
+        SectionMesh liquidSectionScratch;
+
+        while (true) {
+            RemeshTask task;
+            uint32_t sections = 0;
+            {
+                std::unique_lock<std::mutex> lock(remeshMutex);
+                remeshCV.wait(lock, [this] { return stopUpdates || !remeshQueue.empty(); });
+                if (stopUpdates) return;
+
+                task = remeshQueue.top();
+                remeshQueue.pop();
+
+                // Stale entry, the chunk got re-queued with a better priority (or already meshed)
+                auto queuedIt = queuedRemeshes.find(task.position);
+                if (queuedIt == queuedRemeshes.end() || queuedIt->second.priority != task.priority) continue;
+                sections = queuedIt->second.sections;
+                queuedRemeshes.erase(queuedIt);
+                ++remeshesInFlight;
+            }
+
+            // Hold the chunk and its neighbours so an eviction can't free them mid-mesh
+            std::shared_ptr<Chunk> chunk;
+            std::array<std::shared_ptr<Chunk>, 4> neighbourRefs;
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                auto it = chunkCache.find(task.position);
+                if (it == chunkCache.end() || !it->second.chunk) {
+                    --remeshesInFlight;
+                    continue;
+                }
+                chunk = it->second.chunk;
+
+                setNeighborChunks(*chunk);
+                for (int i = 0; i < 4; i++) {
+                    if (!chunk->neighbors[i]) continue;
+                    neighbourRefs[i] = chunkCache.find(chunk->neighbors[i]->getPosition())->second.chunk;
+                }
+            }
+
+            // Edits only rebuild the 16^3 sections they touched
+            if (sections == ALL_CHUNK_SECTIONS) chunk->generatePendingMeshData(&meshPool);
+            else chunk->generatePendingSections(sections, solidSectionScratch, liquidSectionScratch);
+
+            std::lock_guard<std::mutex> lock(meshedMutex);
+            meshedChunks.push_back(chunk);
+            --remeshesInFlight;
+        }
+    }
 
 public:
 
+    // Queue a chunk (or some of its sections) for an off-thread remesh, the main thread uploads it once it is done
+    void requestRemesh(const glm::ivec3& chunkPos, RemeshPriority priority, uint32_t sections = ALL_CHUNK_SECTIONS) {
+        glm::vec3 currentPlayerPos = player_position;
+        float dist = glm::distance2(
+            glm::vec2(chunkPos.x + CHUNK_SIZE / 2.0f, chunkPos.z + CHUNK_SIZE / 2.0f),
+            glm::vec2(currentPlayerPos.x, currentPlayerPos.z)
+        );
+
+        {
+            std::lock_guard<std::mutex> lock(remeshMutex);
+            auto [it, inserted] = queuedRemeshes.try_emplace(chunkPos, QueuedRemesh{ priority, sections });
+            if (!inserted) {
+                it->second.sections |= sections;
+                if (it->second.priority <= priority) return; // Already queued at least this urgently
+                it->second.priority = priority;
+            }
+            remeshQueue.push({ chunkPos, priority, dist });
+        }
+        remeshCV.notify_one();
+    }
+
     void markChunkAndNeighborsDirty(Chunk* chunk, const glm::ivec3& localPos) {
         bool onWestEdge = (localPos.x == 0);
         bool onEastEdge = (localPos.x == CHUNK_SIZE - 1);
@@ -372,33 +560,76 @@ public:
         glm::ivec3 northNeighborPos = chunkPos + glm::ivec3(0, 0, CHUNK_SIZE); // North (+Z)
         glm::ivec3 southNeighborPos = chunkPos + glm::ivec3(0, 0, -CHUNK_SIZE);// South (-Z)
 
-        std::lock_guard<std::mutex> lock(dirtyChunksMutex);
-        dirtyChunks.insert(chunk);
+        requestRemesh(chunkPos, RemeshPriority::EDIT, Chunk::sectionsTouchedBy(localPos));
 
         // Correct neighbor indices (0=North, 1=South, 2=East, 3=West)
-        if (onWestEdge) {  // West edge requires neighbor 3 (West)
-            if (chunk->neighbors[3]) dirtyChunks.insert(chunk->neighbors[3]);
-            else pendingDirtyChunkPositions.insert(westNeighborPos);
+        // Across a chunk wall the faces at y-1..y+1 can see the edited block (baked AO)
+        uint32_t borderSection = Chunk::sectionsTouchedBy(localPos);
+        auto markNeighbor = [&](Chunk* neighbor, const glm::ivec3& neighborPos) {
+            if (neighbor) {
+                requestRemesh(neighborPos, RemeshPriority::EDIT, borderSection);
+            }
+            else {
+                std::lock_guard<std::mutex> lock(remeshMutex);
+                pendingDirtyChunkPositions.insert(neighborPos);
+            }
+        };
+        if (onWestEdge) markNeighbor(chunk->neighbors[3], westNeighborPos);   // West edge requires neighbor 3 (West)
+        if (onEastEdge) markNeighbor(chunk->neighbors[2], eastNeighborPos);   // East edge requires neighbor 2 (East)
+        if (onSouthEdge) markNeighbor(chunk->neighbors[1], southNeighborPos); // South edge requires neighbor 1 (South)
+        if (onNorthEdge) markNeighbor(chunk->neighbors[0], northNeighborPos); // North edge requires neighbor 0 (North)
+    }
+
+    
+    struct CacheStats {
+        size_t cachedChunks = 0;
+        size_t maxCachedChunks = 0;
+        size_t uploadQueue = 0;
+        size_t remeshQueue = 0;
+        size_t remeshesInFlight = 0;
+        size_t meshedChunks = 0;
+        size_t retiredChunks = 0;
+    };
+
+    const MeshBufferPool& getMeshPool() const { return meshPool; }
+
+    CacheStats getCacheStats() {
+        CacheStats stats;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            stats.cachedChunks = chunkCache.size();
+            stats.maxCachedChunks = MAX_CHUNKS_IN_MEMORY;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stats.uploadQueue = readyToUploadChunks.size();
         }
-        if (onEastEdge) {  // East edge requires neighbor 2 (East)
-            if (chunk->neighbors[2]) dirtyChunks.insert(chunk->neighbors[2]);
-            else pendingDirtyChunkPositions.insert(eastNeighborPos);
+        {
+            std::lock_guard<std::mutex> lock(remeshMutex);
+            stats.remeshQueue = queuedRemeshes.size();
         }
-        if (onSouthEdge) { // South edge requires neighbor 1 (South)
-            if (chunk->neighbors[1]) dirtyChunks.insert(chunk->neighbors[1]);
-            else pendingDirtyChunkPositions.insert(southNeighborPos);
+        stats.remeshesInFlight = remeshesInFlight;
+        {
+            std::lock_guard<std::mutex> lock(meshedMutex);
+            stats.meshedChunks = meshedChunks.size();
         }
-        if (onNorthEdge) { // North edge requires neighbor 0 (North)
-            if (chunk->neighbors[0]) dirtyChunks.insert(chunk->neighbors[0]);
-            else pendingDirtyChunkPositions.insert(northNeighborPos);
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            stats.retiredChunks = retiredChunks.size();
         }
+        return stats;
     }
 
-    
     void logCacheStats() {
-        std::lock_guard<std::mutex> lock(cacheMutex);
-        std::cout << "Chunk Cache Size: " << sizeof(chunkCache) << "/" << "\n";
-        std::cout << "Upload Queue Size: " << readyToUploadChunks.size() << "/" << "\n";
+        CacheStats stats = getCacheStats();
+        std::cout << "Chunk Cache Size: " << stats.cachedChunks << "/" << stats.maxCachedChunks << "\n";
+        std::cout << "Upload Queue Size: " << stats.uploadQueue << "\n";
+        std::cout << "Remesh Queue: " << stats.remeshQueue << " (+" << stats.remeshesInFlight << " in flight) | Meshed (awaiting upload): " << stats.meshedChunks << "\n";
+        std::cout << "Retired Chunks: " << stats.retiredChunks << "\n";
+
+        ChunkPool::Stats pool = chunkPool.getStats();
+        std::cout << "Chunk Pool: " << pool.pooled << "/" << chunkPool.getHighWaterMark() << " | hit rate " << pool.hitRate() * 100.0
+            << "% (" << pool.hits << "/" << pool.acquires << ") | dropped " << pool.dropped << "\n";
     }
 
     std::unordered_map<glm::ivec3, ChunkCacheEntry, Vec2Hash> chunkCache;
@@ -421,8 +652,11 @@ public:
         {0.47f, 0.001f},
     };
 
-    World() {
-        seed = generateRandomFloat(0, 10000);
+    World() : World(static_cast<unsigned int>(generateRandomFloat(0, 10000))) {}
+
+    // Fixed seed -> the exact same terrain and decorations every run (benchmarks rely on this)
+    explicit World(unsigned int worldSeed) {
+        seed = worldSeed;
         //seed = 5652;
         // Noise config
         terrainNoise.SetSeed(seed);
@@ -468,13 +702,37 @@ public:
     ~World() {
         stopUpdates = true;
         chunkCV.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(remeshMutex); // No lost wakeup between the predicate and the wait
+        }
+        remeshCV.notify_all();
         if (updateThread.joinable()) {
             updateThread.join();
         }
+        for (auto& worker : remeshWorkers) {
+            if (worker.joinable()) worker.join();
+        }
     }
 
     void inithread() {
         updateThread = std::thread(&World::backgroundUpdateLoop, this);
+        startRemeshWorkers();
+    }
+
+    // 0 = leave a core for the main thread and one for the streaming thread
+    void startRemeshWorkers(unsigned int count = 0) {
+        if (!remeshWorkers.empty()) return;
+        if (count == 0) {
+            unsigned int cores = std::thread::hardware_concurrency();
+            count = std::clamp(cores > 2 ? cores - 2 : 1u, 1u, 4u);
+        }
+        for (unsigned int i = 0; i < count; ++i) {
+            remeshWorkers.emplace_back(&World::remeshWorkerLoop, this);
+        }
+    }
+
+    void setUploader(ChunkUploader* chunkUploader) {
+        uploader = chunkUploader;
     }
 
     void updateChunks() {
@@ -482,24 +740,35 @@ public:
             chunkCV.notify_one();
         }
 
-        // 1) Process dirty chunks
-        std::unordered_set<Chunk*> chunksToUpdate;
+        // 1) Swap in the meshes the remesh workers finished and upload them
+        std::vector<std::shared_ptr<Chunk>> meshed;
         {
-            std::lock_guard<std::mutex> lock(dirtyChunksMutex);
-            chunksToUpdate = std::move(dirtyChunks);
-            dirtyChunks.clear();
+            std::lock_guard<std::mutex> lock(meshedMutex);
+            meshed.swap(meshedChunks);
         }
-
-        // 2) Regenerate meshes for dirty chunks
-        for (Chunk* chunk : chunksToUpdate) {
-            {
-                //std::lock_guard<std::mutex> chunkLock(chunk->dataMutex); // Uncomment if needed
-                chunk->generateMeshData();
+        {
+            // Evicted while meshing -> already retired, uploading would leak its buffers
+            std::lock_guard<std::mutex> cacheLock(cacheMutex);
+            meshed.erase(std::remove_if(meshed.begin(), meshed.end(), [this](const std::shared_ptr<Chunk>& chunk) {
+                auto it = chunkCache.find(chunk->getPosition());
+                return it == chunkCache.end() || it->second.chunk != chunk;
+                }), meshed.end());
+        }
+        for (auto& chunk : meshed) {
+            if (!chunk->swapPendingMesh(&meshPool)) continue;
+            if (uploader) {
+                bool wasDrawable = chunk->hasGpuMesh();
+                uploader->upload(*chunk);
+                chunk->releaseCpuMeshes(&meshPool); // The GPU has it, edits patch through staging
+                if (chunk->hasGpuMesh() != wasDrawable) renderListDirty = true;
+            }
+            if (chunk->needsFullRemesh) {
+                chunk->needsFullRemesh = false;
+                requestRemesh(chunk->getPosition(), RemeshPriority::EDIT);
             }
-            chunk->uploadToGPU();
         }
 
-        // 3) GPU Upload on main thread
+        // 2) GPU Upload of freshly streamed chunks on main thread
         std::unique_lock<std::mutex> lock(queueMutex);
         while (!readyToUploadChunks.empty()) {
             auto chunk = std::move(readyToUploadChunks.front());
@@ -508,28 +777,113 @@ public:
             
             lock.unlock();
 
-            chunk->uploadToGPU();
+            // Already cached (generated twice) : keep the one that's linked and lit, the copy
+            // goes back to the pool without ever reaching the GPU
+            bool duplicate = false;
+            {
+                std::lock_guard<std::mutex> cacheLock(cacheMutex);
+                duplicate = chunkCache.find(chunk->getPosition()) != chunkCache.end();
+                if (duplicate) unlinkNeighbors(*chunk);
+            }
+            if (duplicate) {
+                glm::ivec3 position(chunk->getPosition());
+                {
+                    std::lock_guard<std::mutex> retiredLock(retiredMutex);
+                    retiredChunks.push_back(std::move(chunk));
+                }
+                lock.lock();
+                queuedChunkPositions.erase(position);
+                continue;
+            }
+
+            if (uploader) {
+                uploader->upload(*chunk);
+                chunk->releaseCpuMeshes(&meshPool);
+            }
 
+            bool hadPendingEdit = false;
             {
                 std::lock_guard<std::mutex> cacheLock(cacheMutex);
                 chunkCache[chunk->getPosition()] = { chunk };
+                renderListDirty = true;
+                setNeighborChunks(*chunk); // Its neighbours may have been evicted since it was meshed
                 updateExistingNeighborsForNewChunk(*chunk);
 
-                std::lock_guard<std::mutex> dirtyLock(dirtyChunksMutex);
-                auto pendingIt = pendingDirtyChunkPositions.find(chunk->getPosition());
-                if (pendingIt != pendingDirtyChunkPositions.end()) {
-                    dirtyChunks.insert(chunk.get());
-                    pendingDirtyChunkPositions.erase(pendingIt);
-                }
+                // Let light flow across the new walls, every chunk whose baked light changed gets remeshed
+                lightEngine.stitchNewChunk(*chunk);
+                lightEngine.propagate();
+                flushLightRemeshes(RemeshPriority::NEIGHBOUR);
+
+                std::lock_guard<std::mutex> remeshLock(remeshMutex);
+                hadPendingEdit = pendingDirtyChunkPositions.erase(chunk->getPosition()) > 0;
             }
+            if (hadPendingEdit) requestRemesh(chunk->getPosition(), RemeshPriority::NEIGHBOUR);
 
             lock.lock();
+            queuedChunkPositions.erase(glm::ivec3(chunk->getPosition())); // In the cache now, isChunkLoaded covers it
         }
+        lock.unlock();
 
-        // 4)
+        // 3)
         cleanupCache();
+
+        // 4) New render list if the drawable set changed (drops the evicted chunks before 5)
+        publishRenderList();
+
+        // 5) Recycle evicted chunks. One still held by a remesh worker (or an old render list) waits for the next frame
+        std::vector<std::shared_ptr<Chunk>> retired;
+        {
+            std::lock_guard<std::mutex> retiredLock(retiredMutex);
+            retired.swap(retiredChunks);
+        }
+        std::vector<std::shared_ptr<Chunk>> stillUsed;
+        for (auto& chunk : retired) {
+            if (chunk.use_count() > 1) stillUsed.push_back(std::move(chunk));
+            else chunkPool.recycle(std::move(chunk), uploader);
+        }
+        if (!stillUsed.empty()) {
+            std::lock_guard<std::mutex> retiredLock(retiredMutex);
+            retiredChunks.insert(retiredChunks.end(), stillUsed.begin(), stillUsed.end());
+        }
+    }
+
+    // Any thread : the current render list, one atomic load and no copy of the cache. The list
+    // stays valid (and its chunks alive) for as long as the caller holds it
+    std::shared_ptr<const RenderList> getRenderList() const {
+        return std::atomic_load(&renderList);
+    }
+
+    // Main thread : rebuilds and swaps in the render list, nothing to do if the set didn't change
+    void publishRenderList() {
+        if (!renderListDirty.exchange(false)) return;
+
+        auto list = std::make_shared<RenderList>();
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            list->handles.reserve(chunkCache.size());
+            list->chunks.reserve(chunkCache.size());
+            for (const auto& entry : chunkCache) {
+                const std::shared_ptr<Chunk>& chunk = entry.second.chunk;
+                if (!chunk || !chunk->isActive()) continue;
+                if (uploader && !chunk->hasGpuMesh()) continue; // Headless : every cached chunk
+                list->handles.push_back(chunk);
+                list->chunks.push_back(chunk.get());
+            }
+        }
+        list->version = ++renderListVersion;
+        std::atomic_store(&renderList, std::shared_ptr<const RenderList>(std::move(list)));
     }
 
+    // Forces a rebuild on the next publish (headless tools poking chunkCache directly)
+    void invalidateRenderList() { renderListDirty = true; }
+
+    // Main thread (frees the GL side of the chunks over the mark)
+    void setChunkPoolHighWaterMark(size_t mark) {
+        chunkPool.setHighWaterMark(mark, uploader);
+    }
+
+    ChunkPool::Stats getChunkPoolStats() const { return chunkPool.getStats(); }
+
     glm::ivec2 worldToChunkCoords(const glm::vec3& worldPos) {
         return glm::ivec2(
             static_cast<int>(std::floor(worldPos.x / CHUNK_SIZE)),
@@ -684,8 +1038,9 @@ public:
         }
 
         // Third pass: *Decorationsss*
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        // Seeded per chunk so a chunk always regrows the same trees/grass (and runs are reproducible)
+        std::seed_seq chunkSeed{ seed, static_cast<unsigned int>(chunkPos.x), static_cast<unsigned int>(chunkPos.z) };
+        std::mt19937 gen(chunkSeed);
         std::uniform_real_distribution<> dis(0.0, 1.0);
 
         for (int x = 0; x < CHUNK_SIZE; ++x) {
@@ -879,9 +1234,8 @@ public:
                 Chunk* neighbor = it->second.chunk.get();
                 neighbor->neighbors[oppositeIndex[i]] = &newChunk;
 
-               
-                std::lock_guard<std::mutex> dirtyLock(dirtyChunksMutex);  // This gets marked dirty
-                dirtyChunks.insert(neighbor);
+
+                requestRemesh(neighborPos, RemeshPriority::NEIGHBOUR);  // Its wall facing us is stale now
             }
         }
     }
@@ -921,7 +1275,7 @@ public:
                         localBlockPos.z >= 0 && localBlockPos.z < CHUNK_SIZE &&
                         localBlockPos.y >= 0 && localBlockPos.y < CHUNK_DEPTH) {
 
-                        Block& block = chunk.getBlockAtLocalPos(localBlockPos);
+                        Block block = chunk.getBlockAtLocalPos(localBlockPos);
                         if (block.getType() != Block::Type::AIR) {
                             result.hit = true;
                             result.blockPos = worldBlockPos;
@@ -942,11 +1296,84 @@ public:
         }
     };
 
+    // Synchronous path for headless tools (benchmarks) : puts an already generated chunk in
+    // the cache and links it with its neighbours, same as the main thread does after an upload
+    void insertChunk(const std::shared_ptr<Chunk>& chunk) {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        auto existing = chunkCache.find(chunk->getPosition());
+        if (existing != chunkCache.end() && existing->second.chunk != chunk) {
+            // Replaced : the old one is retired like an evicted chunk (GPU ranges + pool)
+            unlinkNeighbors(*existing->second.chunk);
+            std::lock_guard<std::mutex> retiredLock(retiredMutex);
+            retiredChunks.push_back(existing->second.chunk);
+        }
+        chunkCache[chunk->getPosition()] = { chunk };
+        renderListDirty = true;
+        setNeighborChunks(*chunk);
+        updateExistingNeighborsForNewChunk(*chunk);
+
+        lightEngine.stitchNewChunk(*chunk);
+        lightEngine.propagate();
+        flushLightRemeshes(RemeshPriority::NEIGHBOUR);
+    }
+
+    // Player edit : sets the block, relights around it and queues the remeshes (main thread)
+    void editBlock(const glm::ivec3& worldPos, Block::Type type) {
+        if (worldPos.y < -BASE_GROUND_HEIGHT || worldPos.y >= (CHUNK_DEPTH - BASE_GROUND_HEIGHT)) {
+            return;
+        }
+
+        int chunkX = static_cast<int>(std::floor(worldPos.x / static_cast<float>(CHUNK_SIZE))) * CHUNK_SIZE;
+        int chunkZ = static_cast<int>(std::floor(worldPos.z / static_cast<float>(CHUNK_SIZE))) * CHUNK_SIZE;
+        glm::ivec3 chunkPos(chunkX, -BASE_GROUND_HEIGHT, chunkZ);
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = chunkCache.find(chunkPos);
+        if (it == chunkCache.end()) {
+            return;
+        }
+
+        Chunk& chunk = *it->second.chunk;
+        glm::ivec3 localPos = worldPos - chunkPos;
+        Block::Type oldType = chunk.getBlockType(localPos.x, localPos.z, localPos.y);
+        if (oldType == type) return;
+
+        {
+            // Remesh workers read this block while meshing this chunk or a neighbour (across the
+            // wall), each holding only the dataMutex of the chunk it meshes. Holding all of them
+            // keeps the write out of any mesh in progress (taken in address order, the only place
+            // locking more than one). The light is atomic bytes, see ChunkLight.h
+            std::array<std::mutex*, 5> mutexes = { &chunk.dataMutex, nullptr, nullptr, nullptr, nullptr };
+            for (int i = 0; i < 4; i++) {
+                if (chunk.neighbors[i]) mutexes[i + 1] = &chunk.neighbors[i]->dataMutex;
+            }
+            std::sort(mutexes.begin(), mutexes.end(), std::less<std::mutex*>());
+            std::array<std::unique_lock<std::mutex>, 5> dataLocks;
+            for (int i = 0; i < 5; i++) {
+                if (mutexes[i]) dataLocks[i] = std::unique_lock<std::mutex>(*mutexes[i]);
+            }
+            chunk.setBlockAtLocalPos(localPos, type);
+        }
+        lightEngine.onBlockChanged(chunk, localPos, oldType, type);
+        lightEngine.propagate();
+        flushLightRemeshes(RemeshPriority::EDIT);
+
+        markChunkAndNeighborsDirty(&chunk, localPos);
+    }
+
+    size_t getLightNodesProcessed() const { return lightEngine.getNodesProcessed(); }
+
     bool isChunkLoaded(const glm::ivec3& position) {
         std::lock_guard<std::mutex> lock(cacheMutex);
         return chunkCache.find(position) != chunkCache.end();
     }
 
+    // Generated and waiting for the main thread (readyToUploadChunks)
+    bool isChunkQueued(const glm::ivec3& position) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return queuedChunkPositions.count(position) > 0;
+    }
+
     std::vector<std::shared_ptr<Chunk>> getActiveChunks() {
         std::vector<std::shared_ptr<Chunk>> activeChunks;
         activeChunks.reserve(chunkCache.size()); // Pre-allocation
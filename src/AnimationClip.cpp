@@ -0,0 +1,158 @@
+#include "AnimationClip.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+ AnimationClip::AnimationClip(std::string name, float duration, float ticksPerSecond, std::vector<Bone> channels)
+    : name(std::move(name)), duration(duration), ticksPerSecond(ticksPerSecond), channels(std::move(channels)) {
+}
+
+ void AnimationClip::bind(const Skeleton& skeleton) {
+    nodeChannels.assign(skeleton.nodeCount(), -1);
+    for (size_t c = 0; c < channels.size(); c++) {
+        int node = skeleton.findNode(channels[c].GetBoneName());
+        if (node >= 0) nodeChannels[node] = static_cast<int>(c);
+    }
+}
+
+ void AnimationClip::samplePose(const Skeleton& skeleton, float time, Transform* pose) const {
+    const size_t nodes = skeleton.nodeCount();
+    for (size_t n = 0; n < nodes; n++) {
+        int channel = n < nodeChannels.size() ? nodeChannels[n] : -1;
+        if (channel < 0) {
+            pose[n] = skeleton.bindPose[n];
+            continue;
+        }
+        if (compiled.empty()) channels[channel].Sample(time, pose[n].translation, pose[n].rotation, pose[n].scale);
+        else sampleCompiled(channel, time, pose[n]);
+    }
+}
+
+namespace {
+    // Appends the samples of one track, or only the first one when the rest stays within tolerance
+    template <typename T, typename Distance>
+    uint32_t appendTrack(std::vector<T>& out, const std::vector<T>& samples, float tolerance, Distance distance) {
+        bool constant = true;
+        for (size_t i = 1; i < samples.size() && constant; i++)
+            constant = distance(samples[0], samples[i]) <= tolerance;
+        out.insert(out.end(), samples.begin(), constant ? samples.begin() + 1 : samples.end());
+        return constant ? 1u : static_cast<uint32_t>(samples.size());
+    }
+
+    float rotationAngle(const glm::quat& a, const glm::quat& b) {
+        float d = std::min(std::abs(glm::dot(a, b)), 1.0f);
+        return glm::degrees(2.0f * std::acos(d));
+    }
+}
+
+ ClipCompileReport AnimationClip::compile(const ClipCompileOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    ClipCompileReport report;
+    report.name = name;
+    report.channels = static_cast<int>(channels.size());
+    report.tracks = report.channels * 3;
+
+    compiled.clear();
+    translations.clear();
+    scales.clear();
+    rotations.clear();
+    packedRotations.clear();
+
+    // Frames land exactly on 0 and duration
+    float tps = ticksPerSecond > 0.0f ? ticksPerSecond : 25.0f;
+    frameCount = duration > 0.0f ? static_cast<int>(std::ceil(duration / tps * options.sampleRate)) + 1 : 1;
+    frameCount = std::max(frameCount, 2);
+    samplesPerTick = duration > 0.0f ? (frameCount - 1) / duration : 0.0f;
+    report.frames = frameCount;
+
+    std::vector<glm::vec3> trackT(frameCount), trackS(frameCount);
+    std::vector<glm::quat> trackR(frameCount);
+    auto vecDistance = [](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); };
+    // Rotation tolerance as an angle, in radians
+    auto quatDistance = [](const glm::quat& a, const glm::quat& b) { return glm::radians(rotationAngle(a, b)); };
+
+    compiled.reserve(channels.size());
+    for (const Bone& bone : channels) {
+        for (int f = 0; f < frameCount; f++) {
+            float time = samplesPerTick > 0.0f ? f / samplesPerTick : 0.0f;
+            bone.Sample(time, trackT[f], trackR[f], trackS[f]);
+            // Same hemisphere as the previous sample, so nlerp between two frames takes the short way
+            if (f > 0 && glm::dot(trackR[f - 1], trackR[f]) < 0.0f) trackR[f] = -trackR[f];
+        }
+        CompiledChannel channel;
+        channel.translation.first = static_cast<uint32_t>(translations.size());
+        channel.translation.count = appendTrack(translations, trackT, options.tolerance, vecDistance);
+        channel.rotation.first = static_cast<uint32_t>(rotations.size());
+        channel.rotation.count = appendTrack(rotations, trackR, options.tolerance, quatDistance);
+        channel.scale.first = static_cast<uint32_t>(scales.size());
+        channel.scale.count = appendTrack(scales, trackS, options.tolerance, vecDistance);
+        report.constantTracks += (channel.translation.count == 1) + (channel.rotation.count == 1) + (channel.scale.count == 1);
+        compiled.push_back(channel);
+
+        report.sourceKeys += bone.GetPositionKeys().size() + bone.GetRotationKeys().size() + bone.GetScaleKeys().size();
+        report.sourceBytes += bone.GetPositionKeys().size() * sizeof(KeyPosition)
+            + bone.GetRotationKeys().size() * sizeof(KeyRotation) + bone.GetScaleKeys().size() * sizeof(KeyScale);
+    }
+
+    if (options.quantizeRotations) {
+        packedRotations.reserve(rotations.size());
+        for (const glm::quat& q : rotations) {
+            glm::vec4 v = glm::clamp(glm::vec4(q.x, q.y, q.z, q.w), -1.0f, 1.0f) * 32767.0f;
+            packedRotations.push_back(glm::i16vec4(glm::round(v)));
+        }
+        rotations.clear();
+        rotations.shrink_to_fit();
+    }
+    translations.shrink_to_fit();
+    scales.shrink_to_fit();
+    rotations.shrink_to_fit();
+
+    report.compiledBytes = compiled.size() * sizeof(CompiledChannel)
+        + (translations.size() + scales.size()) * sizeof(glm::vec3)
+        + rotations.size() * sizeof(glm::quat) + packedRotations.size() * sizeof(glm::i16vec4);
+
+    // Accuracy : 4 points per frame interval, against the keys
+    const int steps = (frameCount - 1) * 4;
+    for (size_t c = 0; c < channels.size(); c++) {
+        for (int i = 0; i <= steps; i++) {
+            float time = duration * i / steps;
+            Transform source, resampled;
+            channels[c].Sample(time, source.translation, source.rotation, source.scale);
+            sampleCompiled(static_cast<int>(c), time, resampled);
+            report.maxTranslationError = std::max(report.maxTranslationError, glm::length(source.translation - resampled.translation));
+            report.maxRotationError = std::max(report.maxRotationError, rotationAngle(source.rotation, resampled.rotation));
+            report.maxScaleError = std::max(report.maxScaleError, glm::length(source.scale - resampled.scale));
+        }
+    }
+
+    report.compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+ glm::quat AnimationClip::rotationAt(uint32_t index) const {
+    if (packedRotations.empty()) return rotations[index];
+    glm::vec4 v = glm::vec4(packedRotations[index]) * (1.0f / 32767.0f);
+    return glm::quat(v.w, v.x, v.y, v.z);
+}
+
+ void AnimationClip::sampleCompiled(int channel, float time, Transform& transform) const {
+    const CompiledChannel& tracks = compiled[channel];
+    float frame = std::min(std::max(time * samplesPerTick, 0.0f), static_cast<float>(frameCount - 1));
+    int f0 = std::min(static_cast<int>(frame), frameCount - 2);
+    float alpha = frame - f0;
+
+    if (tracks.translation.count == 1) transform.translation = translations[tracks.translation.first];
+    else transform.translation = glm::mix(translations[tracks.translation.first + f0], translations[tracks.translation.first + f0 + 1], alpha);
+
+    if (tracks.scale.count == 1) transform.scale = scales[tracks.scale.first];
+    else transform.scale = glm::mix(scales[tracks.scale.first + f0], scales[tracks.scale.first + f0 + 1], alpha);
+
+    if (tracks.rotation.count == 1) {
+        transform.rotation = glm::normalize(rotationAt(tracks.rotation.first));
+    } else {
+        // nlerp, the samples were put on the same hemisphere by compile()
+        glm::quat a = rotationAt(tracks.rotation.first + f0);
+        glm::quat b = rotationAt(tracks.rotation.first + f0 + 1);
+        transform.rotation = glm::normalize(a * (1.0f - alpha) + b * alpha);
+    }
+}
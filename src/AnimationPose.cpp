@@ -0,0 +1,95 @@
+#include "AnimationPose.h"
+#include "AnimationClip.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+ glm::mat4 Transform::toMat4() const {
+    // translate * rotate * scale, written out instead of three matrix products
+    glm::mat3 rotationScale = glm::mat3_cast(rotation);
+    glm::mat4 result(1.0f);
+    result[0] = glm::vec4(rotationScale[0] * scale.x, 0.0f);
+    result[1] = glm::vec4(rotationScale[1] * scale.y, 0.0f);
+    result[2] = glm::vec4(rotationScale[2] * scale.z, 0.0f);
+    result[3] = glm::vec4(translation, 1.0f);
+    return result;
+}
+
+ Transform Transform::fromMat4(const glm::mat4& matrix) {
+    Transform result;
+    glm::vec3 skew;
+    glm::vec4 perspective;
+    glm::decompose(matrix, result.scale, result.rotation, result.translation, skew, perspective);
+    return result;
+}
+
+ int Skeleton::addNode(const std::string& name, int parent, const glm::mat4& transformation) {
+    names.push_back(name);
+    parents.push_back(parent);
+    bindPose.push_back(Transform::fromMat4(transformation));
+    boneIndex.push_back(-1);
+    offsets.push_back(glm::mat4(1.0f));
+    return static_cast<int>(parents.size()) - 1;
+}
+
+ int Skeleton::findNode(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); i++)
+        if (names[i] == name) return static_cast<int>(i);
+    return -1;
+}
+
+ void PoseEvaluator::evaluate(const Skeleton& skeleton, const PoseLayer* layers, int layerCount, glm::mat4* palette) {
+    const size_t nodes = skeleton.nodeCount();
+    // Grows on the first call (or a new highest layer count), reused after that
+    if (layerPoses.size() < static_cast<size_t>(layerCount)) layerPoses.resize(layerCount);
+    for (int l = 0; l < layerCount; l++)
+        if (layerPoses[l].size() != nodes) layerPoses[l].resize(nodes);
+    if (blended.size() != nodes) blended.resize(nodes);
+    if (globals.size() != nodes) globals.resize(nodes);
+
+    // 1) Sample every layer
+    int used = 0;
+    for (int l = 0; l < layerCount; l++) {
+        if (!layers[l].clip || layers[l].weight <= 0.0f) continue;
+        layers[l].clip->samplePose(skeleton, layers[l].time, layerPoses[l].data());
+        used++;
+    }
+    if (used == 0) {
+        for (size_t n = 0; n < nodes; n++) blended[n] = skeleton.bindPose[n];
+    }
+    else {
+        // 2) Blend in TRS space
+        for (size_t n = 0; n < nodes; n++) {
+            glm::vec3 translation(0.0f), scale(0.0f);
+            glm::quat rotation(0.0f, 0.0f, 0.0f, 0.0f);
+            glm::quat reference;
+            bool first = true;
+            for (int l = 0; l < layerCount; l++) {
+                float w = layers[l].weight;
+                if (!layers[l].clip || w <= 0.0f) continue;
+                const Transform& local = layerPoses[l][n];
+                glm::quat q = local.rotation;
+                if (first) reference = q;
+                else if (glm::dot(reference, q) < 0.0f) q = -q; // Same hemisphere, or the blend takes the long way
+                first = false;
+                translation += local.translation * w;
+                scale += local.scale * w;
+                rotation.x += q.x * w;
+                rotation.y += q.y * w;
+                rotation.z += q.z * w;
+                rotation.w += q.w * w;
+            }
+            blended[n].translation = translation;
+            blended[n].scale = scale;
+            blended[n].rotation = glm::normalize(rotation);
+        }
+    }
+
+    // 3) Globals (parents come first) + palette
+    for (size_t n = 0; n < nodes; n++) {
+        glm::mat4 local = blended[n].toMat4();
+        int parent = skeleton.parents[n];
+        globals[n] = parent >= 0 ? globals[parent] * local : local;
+        int bone = skeleton.boneIndex[n];
+        if (bone >= 0) palette[bone] = globals[n] * skeleton.offsets[n];
+    }
+}
@@ -0,0 +1,138 @@
+#include "AnimationScheduler.h"
+#include "AnimationClip.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+ AnimationScheduler::AnimationScheduler(unsigned int threadCount) : pool(threadCount) {
+    evaluators.resize(pool.getThreadCount() + 1);
+}
+
+ int AnimationScheduler::add(const Skeleton& skeleton) {
+    Instance instance{};
+    instance.skeleton = &skeleton;
+    instance.paletteOffset = palettes.size();
+    instance.evaluated = false;
+    palettes.resize(palettes.size() + skeleton.boneCount, glm::mat4(1.0f));
+    instances.push_back(instance);
+    return static_cast<int>(instances.size()) - 1;
+}
+
+ void AnimationScheduler::setLayers(int instance, const PoseLayer* layers, int layerCount) {
+    Instance& target = instances[instance];
+    target.layerCount = std::min(layerCount, MAX_LAYERS);
+    std::copy(layers, layers + target.layerCount, target.layers);
+}
+
+ void AnimationScheduler::setPosition(int instance, const glm::vec3& position) {
+    instances[instance].position = position;
+}
+
+ int AnimationScheduler::intervalFor(float distance) const {
+    for (const AnimationLod& lod : lods)
+        if (distance < lod.distance) return std::max(lod.interval, 1);
+    return lods.empty() ? 1 : std::max(lods.back().interval, 1);
+}
+
+ void AnimationScheduler::makeKey(Instance& instance) {
+    PoseKey& key = instance.key;
+    std::memset(&key, 0, sizeof(key));
+    key.skeleton = instance.skeleton;
+    key.layerCount = instance.layerCount;
+
+    // Weights to 1/256, then normalized again so the snapped layers still sum to 1
+    int weightSum = 0;
+    for (int l = 0; l < instance.layerCount; l++) {
+        key.weights[l] = static_cast<int32_t>(std::lround(instance.layers[l].weight * 256.0f));
+        weightSum += key.weights[l];
+    }
+    for (int l = 0; l < instance.layerCount; l++) {
+        const PoseLayer& layer = instance.layers[l];
+        float ticksPerSecond = layer.clip->getTicksPerSecond() > 0.0f ? layer.clip->getTicksPerSecond() : 25.0f;
+        float bucketTicks = shareBucket * ticksPerSecond;
+        key.clips[l] = layer.clip;
+        key.buckets[l] = static_cast<int32_t>(std::floor(layer.time / bucketTicks));
+        // Everyone in the bucket is evaluated at its middle, so the owner doesn't matter
+        instance.snapped[l].clip = layer.clip;
+        instance.snapped[l].time = (key.buckets[l] + 0.5f) * bucketTicks;
+        instance.snapped[l].weight = weightSum > 0 ? static_cast<float>(key.weights[l]) / weightSum : layer.weight;
+    }
+}
+
+ void AnimationScheduler::evaluate(const int* owners, size_t count, PoseEvaluator& evaluator) {
+    for (size_t i = 0; i < count; i++) {
+        Instance& instance = instances[owners[i]];
+        evaluator.evaluate(*instance.skeleton, instance.snapped, instance.layerCount, palettes.data() + instance.paletteOffset);
+        instance.evaluated = true;
+    }
+}
+
+ void AnimationScheduler::update(const glm::vec3& camera) {
+    auto start = std::chrono::steady_clock::now();
+    frame++;
+    lastStats = AnimationSchedulerStats();
+    lastStats.instances = static_cast<int>(instances.size());
+    lastStats.threads = pool.getThreadCount();
+
+    // LOD : who gets a new pose this update
+    due.clear();
+    for (size_t i = 0; i < instances.size(); i++) {
+        const Instance& instance = instances[i];
+        int interval = intervalFor(glm::distance(instance.position, camera));
+        if (instance.layerCount > 0 && (!instance.evaluated || (frame + i) % interval == 0)) due.push_back(static_cast<int>(i));
+        else lastStats.skipped++;
+    }
+
+    // Sharing : sorted by key, the first of every run of equal keys is evaluated, the rest copy it
+    owners.clear();
+    copies.clear();
+    if (shareBucket > 0.0f) {
+        for (int i : due) makeKey(instances[i]);
+        std::sort(due.begin(), due.end(), [this](int a, int b) {
+            return std::memcmp(&instances[a].key, &instances[b].key, sizeof(PoseKey)) < 0;
+        });
+        for (int i : due) {
+            if (!owners.empty() && std::memcmp(&instances[owners.back()].key, &instances[i].key, sizeof(PoseKey)) == 0)
+                copies.push_back({ i, owners.back() });
+            else
+                owners.push_back(i);
+        }
+    }
+    else {
+        for (int i : due) {
+            Instance& instance = instances[i];
+            std::copy(instance.layers, instance.layers + instance.layerCount, instance.snapped);
+        }
+        owners = due;
+    }
+
+    // Chunks on the pool, the caller takes the first one
+    size_t chunkCount = std::min(evaluators.size(), owners.size() / std::max(minChunk, 1));
+    if (chunkCount <= 1) {
+        evaluate(owners.data(), owners.size(), evaluators[0]);
+    }
+    else {
+        size_t perChunk = (owners.size() + chunkCount - 1) / chunkCount;
+        for (size_t c = 1; c < chunkCount; c++) {
+            size_t begin = c * perChunk;
+            size_t count = std::min(perChunk, owners.size() - std::min(begin, owners.size()));
+            if (count == 0) break;
+            pool.submit([this, begin, count, c] { evaluate(owners.data() + begin, count, evaluators[c]); });
+        }
+        evaluate(owners.data(), std::min(perChunk, owners.size()), evaluators[0]);
+        pool.waitIdle();
+    }
+
+    for (const std::pair<int, int>& copy : copies) {
+        Instance& instance = instances[copy.first];
+        const Instance& owner = instances[copy.second];
+        std::copy(palettes.begin() + owner.paletteOffset, palettes.begin() + owner.paletteOffset + owner.skeleton->boneCount,
+            palettes.begin() + instance.paletteOffset);
+        instance.evaluated = true;
+    }
+
+    lastStats.evaluated = static_cast<int>(owners.size());
+    lastStats.shared = static_cast<int>(copies.size());
+    lastStats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -4,6 +4,31 @@
     return type == Type::AIR || type == Type::WATER || type == Type::LAVA;
 }
 
+bool Block::castsAmbientOcclusion(Type blockType) {
+    if (blockType == Type::AIR || blockType == Type::WATER) return false;
+    return determineGeometryType(blockType) == GeometryType::BOX;
+}
+
+bool Block::blocksLight(Type blockType) {
+    if (blockType == Type::AIR || blockType == Type::WATER) return false;
+    return determineGeometryType(blockType) == GeometryType::BOX;
+}
+
+uint8_t Block::lightEmission(Type blockType) {
+    return blockType == Type::LAVA ? 15 : 0;
+}
+
+bool Block::occludesView(Type blockType) {
+    switch (blockType) {
+    case Type::LEAVES:
+    case Type::ACACIA_LEAVES:
+    case Type::CHERRY_BLOSSOM_LEAVES:
+        return false;
+    default:
+        return blocksLight(blockType);
+    }
+}
+
 Block::GeometryType Block::determineGeometryType(Type blockType) {
     switch (blockType) {
     case Type::WILD_GRASS:
@@ -1,5 +1,181 @@
 #include "Chunk.h"
+#include "MeshBufferPool.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+
+// Slack given to a section so most edits fit in place (in faces). An empty section right next to
+// a non empty one keeps room for a couple of blocks (building above the terrain always starts
+// there), the ones further away get none
+static const unsigned int EMPTY_SECTION_FACES = 16;
+static unsigned int sectionFaceCapacity(const std::array<SectionMesh, CHUNK_SECTION_COUNT>& src, int section) {
+    auto faces = [&src](int s) { return static_cast<unsigned int>(src[s].indices.size() / 6); };
+    if (faces(section) > 0) return faces(section) + faces(section) / 4 + 16;
+    bool nextToFaces = (section > 0 && faces(section - 1) > 0) || (section < CHUNK_SECTION_COUNT - 1 && faces(section + 1) > 0);
+    return nextToFaces ? EMPTY_SECTION_FACES : 0;
+}
+
+ unsigned int MeshData::usedVertexCount() const {
+    unsigned int count = 0;
+    for (const auto& range : sections) count += range.vertexCount;
+    return count;
+}
+
+ unsigned int MeshData::usedIndexCount() const {
+    unsigned int count = 0;
+    for (const auto& range : sections) count += range.indexCount;
+    return count;
+}
+
+ void MeshData::clear() {
+    vertices.clear();
+    indices.clear();
+    vertexcount = 0;
+    indexcount = 0;
+    sections = {};
+    dirtySections = 0;
+    layoutChanged = true;
+    released = false;
+    staged = {};
+}
+
+ void MeshData::allocateFor(const std::array<SectionMesh, CHUNK_SECTION_COUNT>& src, MeshBufferPool* pool) {
+    size_t vertexTotal = 0, indexTotal = 0;
+    for (int section = 0; section < CHUNK_SECTION_COUNT; section++) {
+        unsigned int faceCapacity = sectionFaceCapacity(src, section);
+        vertexTotal += faceCapacity * 4;
+        indexTotal += faceCapacity * 6;
+    }
+
+    if (pool) {
+        pool->recycle(std::move(vertices));
+        pool->recycle(std::move(indices));
+        vertices = pool->acquireVertices(vertexTotal);
+        indices = pool->acquireIndices(indexTotal);
+    }
+    else {
+        std::vector<CompactVertex>().swap(vertices);
+        std::vector<uint32_t>().swap(indices);
+        vertices.reserve(vertexTotal);
+        indices.reserve(indexTotal);
+    }
+}
+
+ void MeshData::appendSection(int section, const std::array<SectionMesh, CHUNK_SECTION_COUNT>& chunkSections) {
+    const SectionMesh& src = chunkSections[section];
+    unsigned int faceCapacity = sectionFaceCapacity(chunkSections, section);
+
+    MeshRange& range = sections[section];
+    range.firstVertex = static_cast<unsigned int>(vertices.size());
+    range.vertexCount = static_cast<unsigned int>(src.vertices.size());
+    range.vertexCapacity = faceCapacity * 4;
+    range.firstIndex = static_cast<unsigned int>(indices.size());
+    range.indexCount = static_cast<unsigned int>(src.indices.size());
+    range.indexCapacity = faceCapacity * 6;
+    range.minY = src.minY;
+    range.maxY = src.maxY;
+    range.visibility = src.visibility;
+    range.opaque = src.opaque;
+
+    vertices.insert(vertices.end(), src.vertices.begin(), src.vertices.end());
+    vertices.resize(range.firstVertex + range.vertexCapacity);
+
+    for (uint32_t index : src.indices) indices.push_back(range.firstVertex + index);
+    indices.resize(range.firstIndex + range.indexCapacity, range.firstVertex); // Degenerate triangles
+
+    vertexcount = static_cast<unsigned int>(vertices.size());
+    indexcount = static_cast<unsigned int>(indices.size());
+}
+
+ bool MeshData::patchSection(int section, const SectionMesh& src) {
+    MeshRange& range = sections[section];
+    if (src.vertices.size() > range.vertexCapacity || src.indices.size() > range.indexCapacity) return false;
+
+    if (released) {
+        // No CPU copy to write into, stage the section (its whole index slot) for the next upload
+        StagedSection& stage = staged[section];
+        stage.vertexOffset = static_cast<unsigned int>(vertices.size());
+        stage.indexOffset = static_cast<unsigned int>(indices.size());
+        vertices.insert(vertices.end(), src.vertices.begin(), src.vertices.end());
+        for (uint32_t index : src.indices) indices.push_back(range.firstVertex + index);
+        indices.resize(stage.indexOffset + range.indexCapacity, range.firstVertex);
+    }
+    else {
+        std::copy(src.vertices.begin(), src.vertices.end(), vertices.begin() + range.firstVertex);
+
+        auto slot = indices.begin() + range.firstIndex;
+        for (size_t i = 0; i < src.indices.size(); i++) slot[i] = range.firstVertex + src.indices[i];
+        std::fill(slot + src.indices.size(), slot + range.indexCapacity, range.firstVertex);
+    }
+
+    range.vertexCount = static_cast<unsigned int>(src.vertices.size());
+    range.indexCount = static_cast<unsigned int>(src.indices.size());
+    range.minY = src.minY;
+    range.maxY = src.maxY;
+    range.visibility = src.visibility;
+    range.opaque = src.opaque;
+    dirtySections |= 1u << section;
+    return true;
+}
 
+ void MeshData::relayoutWithSection(int section, const SectionMesh& src) {
+    std::array<SectionMesh, CHUNK_SECTION_COUNT> current;
+    for (int i = 0; i < CHUNK_SECTION_COUNT; i++) {
+        if (i == section) {
+            current[i] = src;
+            continue;
+        }
+        const MeshRange& range = sections[i];
+        current[i].vertices.assign(vertices.begin() + range.firstVertex, vertices.begin() + range.firstVertex + range.vertexCount);
+        current[i].indices.reserve(range.indexCount);
+        current[i].minY = range.minY;
+        current[i].maxY = range.maxY;
+        current[i].visibility = range.visibility;
+        current[i].opaque = range.opaque;
+        for (unsigned int j = 0; j < range.indexCount; j++) {
+            current[i].indices.push_back(indices[range.firstIndex + j] - range.firstVertex);
+        }
+    }
+
+    clear();
+    for (int i = 0; i < CHUNK_SECTION_COUNT; i++) {
+        appendSection(i, current);
+    }
+}
+
+ const CompactVertex* MeshData::sectionVertices(int section) const {
+    return vertices.data() + (released ? staged[section].vertexOffset : sections[section].firstVertex);
+}
+
+ const uint32_t* MeshData::sectionIndices(int section) const {
+    return indices.data() + (released ? staged[section].indexOffset : sections[section].firstIndex);
+}
+
+ void MeshData::releaseCpuCopy(MeshBufferPool* pool) {
+    if (dirtySections != 0) return; // Patched sections the GPU doesn't have yet, they're uploaded from here
+    dropCpuCopy(pool);
+}
+
+ void MeshData::dropCpuCopy(MeshBufferPool* pool) {
+    if (pool) {
+        pool->recycle(std::move(vertices));
+        pool->recycle(std::move(indices));
+    }
+    std::vector<CompactVertex>().swap(vertices);
+    std::vector<uint32_t>().swap(indices);
+    released = true;
+    staged = {};
+}
+
+ void MeshData::release(MeshBufferPool* pool) {
+    dropCpuCopy(pool);
+    clear();
+}
+
+ size_t MeshData::cpuBytes() const {
+    return vertices.capacity() * sizeof(CompactVertex) + indices.capacity() * sizeof(uint32_t);
+}
 
 // float to 16-bit unsigned normalized //
 
@@ -29,52 +205,33 @@
     return a;
 }
 
- void Chunk::freeGLResources() {
-    if (SolidBuffers.buffers_Initialised) {
-        SolidBuffers.vao.Delete();
-        SolidBuffers.vbo.Delete();
-        SolidBuffers.ebo.Delete();
-        SolidBuffers.buffers_Initialised = false;
-    }
-
-    if (LiquidBuffers.buffers_Initialised) {
-        LiquidBuffers.vao.Delete();
-        LiquidBuffers.vbo.Delete();
-        LiquidBuffers.ebo.Delete();
-        LiquidBuffers.buffers_Initialised = false;
-    }
-}
-
  void Chunk::reset() {
     std::lock_guard<std::mutex> lock(dataMutex);
-    SolidMesh.vertices.clear();
-    SolidMesh.indices.clear();
-    SolidMesh.vertexcount = 0;
-    SolidMesh.indexcount = 0;
+    SolidMesh.clear();
     SolidBuffers.needsUpload = false;
 
-    LiquidMesh.vertices.clear();
-    LiquidMesh.indices.clear();
-    LiquidMesh.vertexcount = 0;
-    LiquidMesh.indexcount = 0;
+    LiquidMesh.clear();
     LiquidBuffers.needsUpload = false;
 
-    freeGLResources();
-}
-
- bool Chunk::isValid() const {
-    bool solidValid = SolidBuffers.buffers_Initialised &&
-        glIsVertexArray(SolidBuffers.vao.ID) &&
-        glIsBuffer(SolidBuffers.vbo.ID) &&
-        glIsBuffer(SolidBuffers.ebo.ID);
+    occluders = OccluderColumns{};
 
-    bool liquidValid = LiquidBuffers.buffers_Initialised &&
-        glIsVertexArray(LiquidBuffers.vao.ID) &&
-        glIsBuffer(LiquidBuffers.vbo.ID) &&
-        glIsBuffer(LiquidBuffers.ebo.ID);
+    std::lock_guard<std::mutex> swapLock(meshSwapMutex);
+    hasPendingFullMesh = false;
+    PendingSections.clear();
+    hasPendingOccluders = false;
+    hasPendingMesh = false;
+}
 
-    // Consider valid if either buffer system is valid
-    return solidValid || liquidValid;
+ void Chunk::recycle(const glm::ivec3& pos) {
+    reset();
+    PendingSolidMesh.release(nullptr);
+    PendingLiquidMesh.release(nullptr);
+    position = pos;
+    active = true;
+    needsFullRemesh = false;
+    std::fill(blocks.begin(), blocks.end(), Block::Type::AIR);
+    light.clear();
+    neighbors = { nullptr, nullptr, nullptr, nullptr };
 }
 
 // Convert 3D position to flat array index //
@@ -101,24 +258,193 @@
     return Block::Type::AIR;
 }
 
- void Chunk::generateMeshData() {
+ void Chunk::generateMeshData(MeshBufferPool* pool) {
     std::lock_guard<std::mutex> lock(dataMutex); // Lock this chunk's data
-    SolidMesh.vertices.clear();
-    SolidMesh.indices.clear();
-    SolidMesh.vertexcount = 0;
-    SolidMesh.indexcount = 0;
+    buildMeshData(SolidMesh, LiquidMesh, pool);
+    buildOccluderColumns(occluders);
+
+    //needsGPUUpload = true;
+    SolidBuffers.needsUpload = true;
+    LiquidBuffers.needsUpload = true;
+}
+
+ void Chunk::generatePendingMeshData(MeshBufferPool* pool) {
+    MeshData solid;
+    MeshData liquid;
+    OccluderColumns columns;
+    {
+        // Publishing while still holding dataMutex keeps the publish order == build order,
+        // so the last mesh swapped in always saw the latest block edits
+        std::lock_guard<std::mutex> lock(dataMutex);
+        buildMeshData(solid, liquid, pool);
+        buildOccluderColumns(columns);
+
+        std::lock_guard<std::mutex> swapLock(meshSwapMutex);
+        std::swap(PendingSolidMesh, solid);
+        std::swap(PendingLiquidMesh, liquid);
+        PendingOccluders = columns;
+        hasPendingOccluders = true;
+        hasPendingFullMesh = true;
+        PendingSections.clear(); // The full mesh already has them
+        hasPendingMesh = true;
+    }
+
+    // Back buffers nobody swapped in (or the front meshes of the last swap)
+    solid.release(pool);
+    liquid.release(pool);
+}
+
+ void Chunk::generatePendingSections(uint32_t sectionMask, SectionMesh& solidScratch, SectionMesh& liquidScratch) {
+    std::lock_guard<std::mutex> lock(dataMutex);
+    if (sectionMask) {
+        OccluderColumns columns;
+        buildOccluderColumns(columns);
+        std::lock_guard<std::mutex> swapLock(meshSwapMutex);
+        PendingOccluders = columns;
+        hasPendingOccluders = true;
+    }
+    for (int section = 0; section < CHUNK_SECTION_COUNT; section++) {
+        if (!(sectionMask & (1u << section))) continue;
+        buildSection(section, solidScratch, liquidScratch);
+
+        std::lock_guard<std::mutex> swapLock(meshSwapMutex);
+        if (hasPendingFullMesh) {
+            // A full mesh is still waiting for the main thread, patch that one directly
+            if (!PendingSolidMesh.patchSection(section, solidScratch)) PendingSolidMesh.relayoutWithSection(section, solidScratch);
+            if (!PendingLiquidMesh.patchSection(section, liquidScratch)) PendingLiquidMesh.relayoutWithSection(section, liquidScratch);
+        }
+        else {
+            PendingSections.push_back({ section, solidScratch, liquidScratch });
+        }
+        hasPendingMesh = true;
+    }
+}
+
+ uint32_t Chunk::sectionsTouchedBy(const glm::ivec3& localPos) {
+    int y = std::clamp(localPos.y, 0, CHUNK_DEPTH - 1);
+    int section = y / CHUNK_SECTION_SIZE;
+    uint32_t mask = 1u << section;
+
+    // The faces of the blocks right above/below live in the next section over
+    if (y % CHUNK_SECTION_SIZE == 0 && section > 0) mask |= 1u << (section - 1);
+    if (y % CHUNK_SECTION_SIZE == CHUNK_SECTION_SIZE - 1 && section < CHUNK_SECTION_COUNT - 1) mask |= 1u << (section + 1);
+    return mask;
+}
 
-    LiquidMesh.vertices.clear();
-    LiquidMesh.indices.clear();
-    LiquidMesh.vertexcount = 0;
-    LiquidMesh.indexcount = 0;
+ bool Chunk::swapPendingMesh(MeshBufferPool* pool) {
+    if (!hasPendingMesh) return false;
+
+    std::lock_guard<std::mutex> swapLock(meshSwapMutex);
+    if (hasPendingFullMesh) {
+        std::swap(SolidMesh, PendingSolidMesh);
+        std::swap(LiquidMesh, PendingLiquidMesh);
+        PendingSolidMesh.release(pool);
+        PendingLiquidMesh.release(pool);
+        hasPendingFullMesh = false;
+    }
+
+    // A released mesh can't be re-laid out (the other sections only exist on the GPU)
+    auto applyPatch = [this](MeshData& mesh, int section, const SectionMesh& src) {
+        if (mesh.patchSection(section, src)) return;
+        if (mesh.released) needsFullRemesh = true;
+        else mesh.relayoutWithSection(section, src);
+    };
+    for (const auto& patch : PendingSections) {
+        applyPatch(SolidMesh, patch.section, patch.solid);
+        applyPatch(LiquidMesh, patch.section, patch.liquid);
+    }
+    PendingSections.clear();
+    if (hasPendingOccluders) {
+        occluders = PendingOccluders;
+        hasPendingOccluders = false;
+    }
+    hasPendingMesh = false;
+
+    SolidBuffers.needsUpload = true;
+    LiquidBuffers.needsUpload = true;
+    return true;
+}
+
+ void Chunk::releaseCpuMeshes(MeshBufferPool* pool) {
+    SolidMesh.releaseCpuCopy(pool);
+    LiquidMesh.releaseCpuCopy(pool);
+}
+
+ void Chunk::buildMeshData(MeshData& solid, MeshData& liquid, MeshBufferPool* pool) {
+    // Per thread scratch owned by whoever meshes (streaming thread, remesh workers). Every section
+    // is built first so the chunk mesh can be allocated at its final size in one go
+    thread_local std::array<SectionMesh, CHUNK_SECTION_COUNT> solidSections;
+    thread_local std::array<SectionMesh, CHUNK_SECTION_COUNT> liquidSections;
+
+    for (int section = 0; section < CHUNK_SECTION_COUNT; section++) {
+        buildSection(section, solidSections[section], liquidSections[section]);
+    }
+
+    solid.clear();
+    liquid.clear();
+    solid.allocateFor(solidSections, pool);
+    liquid.allocateFor(liquidSections, pool);
+    for (int section = 0; section < CHUNK_SECTION_COUNT; section++) {
+        solid.appendSection(section, solidSections);
+        liquid.appendSection(section, liquidSections);
+    }
+}
+
+ void Chunk::buildOccluderColumns(OccluderColumns& columns) const {
+    // Topmost run of view blocking blocks at least this thick counts as the ground of a column
+    // (thinner runs are mostly tree tops and overhangs, not worth a box)
+    const int MIN_RUN = 4;
+
+    columns.bottom.fill(0);
+    columns.top.fill(CHUNK_DEPTH);
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            int runTop = 0, runBottom = 0;
+            int y = CHUNK_DEPTH - 1;
+            while (y >= 0) {
+                while (y >= 0 && !Block::occludesView(getBlockType(x, z, y))) y--;
+                int top = y + 1;
+                while (y >= 0 && Block::occludesView(getBlockType(x, z, y))) y--;
+                if (top - (y + 1) >= MIN_RUN) {
+                    runTop = top;
+                    runBottom = y + 1;
+                    break;
+                }
+            }
+
+            // The tile keeps what is solid in all of its columns
+            int tile = (z / OCCLUDER_TILE_SIZE) * OCCLUDER_TILES_PER_SIDE + x / OCCLUDER_TILE_SIZE;
+            columns.bottom[tile] = static_cast<int16_t>(std::max<int>(columns.bottom[tile], runBottom));
+            columns.top[tile] = static_cast<int16_t>(std::min<int>(columns.top[tile], runTop));
+        }
+    }
+}
+
+ void Chunk::buildSection(int section, SectionMesh& solid, SectionMesh& liquid) {
+    solid.vertices.clear();
+    solid.indices.clear();
+    liquid.vertices.clear();
+    liquid.indices.clear();
+    solid.minY = liquid.minY = 0;
+    solid.maxY = liquid.maxY = -1;
+    bool opaque = false;
+    solid.visibility = liquid.visibility = SectionVisibility::compute(*this, section, &opaque);
+    solid.opaque = liquid.opaque = opaque;
+
+    const int minY = section * CHUNK_SECTION_SIZE;
+    const int maxY = minY + CHUNK_SECTION_SIZE;
+    auto growBounds = [](SectionMesh& mesh, int y) {
+        if (mesh.maxY < mesh.minY) mesh.minY = mesh.maxY = y;
+        else { mesh.minY = std::min(mesh.minY, y); mesh.maxY = std::max(mesh.maxY, y); }
+    };
 
     // First pass: Opaque blocks
     for (int x = 0; x < CHUNK_SIZE; x++) {
         for (int z = 0; z < CHUNK_SIZE; z++) {
-            for (int y = 0; y < CHUNK_DEPTH; y++) {
+            for (int y = minY; y < maxY; y++) {
                 Block::Type blockType = getBlockType(x, z, y);
                 if (blockType == Block::Type::AIR || blockType == Block::Type::WATER) continue;
+                growBounds(solid, y);
 
                 Block block(blockType);
 
@@ -160,9 +486,6 @@
                         }
 
                         if (neighborChunk) {
-                            if (!neighborChunk->isValid()) {
-                                return false; //Treat as solid
-                            }
                             //std::lock_guard<std::mutex> neighborLock(neighborChunk->dataMutex); // Lock neighbor
                             adjacentType = neighborChunk->getBlockType(adjX, adjZ, ny);
 
@@ -184,17 +507,17 @@
                     };
 
                 if (checkAdjacent(0, 0, 1))
-                    addFaceVertices(x, y, z, Block::Face::TOP, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::TOP, block, solid);
                 if (y > 0 && checkAdjacent(0, 0, -1)) // Skip bottom face for y = 0
-                    addFaceVertices(x, y, z, Block::Face::BOTTOM, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::BOTTOM, block, solid);
                 if (checkAdjacent(1, 0, 0))
-                    addFaceVertices(x, y, z, Block::Face::RIGHT, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::RIGHT, block, solid);
                 if (checkAdjacent(-1, 0, 0))
-                    addFaceVertices(x, y, z, Block::Face::LEFT, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::LEFT, block, solid);
                 if (checkAdjacent(0, 1, 0))
-                    addFaceVertices(x, y, z, Block::Face::FRONT, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::FRONT, block, solid);
                 if (checkAdjacent(0, -1, 0))
-                    addFaceVertices(x, y, z, Block::Face::BACK, block, SolidMesh);
+                    addFaceVertices(x, y, z, Block::Face::BACK, block, solid);
             }
         }
     }
@@ -202,8 +525,9 @@
     // Second pass: Transparent blocks (water)
     for (int x = 0; x < CHUNK_SIZE; x++) {
         for (int z = 0; z < CHUNK_SIZE; z++) {
-            for (int y = 0; y < CHUNK_DEPTH; y++) {
+            for (int y = minY; y < maxY; y++) {
                 if (getBlockType(x, z, y) != Block::Type::WATER) continue;
+                growBounds(liquid, y);
 
                 Block block(Block::Type::WATER);
 
@@ -246,10 +570,7 @@
                         }
 
                         if (neighborChunk) {
-                            if (!neighborChunk->isValid()) {
-                                return false;
-                            }
-                            std::lock_guard<std::mutex> neighborLock(neighborChunk->dataMutex); // Lock neighbor
+                            //std::lock_guard<std::mutex> neighborLock(neighborChunk->dataMutex); // Two workers meshing neighbours would deadlock here
                             adjacentType = neighborChunk->getBlockType(adjX, adjZ, ny);
                         }
                         else {
@@ -268,145 +589,21 @@
                     };
 
                 if (checkAdjacentWater(0, 0, 1))
-                    addFaceVertices(x, y, z, Block::Face::TOP, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::TOP, block, liquid);
                 if (y > 0 && checkAdjacentWater(0, 0, -1)) // Skip bottom face for y = 0
-                    addFaceVertices(x, y, z, Block::Face::BOTTOM, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::BOTTOM, block, liquid);
                 if (checkAdjacentWater(1, 0, 0))
-                    addFaceVertices(x, y, z, Block::Face::RIGHT, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::RIGHT, block, liquid);
                 if (checkAdjacentWater(-1, 0, 0))
-                    addFaceVertices(x, y, z, Block::Face::LEFT, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::LEFT, block, liquid);
                 if (checkAdjacentWater(0, 1, 0))
-                    addFaceVertices(x, y, z, Block::Face::FRONT, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::FRONT, block, liquid);
                 if (checkAdjacentWater(0, -1, 0))
-                    addFaceVertices(x, y, z, Block::Face::BACK, block, LiquidMesh);
+                    addFaceVertices(x, y, z, Block::Face::BACK, block, liquid);
             }
         }
     }
 
-    //needsGPUUpload = true;
-    SolidBuffers.needsUpload = true;
-    LiquidBuffers.needsUpload = true;
-
-}
-
- std::vector<float> Chunk::getVertexData() const {
-    std::vector<float> flatVertexData;
-    flatVertexData.reserve(vertices.size() * 8);
-
-    const float Y_SCALE = 170.0f; // !!!NOTE!!! -> Match the scale used in addVertex
-
-    for (const auto& vertex : vertices) {
-        flatVertexData.push_back(vertex.x / 256.0f);
-        flatVertexData.push_back(vertex.y / Y_SCALE); // Reverting the y scaling
-        flatVertexData.push_back(vertex.z / 256.0f);
-
-        flatVertexData.push_back(vertex.u / 65535.0f);
-        flatVertexData.push_back(vertex.v / 65535.0f);
-
-        flatVertexData.push_back(vertex.nx / 127.0f);
-        flatVertexData.push_back(vertex.ny / 127.0f);
-        flatVertexData.push_back(vertex.nz / 127.0f);
-    }
-
-    return flatVertexData;
-}
-
- void Chunk::uploadToGPU() {
-    if (!SolidBuffers.needsUpload && !LiquidBuffers.needsUpload) return;
-
-    // Upload solid mesh
-    if (SolidMesh.vertices.size() > 0 && SolidMesh.indices.size() > 0 && SolidBuffers.needsUpload) {
-        if (!SolidBuffers.buffers_Initialised) {
-            SolidBuffers.vao.Generate();
-            SolidBuffers.vbo.Generate();
-            SolidBuffers.ebo.Generate();
-            SolidBuffers.buffers_Initialised = true;
-        }
-
-        std::vector<float> flatVertexData = getFlatVertexData(SolidMesh.vertices);
-
-        SolidBuffers.vao.Bind();
-        SolidBuffers.vbo.Bind();
-        glBufferData(GL_ARRAY_BUFFER, flatVertexData.size() * sizeof(float),
-            flatVertexData.data(), GL_STATIC_DRAW);
-
-        SolidBuffers.ebo.Bind();
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, SolidMesh.indices.size() * sizeof(uint32_t),
-            SolidMesh.indices.data(), GL_STATIC_DRAW);
-
-        // Set up vertex attributes
-        setupVertexAttributes();
-
-        SolidBuffers.vbo.Unbind();
-        SolidBuffers.vao.Unbind();
-        SolidBuffers.ebo.Unbind();
-        SolidBuffers.needsUpload = false;
-    }
-
-    // Upload liquid mesh
-    if (LiquidMesh.vertices.size() > 0 && LiquidMesh.indices.size() > 0 && LiquidBuffers.needsUpload) {
-        if (!LiquidBuffers.buffers_Initialised) {
-            LiquidBuffers.vao.Generate();
-            LiquidBuffers.vbo.Generate();
-            LiquidBuffers.ebo.Generate();
-            LiquidBuffers.buffers_Initialised = true;
-        }
-
-        std::vector<float> flatVertexData = getFlatVertexData(LiquidMesh.vertices);
-
-        LiquidBuffers.vao.Bind();
-        LiquidBuffers.vbo.Bind();
-        glBufferData(GL_ARRAY_BUFFER, flatVertexData.size() * sizeof(float),
-            flatVertexData.data(), GL_STATIC_DRAW);
-
-        LiquidBuffers.ebo.Bind();
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, LiquidMesh.indices.size() * sizeof(uint32_t),
-            LiquidMesh.indices.data(), GL_STATIC_DRAW);
-
-        // Set up vertex attributes
-        setupVertexAttributes();
-
-        LiquidBuffers.vbo.Unbind();
-        LiquidBuffers.vao.Unbind();
-        LiquidBuffers.ebo.Unbind();
-        LiquidBuffers.needsUpload = false;
-    }
-}
-
- void Chunk::setupVertexAttributes() {
-    // Position (3 floats)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-
-    // UV coordinates (2 floats)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-
-    // Normal (3 floats)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-}
-
- std::vector<float> Chunk::getFlatVertexData(const std::vector<CompactVertex>& vertices) const {
-    std::vector<float> flatVertexData;
-    flatVertexData.reserve(vertices.size() * 8);
-
-    const float Y_SCALE = 170.0f; // !!!NOTE!!! -> Match the scale used in addVertex
-
-    for (const auto& vertex : vertices) {
-        flatVertexData.push_back(vertex.x / 256.0f);
-        flatVertexData.push_back(vertex.y / Y_SCALE); // Reverting the y scaling
-        flatVertexData.push_back(vertex.z / 256.0f);
-
-        flatVertexData.push_back(vertex.u / 65535.0f);
-        flatVertexData.push_back(vertex.v / 65535.0f);
-
-        flatVertexData.push_back(vertex.nx / 127.0f);
-        flatVertexData.push_back(vertex.ny / 127.0f);
-        flatVertexData.push_back(vertex.nz / 127.0f);
-    }
-
-    return flatVertexData;
 }
 
  void Chunk::saveToDisk(const std::string& filePath) {
@@ -423,7 +620,7 @@
     if (file.is_open()) {
 
         file.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(Block::Type));
-        std::cout << "Successfully loaded the chunk at: " + filePath << "\n";
+        //std::cout << "Successfully loaded the chunk at: " + filePath << "\n";
         file.close();
         return true;
     }
@@ -432,12 +629,12 @@
 
 //New modified vertex utilities
 
- void Chunk::addFaceVertices(int x, int y, int z, Block::Face face, const Block& block, MeshData& meshdata) {
+ void Chunk::addFaceVertices(int x, int y, int z, Block::Face face, const Block& block, SectionMesh& meshdata) {
     BlockFace texCoords = block.getFaceTexCoords(face);
     glm::vec3 normal = block.getFaceNormal(face);
 
-    // Calculate base index
-    uint16_t baseIndex = static_cast<uint16_t>(meshdata.vertexcount);
+    // Calculate base index (relative to the section)
+    uint32_t baseIndex = static_cast<uint32_t>(meshdata.vertices.size());
 
     if (block.getGeometryType() == Block::GeometryType::BILLBOARD) {
         // NOTE : For billboards the shape is a 'X', so the FRONT and RIGHT face enum is used....
@@ -445,19 +642,23 @@
             // 4 vertices for each billboard face
             if (face == Block::Face::FRONT) {
                 // First diagonal plane (front-to-back)
-                addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+                addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+                addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+                addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+                addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             }
             else if (face == Block::Face::RIGHT) {
                 // Second diagonal plane (left-to-right)
-                addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-                addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+                addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+                addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+                addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+                addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             }
 
+            // Billboards just take the light of their own cell
+            uint8_t cellLight = light.getPacked(static_cast<uint32_t>(blockIndex(x, z, y)));
+            for (uint32_t i = baseIndex; i < meshdata.vertices.size(); i++) meshdata.vertices[i].light = cellLight;
+
             // Add indices for the face 
             meshdata.indices.push_back(baseIndex);
             meshdata.indices.push_back(baseIndex + 1);
@@ -465,64 +666,93 @@
             meshdata.indices.push_back(baseIndex + 2);
             meshdata.indices.push_back(baseIndex + 3);
             meshdata.indices.push_back(baseIndex);
-
-            meshdata.indexcount += 6;
         }
     }
     else {
         // Normal voxel 
         switch (face) {
         case Block::Face::FRONT:
-            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             break;
         case Block::Face::BACK:
-            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             break;
         case Block::Face::TOP:
-            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
             break;
         case Block::Face::BOTTOM:
-            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
             break;
         case Block::Face::RIGHT:
-            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 1.0f, y + 0.0f, z + 1.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 0.0f, z + 0.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 0.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 1.0f, y + 1.0f, z + 1.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             break;
         case Block::Face::LEFT:
-            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices, meshdata.vertexcount);
-            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices, meshdata.vertexcount);
+            addVertex(x + 0.0f, y + 0.0f, z + 0.0f, texCoords.bottomLeft.x, texCoords.bottomLeft.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 0.0f, z + 1.0f, texCoords.bottomRight.x, texCoords.bottomRight.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 1.0f, z + 1.0f, texCoords.topRight.x, texCoords.topRight.y, normal, meshdata.vertices);
+            addVertex(x + 0.0f, y + 1.0f, z + 0.0f, texCoords.topLeft.x, texCoords.topLeft.y, normal, meshdata.vertices);
             break;
         }
 
+        // Baked AO for solid cubes. The quad is split along the diagonal whose corners are
+        // darker so the occlusion gradient doesn't change with the triangle orientation
+        bool flipDiagonal = false;
+        if (block.getType() != Block::Type::WATER) {
+            const float Y_SCALE = 170.0f; // !!!NOTE!!! -> Match the scale used in addVertex
+            glm::ivec3 faceNormal(normal);
+            uint8_t ao[4];
+            for (int i = 0; i < 4; i++) {
+                CompactVertex& vertex = meshdata.vertices[baseIndex + i];
+                glm::ivec3 corner(vertex.x / 256 - x, static_cast<int>(vertex.y / Y_SCALE) - y, vertex.z / 256 - z);
+                vertex.ao = ao[i] = cornerAO(x, y, z, faceNormal, corner);
+                vertex.light = cornerLight(x, y, z, faceNormal, corner);
+            }
+            flipDiagonal = ao[0] + ao[2] > ao[1] + ao[3];
+        }
+        else {
+            // Water surfaces are flat shaded with the light in front of the face
+            glm::ivec3 front = glm::ivec3(x, y, z) + glm::ivec3(normal);
+            int frontLight = getLightAcrossBorders(front.x, front.z, front.y);
+            uint8_t packed = frontLight < 0 ? ChunkLight::OPEN_SKY : static_cast<uint8_t>(frontLight);
+            for (int i = 0; i < 4; i++) meshdata.vertices[baseIndex + i].light = packed;
+        }
+
         // Adding indices 
-        meshdata.indices.push_back(baseIndex);
-        meshdata.indices.push_back(baseIndex + 1);
-        meshdata.indices.push_back(baseIndex + 2);
-        meshdata.indices.push_back(baseIndex + 2);
-        meshdata.indices.push_back(baseIndex + 3);
-        meshdata.indices.push_back(baseIndex);
-
-        meshdata.indexcount += 6;
+        if (flipDiagonal) {
+            meshdata.indices.push_back(baseIndex + 1);
+            meshdata.indices.push_back(baseIndex + 2);
+            meshdata.indices.push_back(baseIndex + 3);
+            meshdata.indices.push_back(baseIndex + 3);
+            meshdata.indices.push_back(baseIndex);
+            meshdata.indices.push_back(baseIndex + 1);
+        }
+        else {
+            meshdata.indices.push_back(baseIndex);
+            meshdata.indices.push_back(baseIndex + 1);
+            meshdata.indices.push_back(baseIndex + 2);
+            meshdata.indices.push_back(baseIndex + 2);
+            meshdata.indices.push_back(baseIndex + 3);
+            meshdata.indices.push_back(baseIndex);
+        }
     }
 }
 
-void Chunk::addVertex(float x, float y, float z, float u, float v, const glm::vec3& normal, std::vector<CompactVertex>& vertices, unsigned int& vertexCount) {
+void Chunk::addVertex(float x, float y, float z, float u, float v, const glm::vec3& normal, std::vector<CompactVertex>& vertices) {
     CompactVertex vertex;
     const float Y_SCALE = 170.0f;
 
@@ -538,10 +768,105 @@ void Chunk::addVertex(float x, float y, float z, float u, float v, const glm::ve
     vertex.nz = floatToInt8(normal.z);
 
     vertices.push_back(vertex);
-    vertexCount++;
 }
 
-Block& Chunk::getBlockAtLocalPos(const glm::ivec3& localPos) {
+Block::Type Chunk::getBlockTypeAcrossBorders(int x, int z, int y) const {
+    if (y < 0 || y >= CHUNK_DEPTH) return Block::Type::AIR;
+
+    bool outsideX = (x < 0 || x >= CHUNK_SIZE);
+    bool outsideZ = (z < 0 || z >= CHUNK_SIZE);
+    if (!outsideX && !outsideZ) return getBlockType(x, z, y);
+    if (outsideX && outsideZ) return Block::Type::AIR;
+
+    Chunk* neighborChunk = nullptr;
+    if (outsideX) {
+        neighborChunk = (x < 0) ? neighbors[3] : neighbors[2]; // West (index 3) / East (index 2)
+        x = (x < 0) ? CHUNK_SIZE - 1 : 0;
+    }
+    else {
+        neighborChunk = (z < 0) ? neighbors[1] : neighbors[0]; // South (index 1) / North (index 0)
+        z = (z < 0) ? CHUNK_SIZE - 1 : 0;
+    }
+    return neighborChunk ? neighborChunk->getBlockType(x, z, y) : Block::Type::AIR;
+}
+
+uint8_t Chunk::cornerAO(int x, int y, int z, const glm::ivec3& normal, const glm::ivec3& corner) const {
+    // The 2 axes lying in the face plane
+    int axis = normal.x != 0 ? 0 : (normal.y != 0 ? 1 : 2);
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+
+    glm::ivec3 front = glm::ivec3(x, y, z) + normal;
+    glm::ivec3 sideU(0), sideV(0);
+    sideU[u] = corner[u] ? 1 : -1;
+    sideV[v] = corner[v] ? 1 : -1;
+
+    auto occludes = [this](const glm::ivec3& p) {
+        return Block::castsAmbientOcclusion(getBlockTypeAcrossBorders(p.x, p.z, p.y));
+    };
+    bool side1 = occludes(front + sideU);
+    bool side2 = occludes(front + sideV);
+    bool cornerBlock = occludes(front + sideU + sideV);
+
+    if (side1 && side2) return 0; // Inner corner, fully dark whatever the corner block is
+    return static_cast<uint8_t>(3 - (side1 + side2 + cornerBlock));
+}
+
+int Chunk::getLightAcrossBorders(int x, int z, int y) const {
+    if (y >= CHUNK_DEPTH) return ChunkLight::OPEN_SKY;
+    if (y < 0) return 0;
+
+    bool outsideX = (x < 0 || x >= CHUNK_SIZE);
+    bool outsideZ = (z < 0 || z >= CHUNK_SIZE);
+    if (!outsideX && !outsideZ) return light.getPacked(static_cast<uint32_t>(blockIndex(x, z, y)));
+    if (outsideX && outsideZ) return -1;
+
+    Chunk* neighborChunk = nullptr;
+    if (outsideX) {
+        neighborChunk = (x < 0) ? neighbors[3] : neighbors[2];
+        x = (x < 0) ? CHUNK_SIZE - 1 : 0;
+    }
+    else {
+        neighborChunk = (z < 0) ? neighbors[1] : neighbors[0];
+        z = (z < 0) ? CHUNK_SIZE - 1 : 0;
+    }
+    return neighborChunk ? neighborChunk->light.getPacked(static_cast<uint32_t>(neighborChunk->blockIndex(x, z, y))) : -1;
+}
+
+uint8_t Chunk::cornerLight(int x, int y, int z, const glm::ivec3& normal, const glm::ivec3& corner) const {
+    // Same 3 cells as cornerAO + the one right in front of the face
+    int axis = normal.x != 0 ? 0 : (normal.y != 0 ? 1 : 2);
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+
+    glm::ivec3 front = glm::ivec3(x, y, z) + normal;
+    glm::ivec3 sideU(0), sideV(0);
+    sideU[u] = corner[u] ? 1 : -1;
+    sideV[v] = corner[v] ? 1 : -1;
+
+    int sky = 0, blockLight = 0, samples = 0;
+    auto sample = [&](const glm::ivec3& p) {
+        if (Block::blocksLight(getBlockTypeAcrossBorders(p.x, p.z, p.y))) return false;
+        int packed = getLightAcrossBorders(p.x, p.z, p.y);
+        if (packed < 0) return true; // Light gets through but we can't see it, leave it out
+        sky += packed & 0x0F;
+        blockLight += packed >> 4;
+        samples++;
+        return true;
+    };
+
+    sample(front);
+    bool open1 = sample(front + sideU);
+    bool open2 = sample(front + sideV);
+    if (open1 || open2) sample(front + sideU + sideV); // Light can't reach it around an inner corner
+
+    if (samples == 0) return ChunkLight::OPEN_SKY;
+    sky = (sky + samples / 2) / samples;
+    blockLight = (blockLight + samples / 2) / samples;
+    return static_cast<uint8_t>(sky | (blockLight << 4));
+}
+
+Block Chunk::getBlockAtLocalPos(const glm::ivec3& localPos) {
     Block::Type type = getBlockType(localPos.x, localPos.z, localPos.y);
     Block block(type);
     block.setPosition(localPos);
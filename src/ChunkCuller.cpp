@@ -0,0 +1,249 @@
+#include "ChunkCuller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+ bool ChunkCuller::sectionBounds(Chunk& chunk, int section, glm::vec3& min, glm::vec3& max) {
+    const MeshRange& solid = chunk.SolidMesh.sections[section];
+    const MeshRange& liquid = chunk.LiquidMesh.sections[section];
+
+    int minY = 0, maxY = -1;
+    if (solid.indexCount > 0 && solid.maxY >= solid.minY) {
+        minY = solid.minY;
+        maxY = solid.maxY;
+    }
+    if (liquid.indexCount > 0 && liquid.maxY >= liquid.minY) {
+        if (maxY < minY) {
+            minY = liquid.minY;
+            maxY = liquid.maxY;
+        }
+        else {
+            minY = std::min(minY, liquid.minY);
+            maxY = std::max(maxY, liquid.maxY);
+        }
+    }
+    if (maxY < minY) return false;
+
+    glm::vec3 origin = chunk.getPosition();
+    min = origin + glm::vec3(0.0f, static_cast<float>(minY), 0.0f);
+    max = origin + glm::vec3(static_cast<float>(CHUNK_SECTION_SIZE), static_cast<float>(maxY + 1), static_cast<float>(CHUNK_SECTION_SIZE));
+    return true;
+}
+
+ const std::vector<VisibleChunk>& ChunkCuller::cull(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks) {
+    visible.clear();
+    boxes.clear();
+    slices.clear();
+    stats = Stats{};
+    stats.chunksTested = chunks.size();
+
+    // 1) One box per section that has faces
+    for (uint32_t c = 0; c < chunks.size(); c++) {
+        for (int s = 0; s < CHUNK_SECTION_COUNT; s++) {
+            glm::vec3 min, max;
+            if (!sectionBounds(*chunks[c], s, min, max)) continue;
+            boxes.add(min, max);
+            slices.push_back({ c, static_cast<uint32_t>(s) });
+        }
+    }
+    stats.slicesTested = slices.size();
+
+    // 2) Plane test on the whole batch
+    if (enabled) cullBoxes(Frustum::fromViewProjection(viewProjection), boxes, boxVisible);
+    else boxVisible.assign(boxes.count, 1);
+
+    // 3) Sections the camera can see into through open cells
+    bool caveTest = caveCulling && floodFromCamera(cameraPosition, chunks);
+
+    // 4) Depth buffer of the terrain around the camera
+    bool occlusionTest = occlusionCulling && occlusionThreads > 0;
+    if (occlusionTest) {
+        auto start = std::chrono::steady_clock::now();
+        rasterizeOccluders(viewProjection, cameraPosition, chunks);
+        stats.occlusionMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 5) Back to per chunk masks, slices come out grouped by chunk
+    size_t i = 0;
+    while (i < slices.size()) {
+        uint32_t c = slices[i].chunk;
+        Chunk& chunk = *chunks[c];
+        uint32_t solidMask = 0, liquidMask = 0;
+        bool everySlice = true;
+
+        for (; i < slices.size() && slices[i].chunk == c; i++) {
+            uint32_t s = slices[i].section;
+            if (!boxVisible[i]) {
+                everySlice = false;
+                continue;
+            }
+            if (caveTest && !(reachable[c] & (1u << s))) {
+                everySlice = false;
+                stats.slicesOccluded++;
+                continue;
+            }
+            if (occlusionTest && !occlusion.isVisible(glm::vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), glm::vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]))) {
+                everySlice = false;
+                stats.slicesHidden++;
+                continue;
+            }
+            if (chunk.SolidMesh.sections[s].indexCount > 0) solidMask |= 1u << s;
+            if (chunk.LiquidMesh.sections[s].indexCount > 0) liquidMask |= 1u << s;
+            stats.slicesDrawn++;
+        }
+        if (!solidMask && !liquidMask) continue;
+
+        // Nothing culled -> let the renderer draw the mesh in one go
+        if (everySlice) {
+            solidMask = solidMask ? ALL_CHUNK_SECTIONS : 0;
+            liquidMask = liquidMask ? ALL_CHUNK_SECTIONS : 0;
+        }
+        visible.push_back({ &chunk, solidMask, liquidMask });
+    }
+    stats.chunksDrawn = visible.size();
+    return visible;
+}
+
+ int ChunkCuller::occluderTopAt(const Chunk& chunk, int tx, int tz) {
+    // Tile coords one step outside the chunk land in the neighbour (unloaded -> nothing there)
+    const Chunk* owner = &chunk;
+    if (tz >= OCCLUDER_TILES_PER_SIDE) { owner = chunk.neighbors[0]; tz = 0; }
+    else if (tz < 0) { owner = chunk.neighbors[1]; tz = OCCLUDER_TILES_PER_SIDE - 1; }
+    else if (tx >= OCCLUDER_TILES_PER_SIDE) { owner = chunk.neighbors[2]; tx = 0; }
+    else if (tx < 0) { owner = chunk.neighbors[3]; tx = OCCLUDER_TILES_PER_SIDE - 1; }
+    if (!owner) return 0;
+
+    int tile = tz * OCCLUDER_TILES_PER_SIDE + tx;
+    return owner->occluders.top[tile] > owner->occluders.bottom[tile] ? owner->occluders.top[tile] : 0;
+}
+
+ void ChunkCuller::rasterizeOccluders(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks) {
+    occlusion.beginFrame(viewProjection, cameraPosition);
+
+    const float maxDistance = static_cast<float>(occluderDistance * CHUNK_SECTION_SIZE);
+    for (Chunk* chunk : chunks) {
+        glm::vec3 origin = chunk->getPosition();
+        glm::vec2 offset = glm::vec2(origin.x, origin.z) + glm::vec2(CHUNK_SECTION_SIZE * 0.5f) - glm::vec2(cameraPosition.x, cameraPosition.z);
+        if (std::max(std::abs(offset.x), std::abs(offset.y)) > maxDistance) continue;
+
+        // Solid ground under every 4x4 tile : its top, and only the part of each side that sticks
+        // out above the next tile over (the rest would be drawn over again). Leaving a face out
+        // only ever makes the buffer see more, so the bottoms are skipped too
+        const OccluderColumns& columns = chunk->occluders;
+        int minTop = CHUNK_SECTION_COUNT * CHUNK_SECTION_SIZE, maxBottom = 0;
+        for (int tz = 0; tz < OCCLUDER_TILES_PER_SIDE; tz++) {
+            for (int tx = 0; tx < OCCLUDER_TILES_PER_SIDE; tx++) {
+                int tile = tz * OCCLUDER_TILES_PER_SIDE + tx;
+                int bottom = columns.bottom[tile], top = columns.top[tile];
+                minTop = std::min(minTop, top);
+                maxBottom = std::max(maxBottom, bottom);
+                if (top <= bottom) continue;
+
+                float x0 = origin.x + tx * OCCLUDER_TILE_SIZE, x1 = x0 + OCCLUDER_TILE_SIZE;
+                float z0 = origin.z + tz * OCCLUDER_TILE_SIZE, z1 = z0 + OCCLUDER_TILE_SIZE;
+                float y0 = origin.y + bottom, y1 = origin.y + top;
+                occlusion.addOccluder(glm::vec3(x0, y1, z0), glm::vec3(x1, y1, z1));
+
+                auto side = [&](int neighborTop, const glm::vec3& min, const glm::vec3& max) {
+                    float from = std::max(y0, origin.y + neighborTop);
+                    if (from < y1) occlusion.addOccluder(glm::vec3(min.x, from, min.z), glm::vec3(max.x, y1, max.z));
+                };
+                side(occluderTopAt(*chunk, tx, tz + 1), glm::vec3(x0, 0.0f, z1), glm::vec3(x1, 0.0f, z1)); // North
+                side(occluderTopAt(*chunk, tx, tz - 1), glm::vec3(x0, 0.0f, z0), glm::vec3(x1, 0.0f, z0)); // South
+                side(occluderTopAt(*chunk, tx + 1, tz), glm::vec3(x1, 0.0f, z0), glm::vec3(x1, 0.0f, z1)); // East
+                side(occluderTopAt(*chunk, tx - 1, tz), glm::vec3(x0, 0.0f, z0), glm::vec3(x0, 0.0f, z1)); // West
+            }
+        }
+
+        // Runs of sections that are solid through and through (mountain cores under the caves
+        // the columns stop at), one box per run unless the columns already cover it
+        int runStart = -1;
+        for (int s = 0; s <= CHUNK_SECTION_COUNT; s++) {
+            bool opaque = s < CHUNK_SECTION_COUNT && chunk->SolidMesh.sections[s].opaque;
+            if (opaque && runStart < 0) runStart = s;
+            if (!opaque && runStart >= 0) {
+                int runBottom = runStart * CHUNK_SECTION_SIZE, runTop = s * CHUNK_SECTION_SIZE;
+                if (runBottom < maxBottom || runTop > minTop) {
+                    glm::vec3 min = origin + glm::vec3(0.0f, runBottom, 0.0f);
+                    glm::vec3 max = origin + glm::vec3(CHUNK_SECTION_SIZE, runTop, CHUNK_SECTION_SIZE);
+                    occlusion.addOccluder(min, max);
+                }
+                runStart = -1;
+            }
+        }
+    }
+
+    occlusion.rasterize(occlusionThreads);
+    occlusion.buildHiZ();
+    stats.occluderTriangles = occlusion.getTriangleCount();
+}
+
+ bool ChunkCuller::floodFromCamera(const glm::vec3& cameraPosition, const std::vector<Chunk*>& chunks) {
+    if (chunks.empty()) return false;
+
+    // Chunk coords -> index, one flat grid over the loaded area
+    auto chunkCoords = [](Chunk& chunk) {
+        glm::vec3 pos = chunk.getPosition();
+        return glm::ivec2(static_cast<int>(std::floor(pos.x / CHUNK_SECTION_SIZE)), static_cast<int>(std::floor(pos.z / CHUNK_SECTION_SIZE)));
+    };
+    glm::ivec2 minCoords = chunkCoords(*chunks[0]);
+    glm::ivec2 maxCoords = minCoords;
+    for (Chunk* chunk : chunks) {
+        glm::ivec2 coords = chunkCoords(*chunk);
+        minCoords = glm::min(minCoords, coords);
+        maxCoords = glm::max(maxCoords, coords);
+    }
+    gridMin = minCoords;
+    gridSize = maxCoords - minCoords + glm::ivec2(1);
+    grid.assign(static_cast<size_t>(gridSize.x) * gridSize.y, -1);
+    for (uint32_t c = 0; c < chunks.size(); c++) {
+        glm::ivec2 cell = chunkCoords(*chunks[c]) - gridMin;
+        grid[static_cast<size_t>(cell.y) * gridSize.x + cell.x] = static_cast<int32_t>(c);
+    }
+    auto chunkAt = [this](glm::ivec2 coords) -> int32_t {
+        glm::ivec2 cell = coords - gridMin;
+        if (cell.x < 0 || cell.y < 0 || cell.x >= gridSize.x || cell.y >= gridSize.y) return -1;
+        return grid[static_cast<size_t>(cell.y) * gridSize.x + cell.x];
+    };
+
+    // Camera section, outside the loaded area / above the build height -> no cave culling
+    glm::ivec2 cameraCoords(static_cast<int>(std::floor(cameraPosition.x / CHUNK_SECTION_SIZE)), static_cast<int>(std::floor(cameraPosition.z / CHUNK_SECTION_SIZE)));
+    int32_t cameraChunk = chunkAt(cameraCoords);
+    if (cameraChunk < 0) return false;
+    int cameraSection = static_cast<int>(std::floor((cameraPosition.y - chunks[cameraChunk]->getPosition().y) / CHUNK_SECTION_SIZE));
+    if (cameraSection < 0 || cameraSection >= CHUNK_SECTION_COUNT) return false;
+
+    // Step of every face : x/z in chunks, y in sections
+    static const glm::ivec3 faceStep[SectionVisibility::FACE_COUNT] = {
+        { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }
+    };
+
+    reachable.assign(chunks.size(), 0);
+    queue.clear();
+    queue.push_back({ static_cast<uint32_t>(cameraChunk), static_cast<int8_t>(cameraSection), -1, 0 });
+    reachable[cameraChunk] |= 1u << cameraSection;
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        VisibilityNode node = queue[head];
+        Chunk& chunk = *chunks[node.chunk];
+        uint16_t visibility = chunk.SolidMesh.sections[node.section].visibility;
+        glm::ivec2 coords = chunkCoords(chunk);
+
+        for (int face = 0; face < SectionVisibility::FACE_COUNT; face++) {
+            // Only ever away from the camera, and only through the section itself
+            if (node.directions & (1 << SectionVisibility::opposite(face))) continue;
+            if (node.entryFace >= 0 && !SectionVisibility::connected(visibility, node.entryFace, face)) continue;
+
+            int section = node.section + faceStep[face].y;
+            if (section < 0 || section >= CHUNK_SECTION_COUNT) continue;
+            int32_t next = faceStep[face].y ? static_cast<int32_t>(node.chunk) : chunkAt(coords + glm::ivec2(faceStep[face].x, faceStep[face].z));
+            if (next < 0 || (reachable[next] & (1u << section))) continue;
+
+            reachable[next] |= 1u << section;
+            queue.push_back({ static_cast<uint32_t>(next), static_cast<int8_t>(section),
+                static_cast<int8_t>(SectionVisibility::opposite(face)), static_cast<uint8_t>(node.directions | (1 << face)) });
+        }
+    }
+    stats.sectionsVisited = queue.size();
+    return true;
+}
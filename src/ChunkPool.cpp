@@ -0,0 +1,71 @@
+#include "ChunkPool.h"
+
+ std::shared_ptr<Chunk> ChunkPool::acquire(const glm::ivec3& pos) {
+    std::shared_ptr<Chunk> chunk;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stats.acquires++;
+        if (!freeChunks.empty()) {
+            chunk = std::move(freeChunks.back());
+            freeChunks.pop_back();
+            stats.hits++;
+            stats.pooled = freeChunks.size();
+        }
+    }
+
+    // Reset outside the lock, it rewrites the whole block array
+    if (chunk) chunk->recycle(pos);
+    else chunk = std::make_shared<Chunk>(pos);
+    return chunk;
+}
+
+ void ChunkPool::recycle(std::shared_ptr<Chunk> chunk, ChunkUploader* uploader) {
+    if (!chunk) return;
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (freeChunks.size() < highWaterMark) {
+            freeChunks.push_back(std::move(chunk));
+            stats.recycled++;
+            stats.pooled = freeChunks.size();
+            return;
+        }
+        stats.dropped++;
+    }
+
+    if (uploader) uploader->release(*chunk);
+}
+
+ void ChunkPool::setHighWaterMark(size_t mark, ChunkUploader* uploader) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        highWaterMark = mark;
+    }
+    trim(mark, uploader);
+}
+
+ void ChunkPool::clear(ChunkUploader* uploader) {
+    trim(0, uploader);
+}
+
+ ChunkPool::Stats ChunkPool::getStats() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return stats;
+}
+
+ void ChunkPool::trim(size_t mark, ChunkUploader* uploader) {
+    std::vector<std::shared_ptr<Chunk>> extra;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        while (freeChunks.size() > mark) {
+            extra.push_back(std::move(freeChunks.back()));
+            freeChunks.pop_back();
+        }
+        stats.dropped += extra.size();
+        stats.pooled = freeChunks.size();
+    }
+
+    if (uploader) {
+        for (auto& chunk : extra) uploader->release(*chunk);
+    }
+}
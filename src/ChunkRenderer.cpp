@@ -0,0 +1,329 @@
+#include "ChunkRenderer.h"
+#include <algorithm>
+
+// pos3 + uv2 + normal3 + ao1 + light2
+static const int FLOATS_PER_VERTEX = 11;
+static const size_t VERTEX_BYTES = FLOATS_PER_VERTEX * sizeof(float);
+
+// Starting size of the shared buffers (~44 MB of vertices + 8 MB of indices), they double when full
+static const uint32_t INITIAL_VERTEX_CAPACITY = 1u << 20;
+static const uint32_t INITIAL_INDEX_CAPACITY = 1u << 21;
+// Ranges are handed out in multiples of this, so freed holes stay reusable
+static const uint32_t ARENA_ALIGNMENT = 256;
+
+// Instanced attribute with the chunk position (world.vert / water.vert)
+static const GLuint CHUNK_OFFSET_ATTRIBUTE = 7;
+
+ void ChunkRenderer::upload(Chunk& chunk) {
+    if (!chunk.SolidBuffers.needsUpload && !chunk.LiquidBuffers.needsUpload) return;
+
+    uploadMesh(chunk.SolidMesh, chunk.SolidBuffers);
+    uploadMesh(chunk.LiquidMesh, chunk.LiquidBuffers);
+}
+
+ void ChunkRenderer::release(Chunk& chunk) {
+    releaseMesh(chunk.SolidBuffers);
+    releaseMesh(chunk.LiquidBuffers);
+}
+
+ void ChunkRenderer::beginFrame() {
+    drawCalls = 0;
+    rangesDrawn = 0;
+}
+
+ void ChunkRenderer::drawSolid(const std::vector<VisibleChunk>& visible) {
+    drawPass(visible, false);
+}
+
+ void ChunkRenderer::drawLiquid(const std::vector<VisibleChunk>& visible) {
+    drawPass(visible, true);
+}
+
+ void ChunkRenderer::drawPass(const std::vector<VisibleChunk>& visible, bool liquid) {
+    if (!initialised) return;
+
+    // 1) One command per run of visible sections, baseInstance picks the chunk position
+    commands.clear();
+    chunkOffsets.clear();
+    for (const VisibleChunk& entry : visible) {
+        uint32_t sectionMask = liquid ? entry.liquidSections : entry.solidSections;
+        const MeshData& mesh = liquid ? entry.chunk->LiquidMesh : entry.chunk->SolidMesh;
+        const GPUMesh& buffers = liquid ? entry.chunk->LiquidBuffers : entry.chunk->SolidBuffers;
+        if (!sectionMask || !buffers.indexRange.valid()) continue;
+
+        GLuint instance = static_cast<GLuint>(chunkOffsets.size() / 3);
+        glm::vec3 position = entry.chunk->getPosition();
+        chunkOffsets.insert(chunkOffsets.end(), { position.x, position.y, position.z });
+
+        auto addRange = [&](unsigned int firstIndex, unsigned int count) {
+            commands.push_back({ count, 1, buffers.indexRange.offset + firstIndex, static_cast<GLint>(buffers.vertexRange.offset), instance });
+        };
+        if (sectionMask == ALL_CHUNK_SECTIONS) {
+            addRange(0, mesh.indexcount);
+            continue;
+        }
+
+        // Sections sit one after the other in the index buffer, so a run of visible ones is one
+        // contiguous range. Empty sections don't break a run (their slack is degenerate anyway)
+        bool inRun = false;
+        unsigned int runStart = 0, runEnd = 0;
+        for (int s = 0; s < CHUNK_SECTION_COUNT; s++) {
+            const MeshRange& range = mesh.sections[s];
+            if (range.indexCount == 0) continue;
+
+            if (sectionMask & (1u << s)) {
+                if (!inRun) runStart = range.firstIndex;
+                runEnd = range.firstIndex + range.indexCapacity;
+                inRun = true;
+            }
+            else if (inRun) {
+                addRange(runStart, runEnd - runStart);
+                inRun = false;
+            }
+        }
+        if (inRun) addRange(runStart, runEnd - runStart);
+    }
+    if (commands.empty()) return;
+
+    // 2) Submit
+    glBindVertexArray(vao);
+    if (indirect) {
+        glBindBuffer(GL_ARRAY_BUFFER, offsetBuffer);
+        glBufferData(GL_ARRAY_BUFFER, chunkOffsets.size() * sizeof(float), chunkOffsets.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        drawCalls++;
+    }
+    else {
+        // GL 3.3 : same ranges one by one, the chunk position as a constant attribute
+        for (const DrawCommand& command : commands) {
+            const float* offset = &chunkOffsets[command.baseInstance * 3];
+            glVertexAttrib3f(CHUNK_OFFSET_ATTRIBUTE, offset[0], offset[1], offset[2]);
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                (void*)(static_cast<size_t>(command.firstIndex) * sizeof(uint32_t)), command.baseVertex);
+        }
+        drawCalls += commands.size();
+    }
+    rangesDrawn += commands.size();
+    glBindVertexArray(0);
+}
+
+ ChunkRenderer::Stats ChunkRenderer::getStats() const {
+    Stats stats;
+    stats.drawCalls = drawCalls;
+    stats.ranges = rangesDrawn;
+    stats.growths = growths;
+    stats.vertexArena = vertexArena.getStats();
+    stats.indexArena = indexArena.getStats();
+    stats.vertexCapacity = vertexArena.getCapacity();
+    stats.indexCapacity = indexArena.getCapacity();
+    stats.vertexFragmentation = vertexArena.getFragmentation();
+    return stats;
+}
+
+ void ChunkRenderer::initialise() {
+    if (initialised) return;
+
+    indirect = GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+    vertexArena = RangeAllocator(INITIAL_VERTEX_CAPACITY, ARENA_ALIGNMENT);
+    indexArena = RangeAllocator(INITIAL_INDEX_CAPACITY, ARENA_ALIGNMENT);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &offsetBuffer);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(INITIAL_VERTEX_CAPACITY) * VERTEX_BYTES, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<size_t>(INITIAL_INDEX_CAPACITY) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    setupVertexAttributes();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    initialised = true;
+}
+
+ void ChunkRenderer::shutdown() {
+    if (!initialised) return;
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &offsetBuffer);
+    vao = vbo = ebo = commandBuffer = offsetBuffer = 0;
+    initialised = false;
+}
+
+ void ChunkRenderer::uploadMesh(MeshData& mesh, GPUMesh& buffers) {
+    if (!buffers.needsUpload) return;
+
+    // New mesh or moved ranges -> rewrite everything, otherwise only the patched sections.
+    // A patch can leave no vertices at all (section emptied), its index slot still has to go up
+    bool fullUpload = !buffers.buffers_Initialised || mesh.layoutChanged;
+    if (fullUpload && (mesh.vertices.empty() || mesh.indices.empty())) return;
+    if (!fullUpload && mesh.dirtySections == 0) return;
+    if (fullUpload && mesh.released) return; // Only staged sections left on the CPU, World asks for a full remesh
+
+    initialise();
+
+    if (fullUpload) {
+        // The old ranges are kept as long as the new mesh fits in them
+        if (buffers.vertexRange.size < mesh.vertexcount) {
+            vertexArena.free(buffers.vertexRange);
+            buffers.vertexRange = allocate(vertexArena, vbo, GL_ARRAY_BUFFER, VERTEX_BYTES, mesh.vertexcount);
+        }
+        if (buffers.indexRange.size < mesh.indexcount) {
+            indexArena.free(buffers.indexRange);
+            buffers.indexRange = allocate(indexArena, ebo, GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t), mesh.indexcount);
+        }
+        if (!buffers.vertexRange.valid() || !buffers.indexRange.valid()) {
+            releaseMesh(buffers);
+            return;
+        }
+        buffers.buffers_Initialised = true;
+    }
+
+    // Index uploads go through COPY_WRITE, the element binding belongs to the VAO
+    const size_t vertexBase = static_cast<size_t>(buffers.vertexRange.offset) * VERTEX_BYTES;
+    const size_t indexBase = static_cast<size_t>(buffers.indexRange.offset) * sizeof(uint32_t);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+
+    if (fullUpload) {
+        std::vector<float> flatVertexData = getFlatVertexData(mesh.vertices.data(), mesh.vertices.size());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexBase, flatVertexData.size() * sizeof(float), flatVertexData.data());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexBase, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data());
+    }
+    else {
+        for (int section = 0; section < CHUNK_SECTION_COUNT; section++) {
+            if (!(mesh.dirtySections & (1u << section))) continue;
+            const MeshRange& range = mesh.sections[section];
+
+            if (range.vertexCount > 0) {
+                std::vector<float> flatVertexData = getFlatVertexData(mesh.sectionVertices(section), range.vertexCount);
+                glBufferSubData(GL_ARRAY_BUFFER, vertexBase + range.firstVertex * VERTEX_BYTES,
+                    flatVertexData.size() * sizeof(float), flatVertexData.data());
+            }
+            // Whole index slot, the tail turned into degenerate triangles
+            if (range.indexCapacity > 0) glBufferSubData(GL_COPY_WRITE_BUFFER, indexBase + range.firstIndex * sizeof(uint32_t),
+                range.indexCapacity * sizeof(uint32_t), mesh.sectionIndices(section));
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mesh.layoutChanged = false;
+    mesh.dirtySections = 0;
+    buffers.needsUpload = false;
+}
+
+ void ChunkRenderer::releaseMesh(GPUMesh& buffers) {
+    vertexArena.free(buffers.vertexRange);
+    indexArena.free(buffers.indexRange);
+    buffers.buffers_Initialised = false;
+}
+
+ RangeAllocator::Range ChunkRenderer::allocate(RangeAllocator& arena, GLuint& buffer, GLenum target, size_t elementSize, uint32_t count) {
+    RangeAllocator::Range range = arena.allocate(count);
+    if (range.valid()) return range;
+
+    // Full : new buffer twice the size, the live ranges keep their offsets
+    uint32_t oldCapacity = arena.getCapacity();
+    uint32_t newCapacity = std::max(oldCapacity * 2, oldCapacity + count + ARENA_ALIGNMENT);
+    GLuint bigger = 0;
+    glGenBuffers(1, &bigger);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bigger);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<size_t>(newCapacity) * elementSize, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<size_t>(oldCapacity) * elementSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = bigger;
+
+    // The VAO still points at the old one
+    glBindVertexArray(vao);
+    if (target == GL_ARRAY_BUFFER) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        setupVertexAttributes();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    }
+    glBindVertexArray(0);
+
+    arena.grow(newCapacity);
+    growths++;
+    return arena.allocate(count);
+}
+
+ void ChunkRenderer::setupVertexAttributes() {
+    const GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+
+    // Position (3 floats)
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+
+    // UV coordinates (2 floats)
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+
+    // Normal (3 floats)
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
+
+    // Baked AO (1 float, 0-1). 3 and 4 are the tangent/bitangent slots of world.vert
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+
+    // Baked sky / block light (2 floats, 0-1)
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 2, GL_FLOAT, GL_FALSE, stride, (void*)(9 * sizeof(float)));
+
+    // Chunk position, one per draw command (baseInstance). Without indirect draws the array
+    // stays off and drawPass sets it as a constant
+    if (indirect) {
+        glBindBuffer(GL_ARRAY_BUFFER, offsetBuffer);
+        glEnableVertexAttribArray(CHUNK_OFFSET_ATTRIBUTE);
+        glVertexAttribPointer(CHUNK_OFFSET_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glVertexAttribDivisor(CHUNK_OFFSET_ATTRIBUTE, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    }
+}
+
+ std::vector<float> ChunkRenderer::getFlatVertexData(const CompactVertex* vertices, size_t count) const {
+    std::vector<float> flatVertexData;
+    flatVertexData.reserve(count * FLOATS_PER_VERTEX);
+
+    const float Y_SCALE = 170.0f; // !!!NOTE!!! -> Match the scale used in Chunk::addVertex
+
+    for (size_t i = 0; i < count; i++) {
+        const CompactVertex& vertex = vertices[i];
+        flatVertexData.push_back(vertex.x / 256.0f);
+        flatVertexData.push_back(vertex.y / Y_SCALE); // Reverting the y scaling
+        flatVertexData.push_back(vertex.z / 256.0f);
+
+        flatVertexData.push_back(vertex.u / 65535.0f);
+        flatVertexData.push_back(vertex.v / 65535.0f);
+
+        flatVertexData.push_back(vertex.nx / 127.0f);
+        flatVertexData.push_back(vertex.ny / 127.0f);
+        flatVertexData.push_back(vertex.nz / 127.0f);
+
+        flatVertexData.push_back(vertex.ao / 3.0f);
+
+        flatVertexData.push_back((vertex.light & 0x0F) / 15.0f);
+        flatVertexData.push_back((vertex.light >> 4) / 15.0f);
+    }
+
+    return flatVertexData;
+}
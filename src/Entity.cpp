@@ -80,7 +80,7 @@ void Entity::applyForce(const glm::vec3& force) {
                         continue;
                     }
 
-                    Block& block = chunk.getBlockAtLocalPos(localBlockPos);
+                    Block block = chunk.getBlockAtLocalPos(localBlockPos);
 
                     // Skips non soild blocks //
                     if (block.getType() == Block::Type::AIR || block.getType() == Block::Type::WATER || block.getType() == Block::Type::WILD_GRASS) {
@@ -0,0 +1,106 @@
+#include "Frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_SSE 1
+#include <emmintrin.h>
+#endif
+
+ Frustum Frustum::fromViewProjection(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann : rows of the matrix (glm is column major, so m[col][row])
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0; // Left
+    frustum.planes[1] = row3 - row0; // Right
+    frustum.planes[2] = row3 + row1; // Bottom
+    frustum.planes[3] = row3 - row1; // Top
+    frustum.planes[4] = row3 + row2; // Near
+    frustum.planes[5] = row3 - row2; // Far
+    for (auto& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+ void BoxList::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+    count = 0;
+}
+
+ void BoxList::add(const glm::vec3& min, const glm::vec3& max) {
+    // Overwrite the padding slot if there is one, else grow by a whole block of 4
+    if (count == minX.size()) {
+        size_t padded = count + 4;
+        minX.resize(padded, 0.0f); minY.resize(padded, 0.0f); minZ.resize(padded, 0.0f);
+        maxX.resize(padded, 0.0f); maxY.resize(padded, 0.0f); maxZ.resize(padded, 0.0f);
+    }
+    minX[count] = min.x; minY[count] = min.y; minZ[count] = min.z;
+    maxX[count] = max.x; maxY[count] = max.y; maxZ[count] = max.z;
+    count++;
+}
+
+ void cullBoxesScalar(const Frustum& frustum, const BoxList& boxes, std::vector<uint8_t>& visible) {
+    visible.assign(boxes.count, 1);
+    for (size_t i = 0; i < boxes.count; i++) {
+        for (const glm::vec4& plane : frustum.planes) {
+            // Corner furthest along the plane normal, if even that one is behind the box is out
+            float x = plane.x >= 0.0f ? boxes.maxX[i] : boxes.minX[i];
+            float y = plane.y >= 0.0f ? boxes.maxY[i] : boxes.minY[i];
+            float z = plane.z >= 0.0f ? boxes.maxZ[i] : boxes.minZ[i];
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+                visible[i] = 0;
+                break;
+            }
+        }
+    }
+}
+
+ void cullBoxes(const Frustum& frustum, const BoxList& boxes, std::vector<uint8_t>& visible) {
+#ifdef FRUSTUM_SSE
+    visible.resize(boxes.minX.size());
+
+    // The corner choice only depends on the plane, so it's picked once per plane
+    // (which array to read) and the loop is plain multiply-adds on 4 boxes
+    struct PlaneArrays {
+        __m128 nx, ny, nz, d;
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+    PlaneArrays planes[6];
+    for (int p = 0; p < 6; p++) {
+        const glm::vec4& plane = frustum.planes[p];
+        planes[p].nx = _mm_set1_ps(plane.x);
+        planes[p].ny = _mm_set1_ps(plane.y);
+        planes[p].nz = _mm_set1_ps(plane.z);
+        planes[p].d = _mm_set1_ps(plane.w);
+        planes[p].x = plane.x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+        planes[p].y = plane.y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+        planes[p].z = plane.z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    for (size_t i = 0; i < boxes.minX.size(); i += 4) {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const PlaneArrays& plane : planes) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane.nx, _mm_loadu_ps(plane.x + i)), _mm_mul_ps(plane.ny, _mm_loadu_ps(plane.y + i))),
+                _mm_add_ps(_mm_mul_ps(plane.nz, _mm_loadu_ps(plane.z + i)), plane.d));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+        int mask = _mm_movemask_ps(inside);
+        visible[i] = mask & 1;
+        visible[i + 1] = (mask >> 1) & 1;
+        visible[i + 2] = (mask >> 2) & 1;
+        visible[i + 3] = (mask >> 3) & 1;
+    }
+    visible.resize(boxes.count);
+#else
+    cullBoxesScalar(frustum, boxes, visible);
+#endif
+}
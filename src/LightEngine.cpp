@@ -0,0 +1,360 @@
+#include "LightEngine.h"
+#include "Chunk.h"
+#include <algorithm>
+
+namespace {
+
+const int SIZE = 16;
+const int DEPTH = 384;
+
+inline uint32_t cellIndex(int x, int y, int z) {
+    return static_cast<uint32_t>(y * SIZE * SIZE + z * SIZE + x);
+}
+
+// Last one is "down", skylight keeps 15 going that way
+const glm::ivec3 DIRECTIONS[6] = {
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 }
+};
+const int DOWN = 5;
+
+// Chunk owning (x, z) once we stepped out of `chunk`, the coordinates get wrapped into it.
+// nullptr when the neighbour isn't loaded.
+Chunk* resolve(Chunk& chunk, int& x, int& z) {
+    if (x >= 0 && x < SIZE && z >= 0 && z < SIZE) return &chunk;
+
+    // neighbors : North (+Z) | South (-Z) | East (+X) | West (-X)
+    Chunk* target = nullptr;
+    if (x < 0) { target = chunk.neighbors[3]; x += SIZE; }
+    else if (x >= SIZE) { target = chunk.neighbors[2]; x -= SIZE; }
+    else if (z < 0) { target = chunk.neighbors[1]; z += SIZE; }
+    else { target = chunk.neighbors[0]; z -= SIZE; }
+    return target;
+}
+
+inline uint8_t spreadLevel(uint8_t level, LightChannel channel, int direction, Block::Type target) {
+    if (channel == LightChannel::SKY && direction == DOWN && level == 15 && target != Block::Type::WATER) return 15;
+    return static_cast<uint8_t>(level - 1);
+}
+
+} // namespace
+
+ void LightEngine::lightNewChunk(Chunk& chunk) {
+    LightEngine engine;
+    engine.crossBorders = false;
+    engine.trackDirty = false;
+
+    ChunkLight& light = chunk.light;
+    light.clearSections();
+    for (int channel = 0; channel < 2; channel++) {
+        light.pendingAdds[channel].clear();
+        light.pendingRemovals[channel].clear();
+    }
+
+    // 1) Column tops : highest cell that stops direct skylight (-1 = nothing in the column)
+    std::array<int, SIZE * SIZE> top;
+    int maxTop = -1;
+    for (int z = 0; z < SIZE; z++) {
+        for (int x = 0; x < SIZE; x++) {
+            int columnTop = -1;
+            for (int y = DEPTH - 1; y >= 0; y--) {
+                Block::Type type = chunk.getBlockType(x, z, y);
+                if (Block::blocksLight(type) || type == Block::Type::WATER) {
+                    columnTop = y;
+                    break;
+                }
+            }
+            top[z * SIZE + x] = columnTop;
+            maxTop = std::max(maxTop, columnTop);
+        }
+    }
+
+    // 2) Sections down there start dark, everything above the highest top stays open sky
+    int lastSection = maxTop / SIZE; // -1 / 16 == 0 , harmless
+    for (int section = 0; section <= lastSection; section++) light.allocateSection(section, 0);
+
+    int allocatedTop = (lastSection + 1) * SIZE;
+    for (int z = 0; z < SIZE; z++) {
+        for (int x = 0; x < SIZE; x++) {
+            for (int y = top[z * SIZE + x] + 1; y < allocatedTop; y++) {
+                light.set(cellIndex(x, y, z), LightChannel::SKY, 15);
+            }
+        }
+    }
+
+    // 3) Seeds : direct sky cells beside a taller column (they light it sideways) or sitting on water
+    auto& skySeeds = light.pendingAdds[static_cast<int>(LightChannel::SKY)];
+    for (int z = 0; z < SIZE; z++) {
+        for (int x = 0; x < SIZE; x++) {
+            int columnTop = top[z * SIZE + x];
+            int highestNeighbour = columnTop;
+            if (x > 0) highestNeighbour = std::max(highestNeighbour, top[z * SIZE + x - 1]);
+            if (x < SIZE - 1) highestNeighbour = std::max(highestNeighbour, top[z * SIZE + x + 1]);
+            if (z > 0) highestNeighbour = std::max(highestNeighbour, top[(z - 1) * SIZE + x]);
+            if (z < SIZE - 1) highestNeighbour = std::max(highestNeighbour, top[(z + 1) * SIZE + x]);
+
+            for (int y = columnTop + 1; y <= highestNeighbour && y < DEPTH; y++) {
+                skySeeds.push_back({ cellIndex(x, y, z), 15 });
+            }
+            if (columnTop >= 0 && columnTop + 1 < DEPTH && chunk.getBlockType(x, z, columnTop) == Block::Type::WATER) {
+                skySeeds.push_back({ cellIndex(x, columnTop + 1, z), 15 });
+            }
+        }
+    }
+
+    // 4) Emitters
+    auto& blockSeeds = light.pendingAdds[static_cast<int>(LightChannel::BLOCK)];
+    for (int y = 0; y <= maxTop; y++) {
+        for (int z = 0; z < SIZE; z++) {
+            for (int x = 0; x < SIZE; x++) {
+                uint8_t emission = Block::lightEmission(chunk.getBlockType(x, z, y));
+                if (emission == 0) continue;
+                light.set(cellIndex(x, y, z), LightChannel::BLOCK, emission);
+                blockSeeds.push_back({ cellIndex(x, y, z), emission });
+            }
+        }
+    }
+
+    engine.runAdds(chunk, LightChannel::SKY);
+    engine.runAdds(chunk, LightChannel::BLOCK);
+}
+
+ void LightEngine::stitchNewChunk(Chunk& chunk) {
+    for (int wall = 0; wall < 4; wall++) {
+        Chunk* neighbor = chunk.neighbors[wall];
+        if (!neighbor) continue;
+
+        for (int y = 0; y < DEPTH; y++) {
+            // Open sky on both sides, nothing can flow
+            int section = y / SIZE;
+            if (!chunk.light.getSection(section) && !neighbor->light.getSection(section)) {
+                y += SIZE - 1;
+                continue;
+            }
+
+            for (int k = 0; k < SIZE; k++) {
+                // Cell on our side of the wall (a) and the one facing it (b)
+                int ax, az, bx, bz;
+                switch (wall) {
+                case 0: ax = k; az = SIZE - 1; bx = k; bz = 0; break;        // North
+                case 1: ax = k; az = 0; bx = k; bz = SIZE - 1; break;        // South
+                case 2: ax = SIZE - 1; az = k; bx = 0; bz = k; break;        // East
+                default: ax = 0; az = k; bx = SIZE - 1; bz = k; break;       // West
+                }
+                uint32_t a = cellIndex(ax, y, az);
+                uint32_t b = cellIndex(bx, y, bz);
+
+                for (int channel = 0; channel < 2; channel++) {
+                    LightChannel ch = static_cast<LightChannel>(channel);
+                    uint8_t la = chunk.light.get(a, ch);
+                    uint8_t lb = neighbor->light.get(b, ch);
+                    if (la > lb + 1 && !Block::blocksLight(neighbor->getBlockType(bx, bz, y))) {
+                        chunk.light.pendingAdds[channel].push_back({ a, la });
+                        activate(chunk);
+                    }
+                    else if (lb > la + 1 && !Block::blocksLight(chunk.getBlockType(ax, az, y))) {
+                        neighbor->light.pendingAdds[channel].push_back({ b, lb });
+                        activate(*neighbor);
+                    }
+                }
+            }
+        }
+    }
+}
+
+ void LightEngine::onBlockChanged(Chunk& chunk, const glm::ivec3& localPos, Block::Type oldType, Block::Type newType) {
+    bool sameOptics = Block::blocksLight(oldType) == Block::blocksLight(newType) &&
+        (oldType == Block::Type::WATER) == (newType == Block::Type::WATER) &&
+        Block::lightEmission(oldType) == Block::lightEmission(newType);
+    if (sameOptics) return;
+
+    uint32_t index = cellIndex(localPos.x, localPos.y, localPos.z);
+
+    // Whatever lit this cell goes away first, the removal BFS hands the rest back to the adds
+    for (int channel = 0; channel < 2; channel++) {
+        LightChannel ch = static_cast<LightChannel>(channel);
+        uint8_t current = chunk.light.get(index, ch);
+        if (current == 0) continue;
+        chunk.light.set(index, ch, 0);
+        markChanged(chunk, localPos.x, localPos.y, localPos.z);
+        chunk.light.pendingRemovals[channel].push_back({ index, current });
+    }
+
+    uint8_t emission = Block::lightEmission(newType);
+    if (emission > 0) {
+        chunk.light.set(index, LightChannel::BLOCK, emission);
+        markChanged(chunk, localPos.x, localPos.y, localPos.z);
+        chunk.light.pendingAdds[static_cast<int>(LightChannel::BLOCK)].push_back({ index, emission });
+    }
+
+    // The cell carries light now, let the neighbours flow back into it
+    if (!Block::blocksLight(newType)) {
+        for (int d = 0; d < 6; d++) {
+            int nx = localPos.x + DIRECTIONS[d].x;
+            int ny = localPos.y + DIRECTIONS[d].y;
+            int nz = localPos.z + DIRECTIONS[d].z;
+            if (ny < 0 || ny >= DEPTH) continue;
+            Chunk* target = resolve(chunk, nx, nz);
+            if (!target) continue;
+
+            uint32_t neighborIndex = cellIndex(nx, ny, nz);
+            for (int channel = 0; channel < 2; channel++) {
+                uint8_t level = target->light.get(neighborIndex, static_cast<LightChannel>(channel));
+                if (level == 0) continue;
+                target->light.pendingAdds[channel].push_back({ neighborIndex, level });
+                activate(*target);
+            }
+        }
+    }
+
+    activate(chunk);
+}
+
+ void LightEngine::propagate() {
+    // Removals have to settle everywhere first, an add running early could re-spread light
+    // from a cell whose own removal is still waiting in another chunk's queue
+    for (int phase = 0; phase < 2; phase++) {
+        bool ranSomething = true;
+        while (ranSomething) {
+            ranSomething = false;
+            for (size_t i = 0; i < active.size(); i++) {
+                Chunk& chunk = *active[i];
+                for (int channel = 0; channel < 2; channel++) {
+                    auto& queue = phase == 0 ? chunk.light.pendingRemovals[channel] : chunk.light.pendingAdds[channel];
+                    if (queue.empty()) continue;
+                    if (phase == 0) runRemovals(chunk, static_cast<LightChannel>(channel));
+                    else runAdds(chunk, static_cast<LightChannel>(channel));
+                    ranSomething = true;
+                }
+            }
+        }
+    }
+
+    for (Chunk* chunk : active) chunk->light.queued = false;
+    active.clear();
+}
+
+ void LightEngine::takeDirtyChunks(std::vector<std::pair<Chunk*, uint32_t>>& out) {
+    out.insert(out.end(), dirty.begin(), dirty.end());
+    dirty.clear();
+    dirtyIndex.clear();
+}
+
+ void LightEngine::activate(Chunk& chunk) {
+    if (chunk.light.queued) return;
+    chunk.light.queued = true;
+    active.push_back(&chunk);
+}
+
+ void LightEngine::markChanged(Chunk& chunk, int x, int y, int z) {
+    if (!trackDirty) return;
+
+    // Faces sampling this cell (AO style smooth light) sit within one block of it
+    uint32_t sections = Chunk::sectionsTouchedBy({ x, y, z });
+    auto mark = [&](Chunk* target) {
+        if (!target) return;
+        auto [it, inserted] = dirtyIndex.try_emplace(target, dirty.size());
+        if (inserted) dirty.emplace_back(target, sections);
+        else dirty[it->second].second |= sections;
+    };
+    mark(&chunk);
+    if (x == 0) mark(chunk.neighbors[3]);
+    if (x == SIZE - 1) mark(chunk.neighbors[2]);
+    if (z == 0) mark(chunk.neighbors[1]);
+    if (z == SIZE - 1) mark(chunk.neighbors[0]);
+}
+
+ void LightEngine::runRemovals(Chunk& chunk, LightChannel channel) {
+    const int ch = static_cast<int>(channel);
+    work.clear();
+    work.swap(chunk.light.pendingRemovals[ch]);
+
+    for (size_t head = 0; head < work.size(); head++) {
+        LightNode node = work[head];
+        nodesProcessed++;
+        int x = node.index & 15;
+        int z = (node.index >> 4) & 15;
+        int y = node.index >> 8;
+
+        for (int d = 0; d < 6; d++) {
+            int nx = x + DIRECTIONS[d].x;
+            int ny = y + DIRECTIONS[d].y;
+            int nz = z + DIRECTIONS[d].z;
+            if (ny < 0 || ny >= DEPTH) continue;
+            Chunk* target = crossBorders ? resolve(chunk, nx, nz) : (nx >= 0 && nx < SIZE && nz >= 0 && nz < SIZE ? &chunk : nullptr);
+            if (!target) continue;
+
+            uint32_t index = cellIndex(nx, ny, nz);
+            uint8_t level = target->light.get(index, channel);
+            if (level == 0) continue;
+
+            Block::Type type = target->getBlockType(nx, nz, ny);
+            bool litByRemoved = level < node.level ||
+                (channel == LightChannel::SKY && d == DOWN && node.level == 15 && level == 15 && type != Block::Type::WATER);
+            bool emitter = channel == LightChannel::BLOCK && Block::lightEmission(type) >= level;
+
+            if (litByRemoved && !emitter) {
+                target->light.set(index, channel, 0);
+                markChanged(*target, nx, ny, nz);
+                if (target == &chunk) {
+                    work.push_back({ index, level });
+                }
+                else {
+                    target->light.pendingRemovals[ch].push_back({ index, level });
+                    activate(*target);
+                }
+            }
+            else {
+                // Lit by something else, it has to spread back into the hole
+                target->light.pendingAdds[ch].push_back({ index, level });
+                activate(*target);
+            }
+        }
+    }
+    work.clear();
+}
+
+ void LightEngine::runAdds(Chunk& chunk, LightChannel channel) {
+    const int ch = static_cast<int>(channel);
+    work.clear();
+    work.swap(chunk.light.pendingAdds[ch]);
+
+    for (size_t head = 0; head < work.size(); head++) {
+        LightNode node = work[head];
+        nodesProcessed++;
+
+        // Current value, the cell may have been removed (0) or raised since it was queued
+        uint8_t level = chunk.light.get(node.index, channel);
+        if (level <= 1) continue;
+
+        int x = node.index & 15;
+        int z = (node.index >> 4) & 15;
+        int y = node.index >> 8;
+
+        for (int d = 0; d < 6; d++) {
+            int nx = x + DIRECTIONS[d].x;
+            int ny = y + DIRECTIONS[d].y;
+            int nz = z + DIRECTIONS[d].z;
+            if (ny < 0 || ny >= DEPTH) continue;
+            Chunk* target = crossBorders ? resolve(chunk, nx, nz) : (nx >= 0 && nx < SIZE && nz >= 0 && nz < SIZE ? &chunk : nullptr);
+            if (!target) continue;
+
+            Block::Type type = target->getBlockType(nx, nz, ny);
+            if (Block::blocksLight(type)) continue;
+
+            uint32_t index = cellIndex(nx, ny, nz);
+            uint8_t spread = spreadLevel(level, channel, d, type);
+            if (target->light.get(index, channel) >= spread) continue;
+
+            target->light.set(index, channel, spread);
+            markChanged(*target, nx, ny, nz);
+            if (target == &chunk) {
+                work.push_back({ index, spread });
+            }
+            else {
+                target->light.pendingAdds[ch].push_back({ index, spread });
+                activate(*target);
+            }
+        }
+    }
+    work.clear();
+}
@@ -0,0 +1,76 @@
+#include "MeshBufferPool.h"
+
+ size_t MeshBufferPool::sizeClass(size_t count) {
+    if (count <= MIN_CLASS) return MIN_CLASS;
+
+    // Largest power of two below count, then quarter steps up to the next one
+    size_t base = MIN_CLASS;
+    while (base * 2 < count) base *= 2;
+    size_t step = base / 4;
+    return base + ((count - base + step - 1) / step) * step;
+}
+
+ std::vector<CompactVertex> MeshBufferPool::acquireVertices(size_t count) {
+    return acquire(vertexBuckets, count);
+}
+
+ std::vector<uint32_t> MeshBufferPool::acquireIndices(size_t count) {
+    return acquire(indexBuckets, count);
+}
+
+ void MeshBufferPool::recycle(std::vector<CompactVertex>&& buffer) {
+    giveBack(vertexBuckets, std::move(buffer));
+}
+
+ void MeshBufferPool::recycle(std::vector<uint32_t>&& buffer) {
+    giveBack(indexBuckets, std::move(buffer));
+}
+
+ MeshBufferPool::Stats MeshBufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return stats;
+}
+
+template <typename T>
+std::vector<T> MeshBufferPool::acquire(Buckets<T>& buckets, size_t count) {
+    std::vector<T> buffer;
+    if (count == 0) return buffer;
+
+    size_t capacity = sizeClass(count);
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = buckets.find(capacity);
+        if (it != buckets.end() && !it->second.empty()) {
+            buffer = std::move(it->second.back());
+            it->second.pop_back();
+            stats.hits++;
+            stats.pooledBytes -= capacity * sizeof(T);
+            return buffer;
+        }
+        stats.misses++;
+    }
+
+    buffer.reserve(capacity); // Allocate outside the lock
+    return buffer;
+}
+
+template <typename T>
+void MeshBufferPool::giveBack(Buckets<T>& buckets, std::vector<T>&& buffer) {
+    std::vector<T> taken = std::move(buffer); // The caller's vector is empty either way
+    size_t capacity = taken.capacity();
+    if (capacity == 0) return;
+    taken.clear();
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    // Only exact classes come back (anything else was grown by hand somewhere), and the
+    // buckets stay small so the pool can't end up holding more than the meshes themselves
+    if (capacity != sizeClass(capacity) || buckets[capacity].size() >= MAX_BUFFERS_PER_CLASS) {
+        stats.dropped++;
+        return; // Freed on the way out
+    }
+
+    buckets[capacity].push_back(std::move(taken));
+    stats.recycled++;
+    stats.pooledBytes += capacity * sizeof(T);
+}
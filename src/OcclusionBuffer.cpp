@@ -0,0 +1,242 @@
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+ OcclusionBuffer::OcclusionBuffer(int width, int height)
+    : width((std::max(width, 4) + 3) & ~3), height(std::max(height, 1)) {
+    // Mip chain down to 1x1, level 0 is the depth buffer itself
+    int w = this->width, h = this->height;
+    while (true) {
+        Mip mip;
+        mip.width = w;
+        mip.height = h;
+        mip.depth.assign(static_cast<size_t>(w) * h, 1.0f);
+        mips.push_back(std::move(mip));
+        if (w == 1 && h == 1) break;
+        w = std::max(1, (w + 1) / 2);
+        h = std::max(1, (h + 1) / 2);
+    }
+}
+
+ void OcclusionBuffer::beginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition) {
+    this->viewProjection = viewProjection;
+    this->cameraPosition = cameraPosition;
+    triangles.clear();
+    std::fill(mips[0].depth.begin(), mips[0].depth.end(), 1.0f);
+}
+
+ void OcclusionBuffer::addOccluder(const glm::vec3& min, const glm::vec3& max) {
+    // Corner i : bit 0 -> x, bit 1 -> y, bit 2 -> z (0 = min, 1 = max)
+    glm::vec4 clip[8];
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        clip[i] = viewProjection * glm::vec4(corner, 1.0f);
+    }
+
+    // Only the faces the camera is in front of (at most 3)
+    if (cameraPosition.x < min.x) addQuad(clip, 0, 2, 6, 4);
+    else if (cameraPosition.x > max.x) addQuad(clip, 1, 5, 7, 3);
+    if (cameraPosition.y < min.y) addQuad(clip, 0, 4, 5, 1);
+    else if (cameraPosition.y > max.y) addQuad(clip, 2, 3, 7, 6);
+    if (cameraPosition.z < min.z) addQuad(clip, 0, 1, 3, 2);
+    else if (cameraPosition.z > max.z) addQuad(clip, 4, 6, 7, 5);
+}
+
+ void OcclusionBuffer::addQuad(const glm::vec4 clip[8], int a, int b, int c, int d) {
+    addTriangle(clip[a], clip[b], clip[c]);
+    addTriangle(clip[a], clip[c], clip[d]);
+}
+
+ void OcclusionBuffer::addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    // No near plane clipping : a triangle crossing it just isn't an occluder
+    const glm::vec4* clip[3] = { &a, &b, &c };
+    Triangle tri;
+    float z[3];
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& v = *clip[i];
+        if (v.w <= 0.0f || v.z < -v.w) return;
+        float invW = 1.0f / v.w;
+        tri.v[i] = glm::vec2((v.x * invW * 0.5f + 0.5f) * width, (v.y * invW * 0.5f + 0.5f) * height);
+        z[i] = v.z * invW * 0.5f + 0.5f;
+    }
+
+    glm::vec2 d1 = tri.v[1] - tri.v[0];
+    glm::vec2 d2 = tri.v[2] - tri.v[0];
+    float area = d1.x * d2.y - d2.x * d1.y;
+    if (std::abs(area) < 1e-6f) return;
+    if (area < 0.0f) {
+        std::swap(tri.v[1], tri.v[2]);
+        std::swap(z[1], z[2]);
+        std::swap(d1, d2);
+        area = -area;
+    }
+
+    float dz1 = z[1] - z[0];
+    float dz2 = z[2] - z[0];
+    tri.z0 = z[0];
+    tri.dzdx = (dz1 * d2.y - dz2 * d1.y) / area;
+    tri.dzdy = (dz2 * d1.x - dz1 * d2.x) / area;
+
+    // Rows whose pixel centres the triangle can cover
+    float minX = std::min({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+    float maxX = std::max({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+    float minY = std::min({ tri.v[0].y, tri.v[1].y, tri.v[2].y });
+    float maxY = std::max({ tri.v[0].y, tri.v[1].y, tri.v[2].y });
+    if (maxX < 0.0f || minX > static_cast<float>(width)) return;
+    tri.minY = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+    tri.maxY = std::min(height - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+    if (tri.minY > tri.maxY) return;
+
+    triangles.push_back(tri);
+}
+
+ void OcclusionBuffer::rasterize(int threadCount) {
+    threadCount = std::max(1, std::min(threadCount, height));
+    if (threadCount == 1) {
+        rasterizeBand(0, height);
+        return;
+    }
+
+    // One band of rows per thread, the calling thread takes the last one
+    int rowsPerBand = (height + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    for (int band = 0; band < threadCount - 1; band++) {
+        int begin = band * rowsPerBand;
+        workers.emplace_back([this, begin, rowsPerBand]() { rasterizeBand(begin, std::min(height, begin + rowsPerBand)); });
+    }
+    rasterizeBand((threadCount - 1) * rowsPerBand, height);
+    for (auto& worker : workers) worker.join();
+}
+
+ void OcclusionBuffer::rasterizeBand(int rowBegin, int rowEnd) {
+    float* depth = mips[0].depth.data();
+
+    for (const Triangle& tri : triangles) {
+        int firstRow = std::max(tri.minY, rowBegin);
+        int lastRow = std::min(tri.maxY, rowEnd - 1);
+        if (firstRow > lastRow) continue;
+
+        // Edge i goes v[i] -> v[i+1], E(p) = A*x + B*y + C >= 0 inside (counter-clockwise)
+        float A[3], B[3], C[3];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec2& from = tri.v[i];
+            const glm::vec2& to = tri.v[(i + 1) % 3];
+            A[i] = -(to.y - from.y);
+            B[i] = to.x - from.x;
+            C[i] = -(A[i] * from.x + B[i] * from.y);
+        }
+
+        float minX = std::min({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+        float maxX = std::max({ tri.v[0].x, tri.v[1].x, tri.v[2].x });
+        int firstColumn = std::max(0, static_cast<int>(std::ceil(minX - 0.5f))) & ~3;
+        int lastColumn = std::min(width - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+
+        for (int row = firstRow; row <= lastRow; row++) {
+            float py = row + 0.5f;
+            float* line = depth + static_cast<size_t>(row) * width;
+#ifdef OCCLUSION_SSE
+            __m128 rowE[3], stepE[3], a[3];
+            for (int i = 0; i < 3; i++) {
+                a[i] = _mm_set1_ps(A[i]);
+                rowE[i] = _mm_set1_ps(B[i] * py + C[i]);
+                stepE[i] = _mm_set1_ps(A[i] * 4.0f);
+            }
+            const __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 dzdx = _mm_set1_ps(tri.dzdx);
+            const __m128 zRow = _mm_set1_ps(tri.z0 + tri.dzdy * (py - tri.v[0].y) - tri.dzdx * tri.v[0].x);
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(firstColumn)), laneX);
+            __m128 e0 = _mm_add_ps(rowE[0], _mm_mul_ps(a[0], px));
+            __m128 e1 = _mm_add_ps(rowE[1], _mm_mul_ps(a[1], px));
+            __m128 e2 = _mm_add_ps(rowE[2], _mm_mul_ps(a[2], px));
+            __m128 z = _mm_add_ps(zRow, _mm_mul_ps(dzdx, px));
+            const __m128 stepZ = _mm_set1_ps(tri.dzdx * 4.0f);
+            for (int x = firstColumn; x <= lastColumn; x += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside)) {
+                    __m128 current = _mm_loadu_ps(line + x);
+                    __m128 nearer = _mm_min_ps(current, z);
+                    _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+                }
+                e0 = _mm_add_ps(e0, stepE[0]);
+                e1 = _mm_add_ps(e1, stepE[1]);
+                e2 = _mm_add_ps(e2, stepE[2]);
+                z = _mm_add_ps(z, stepZ);
+            }
+#else
+            for (int x = firstColumn; x <= lastColumn; x++) {
+                float px = x + 0.5f;
+                if (A[0] * px + B[0] * py + C[0] < 0.0f) continue;
+                if (A[1] * px + B[1] * py + C[1] < 0.0f) continue;
+                if (A[2] * px + B[2] * py + C[2] < 0.0f) continue;
+                float z = tri.z0 + tri.dzdx * (px - tri.v[0].x) + tri.dzdy * (py - tri.v[0].y);
+                line[x] = std::min(line[x], z);
+            }
+#endif
+        }
+    }
+}
+
+ void OcclusionBuffer::buildHiZ() {
+    // Every texel keeps the farthest depth under it, so "nearer than the texel" means maybe visible
+    for (size_t level = 1; level < mips.size(); level++) {
+        const Mip& src = mips[level - 1];
+        Mip& dst = mips[level];
+        for (int y = 0; y < dst.height; y++) {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; x++) {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                dst.depth[static_cast<size_t>(y) * dst.width + x] = std::max(
+                    std::max(src.depth[static_cast<size_t>(y0) * src.width + x0], src.depth[static_cast<size_t>(y0) * src.width + x1]),
+                    std::max(src.depth[static_cast<size_t>(y1) * src.width + x0], src.depth[static_cast<size_t>(y1) * src.width + x1]));
+            }
+        }
+    }
+}
+
+ bool OcclusionBuffer::isVisible(const glm::vec3& min, const glm::vec3& max) const {
+    glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w) return true; // Crosses the near plane
+        float invW = 1.0f / clip.w;
+        glm::vec2 screen((clip.x * invW * 0.5f + 0.5f) * width, (clip.y * invW * 0.5f + 0.5f) * height);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearest = std::min(nearest, clip.z * invW * 0.5f + 0.5f);
+    }
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= width || screenMin.y >= height) return true; // Frustum's call
+
+    // Every pixel the rect touches, not only the centres
+    int x0 = std::max(0, static_cast<int>(std::floor(screenMin.x)));
+    int y0 = std::max(0, static_cast<int>(std::floor(screenMin.y)));
+    int x1 = std::min(width - 1, static_cast<int>(std::floor(screenMax.x)));
+    int y1 = std::min(height - 1, static_cast<int>(std::floor(screenMax.y)));
+
+    // Coarsest level where the rect is at most ~4 texels across
+    int level = 0;
+    int span = std::max(x1 - x0, y1 - y0) + 1;
+    while (span > 4 && level + 1 < static_cast<int>(mips.size())) {
+        span = (span + 1) / 2;
+        level++;
+    }
+
+    const Mip& mip = mips[level];
+    for (int y = y0 >> level; y <= (y1 >> level); y++) {
+        for (int x = x0 >> level; x <= (x1 >> level); x++) {
+            if (nearest <= mip.depth[static_cast<size_t>(y) * mip.width + x]) return true;
+        }
+    }
+    return false;
+}
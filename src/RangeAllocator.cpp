@@ -0,0 +1,108 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+
+ RangeAllocator::RangeAllocator(uint32_t capacity, uint32_t alignment) : alignment(std::max(1u, alignment)) {
+    reset(capacity);
+}
+
+ void RangeAllocator::reset(uint32_t capacity) {
+    freeByOffset.clear();
+    freeBySize.clear();
+    this->capacity = capacity;
+    used = 0;
+    stats = Stats{};
+    if (capacity > 0) insertFree(0, capacity);
+}
+
+ RangeAllocator::Range RangeAllocator::allocate(uint32_t size) {
+    if (size == 0) return Range{};
+    uint32_t aligned = (size + alignment - 1) / alignment * alignment;
+
+    // Smallest block that fits, lowest offset among equal sizes
+    auto fit = freeBySize.lower_bound({ aligned, 0 });
+    if (fit == freeBySize.end()) {
+        stats.failures++;
+        return Range{};
+    }
+
+    uint32_t blockSize = fit->first;
+    uint32_t offset = fit->second;
+    eraseFree(freeByOffset.find(offset));
+    if (blockSize > aligned) insertFree(offset + aligned, blockSize - aligned);
+
+    used += aligned;
+    stats.allocations++;
+    return Range{ offset, aligned };
+}
+
+ void RangeAllocator::free(Range& range) {
+    if (!range.valid()) return;
+    uint32_t offset = range.offset;
+    uint32_t size = range.size;
+    used -= range.size;
+    range = Range{};
+
+    // Merge with the free blocks right after and right before
+    auto next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.end() && next->first == offset + size) {
+        size += next->second;
+        eraseFree(next);
+    }
+    auto after = freeByOffset.lower_bound(offset);
+    if (after != freeByOffset.begin()) {
+        auto previous = std::prev(after);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseFree(previous);
+        }
+    }
+    insertFree(offset, size);
+    stats.frees++;
+}
+
+ void RangeAllocator::grow(uint32_t newCapacity) {
+    if (newCapacity <= capacity) return;
+    uint32_t offset = capacity;
+    uint32_t size = newCapacity - capacity;
+    capacity = newCapacity;
+
+    // Free block running up to the old end -> it just gets longer
+    if (!freeByOffset.empty()) {
+        auto last = std::prev(freeByOffset.end());
+        if (last->first + last->second == offset) {
+            offset = last->first;
+            size += last->second;
+            eraseFree(last);
+        }
+    }
+    insertFree(offset, size);
+}
+
+ uint32_t RangeAllocator::getLargestFreeBlock() const {
+    return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+ double RangeAllocator::getFragmentation() const {
+    uint32_t freeSpace = capacity - used;
+    if (freeSpace == 0) return 0.0;
+    return 1.0 - static_cast<double>(getLargestFreeBlock()) / freeSpace;
+}
+
+ RangeAllocator::Stats RangeAllocator::getStats() const {
+    Stats result = stats;
+    result.used = used;
+    result.freeBlocks = static_cast<uint32_t>(freeByOffset.size());
+    result.largestFreeBlock = getLargestFreeBlock();
+    return result;
+}
+
+ void RangeAllocator::insertFree(uint32_t offset, uint32_t size) {
+    freeByOffset.emplace(offset, size);
+    freeBySize.emplace(size, offset);
+}
+
+ void RangeAllocator::eraseFree(std::map<uint32_t, uint32_t>::iterator block) {
+    freeBySize.erase({ block->second, block->first });
+    freeByOffset.erase(block);
+}
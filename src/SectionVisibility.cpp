@@ -0,0 +1,92 @@
+#include "SectionVisibility.h"
+#include "Chunk.h"
+#include <array>
+#include <utility>
+
+namespace {
+    constexpr int S = CHUNK_SECTION_SIZE;
+    constexpr int CELLS = S * S * S;
+
+    // Local cell index inside the section, x fastest
+    inline int cellIndex(int x, int y, int z) { return (y * S + z) * S + x; }
+}
+
+ int SectionVisibility::pairBit(int faceA, int faceB) {
+    if (faceA > faceB) std::swap(faceA, faceB);
+    // Pairs (a,b) a<b in order : (0,1)..(0,5) , (1,2)..(1,5) , ...
+    static const int firstOfRow[FACE_COUNT] = { 0, 5, 9, 12, 14, 15 };
+    return firstOfRow[faceA] + (faceB - faceA - 1);
+}
+
+ bool SectionVisibility::connected(uint16_t mask, int faceA, int faceB) {
+    if (faceA == faceB) return true;
+    return (mask >> pairBit(faceA, faceB)) & 1;
+}
+
+ uint16_t SectionVisibility::compute(const Chunk& chunk, int section, bool* fullyOpaque) {
+    // Per thread scratch, the mesher runs on the streaming thread and the remesh workers
+    thread_local std::array<uint8_t, CELLS> open;
+    thread_local std::array<uint8_t, CELLS> visited;
+    thread_local std::array<uint16_t, CELLS> stack;
+
+    const int baseY = section * S;
+    int openCount = 0;
+    for (int y = 0; y < S; y++) {
+        for (int z = 0; z < S; z++) {
+            for (int x = 0; x < S; x++) {
+                bool isOpen = !Block::occludesView(chunk.getBlockType(x, z, baseY + y));
+                open[cellIndex(x, y, z)] = isOpen;
+                openCount += isOpen;
+            }
+        }
+    }
+    if (fullyOpaque) *fullyOpaque = openCount == 0;
+    if (openCount == CELLS) return ALL_CONNECTED;
+    if (openCount == 0) return NONE_CONNECTED;
+
+    visited.fill(0);
+    uint16_t mask = NONE_CONNECTED;
+    for (int start = 0; start < CELLS; start++) {
+        if (!open[start] || visited[start]) continue;
+
+        // 1) Flood the region, collecting the section faces it touches
+        uint8_t faces = 0;
+        int top = 0;
+        stack[top++] = static_cast<uint16_t>(start);
+        visited[start] = 1;
+        while (top > 0) {
+            int cell = stack[--top];
+            int x = cell % S, z = (cell / S) % S, y = cell / (S * S);
+
+            if (z == S - 1) faces |= 1 << 0; // North
+            if (z == 0)     faces |= 1 << 1; // South
+            if (x == S - 1) faces |= 1 << 2; // East
+            if (x == 0)     faces |= 1 << 3; // West
+            if (y == S - 1) faces |= 1 << 4; // Up
+            if (y == 0)     faces |= 1 << 5; // Down
+
+            auto visit = [&](int next) {
+                if (open[next] && !visited[next]) {
+                    visited[next] = 1;
+                    stack[top++] = static_cast<uint16_t>(next);
+                }
+            };
+            if (x > 0) visit(cell - 1);
+            if (x < S - 1) visit(cell + 1);
+            if (z > 0) visit(cell - S);
+            if (z < S - 1) visit(cell + S);
+            if (y > 0) visit(cell - S * S);
+            if (y < S - 1) visit(cell + S * S);
+        }
+
+        // 2) Every pair of faces the region touches can see each other
+        for (int a = 0; a < FACE_COUNT; a++) {
+            if (!(faces & (1 << a))) continue;
+            for (int b = a + 1; b < FACE_COUNT; b++) {
+                if (faces & (1 << b)) mask |= 1u << pairBit(a, b);
+            }
+        }
+        if (mask == ALL_CONNECTED) break;
+    }
+    return mask;
+}
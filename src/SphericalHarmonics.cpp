@@ -0,0 +1,157 @@
+#include "SphericalHarmonics.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SH_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Basis constants of the real SH, squared below (once to project, once to evaluate)
+const double K0 = 0.282095;  // l = 0
+const double K1 = 0.488603;  // l = 1
+const double K2 = 1.092548;  // xy, yz, xz
+const double K20 = 0.315392; // 3z^2 - 1
+const double K22 = 0.546274; // x^2 - y^2
+
+// Cosine lobe convolution per band divided by PI (A0 = PI, A1 = 2PI/3, A2 = PI/4)
+const double A0 = 1.0, A1 = 2.0 / 3.0, A2 = 0.25;
+
+// Per row the direction only changes with x / z (y is the latitude), so a row is 6 sums of
+// radiance weighted by 1, x, z, xz, z^2, x^2 and the 9 basis sums are built from those
+enum RowSum { S_1, S_X, S_Z, S_XZ, S_ZZ, S_XX, ROW_SUMS };
+
+struct Sums {
+    double basis[9][3] = {};
+};
+
+void addRow(Sums& sums, const float rowSums[ROW_SUMS][3], double y, double weight) {
+    for (int c = 0; c < 3; c++) {
+        double s = rowSums[S_1][c];
+        sums.basis[0][c] += weight * s;
+        sums.basis[1][c] += weight * y * s;
+        sums.basis[2][c] += weight * rowSums[S_Z][c];
+        sums.basis[3][c] += weight * rowSums[S_X][c];
+        sums.basis[4][c] += weight * y * rowSums[S_X][c];
+        sums.basis[5][c] += weight * y * rowSums[S_Z][c];
+        sums.basis[6][c] += weight * (3.0 * rowSums[S_ZZ][c] - s);
+        sums.basis[7][c] += weight * rowSums[S_XZ][c];
+        sums.basis[8][c] += weight * (rowSums[S_XX][c] - y * y * s);
+    }
+}
+
+void projectBand(const float* rgb, int width, int height, int rowBegin, int rowEnd,
+    const std::vector<float>& cosPhi, const std::vector<float>& sinPhi, Sums& sums) {
+    const double pixelArea = (2.0 * PI / width) * (PI / height);
+    const float maxRadiance = IrradianceSH::MAX_RADIANCE;
+
+    for (int row = rowBegin; row < rowEnd; row++) {
+        double latitude = ((row + 0.5) / height - 0.5) * PI;
+        float cosLat = static_cast<float>(std::cos(latitude));
+        const float* line = rgb + static_cast<size_t>(row) * width * 3;
+        float rowSums[ROW_SUMS][3] = {};
+
+        int x = 0;
+#ifdef SH_SSE
+        __m128 acc[ROW_SUMS][3];
+        for (int s = 0; s < ROW_SUMS; s++)
+            for (int c = 0; c < 3; c++) acc[s][c] = _mm_setzero_ps();
+        const __m128 cl = _mm_set1_ps(cosLat);
+        const __m128 cap = _mm_set1_ps(maxRadiance);
+        for (; x + 4 <= width; x += 4) {
+            __m128 dx = _mm_mul_ps(cl, _mm_loadu_ps(&cosPhi[x]));
+            __m128 dz = _mm_mul_ps(cl, _mm_loadu_ps(&sinPhi[x]));
+            __m128 weights[ROW_SUMS] = { _mm_set1_ps(1.0f), dx, dz, _mm_mul_ps(dx, dz), _mm_mul_ps(dz, dz), _mm_mul_ps(dx, dx) };
+            const float* p = line + x * 3;
+            __m128 color[3] = {
+                _mm_min_ps(_mm_setr_ps(p[0], p[3], p[6], p[9]), cap),
+                _mm_min_ps(_mm_setr_ps(p[1], p[4], p[7], p[10]), cap),
+                _mm_min_ps(_mm_setr_ps(p[2], p[5], p[8], p[11]), cap)
+            };
+            for (int s = 0; s < ROW_SUMS; s++)
+                for (int c = 0; c < 3; c++) acc[s][c] = _mm_add_ps(acc[s][c], _mm_mul_ps(weights[s], color[c]));
+        }
+        for (int s = 0; s < ROW_SUMS; s++) {
+            for (int c = 0; c < 3; c++) {
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, acc[s][c]);
+                rowSums[s][c] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            }
+        }
+#endif
+        // Scalar tail (everything without SSE)
+        for (; x < width; x++) {
+            float dx = cosLat * cosPhi[x];
+            float dz = cosLat * sinPhi[x];
+            float weights[ROW_SUMS] = { 1.0f, dx, dz, dx * dz, dz * dz, dx * dx };
+            for (int c = 0; c < 3; c++) {
+                float radiance = std::min(line[x * 3 + c], maxRadiance);
+                for (int s = 0; s < ROW_SUMS; s++) rowSums[s][c] += weights[s] * radiance;
+            }
+        }
+
+        addRow(sums, rowSums, std::sin(latitude), pixelArea * cosLat);
+    }
+}
+
+}
+
+ IrradianceSH IrradianceSH::fromEquirect(const float* rgb, int width, int height, int threadCount) {
+    IrradianceSH result;
+    if (!rgb || width <= 0 || height <= 0) return result;
+
+    // Longitude only depends on the column, shared by every row
+    std::vector<float> cosPhi(width), sinPhi(width);
+    for (int x = 0; x < width; x++) {
+        double phi = ((x + 0.5) / width - 0.5) * 2.0 * PI;
+        cosPhi[x] = static_cast<float>(std::cos(phi));
+        sinPhi[x] = static_cast<float>(std::sin(phi));
+    }
+
+    // One band of rows per thread, the calling thread takes the last one
+    threadCount = std::max(1, std::min(threadCount, height));
+    int rowsPerBand = (height + threadCount - 1) / threadCount;
+    std::vector<Sums> bands(threadCount);
+    std::vector<std::thread> workers;
+    for (int band = 0; band < threadCount - 1; band++) {
+        int begin = std::min(height, band * rowsPerBand);
+        int end = std::min(height, begin + rowsPerBand);
+        workers.emplace_back([&, begin, end, band]() { projectBand(rgb, width, height, begin, end, cosPhi, sinPhi, bands[band]); });
+    }
+    projectBand(rgb, width, height, std::min(height, (threadCount - 1) * rowsPerBand), height, cosPhi, sinPhi, bands.back());
+    for (auto& worker : workers) worker.join();
+
+    Sums total;
+    for (const Sums& band : bands)
+        for (int k = 0; k < 9; k++)
+            for (int c = 0; c < 3; c++) total.basis[k][c] += band.basis[k][c];
+
+    // Projection K * sum, convolution A / PI, evaluation K again
+    const double scale[9] = {
+        A0 * K0 * K0,
+        A1 * K1 * K1, A1 * K1 * K1, A1 * K1 * K1,
+        A2 * K2 * K2, A2 * K2 * K2, A2 * K20 * K20, A2 * K2 * K2, A2 * K22 * K22
+    };
+    for (int k = 0; k < 9; k++) {
+        result.coefficients[k] = glm::vec3(
+            static_cast<float>(total.basis[k][0] * scale[k]),
+            static_cast<float>(total.basis[k][1] * scale[k]),
+            static_cast<float>(total.basis[k][2] * scale[k]));
+    }
+    return result;
+}
+
+ glm::vec3 IrradianceSH::evaluate(const glm::vec3& n) const {
+    // Same polynomials as skyIrradiance() in the shaders
+    glm::vec3 result = coefficients[0]
+        + coefficients[1] * n.y + coefficients[2] * n.z + coefficients[3] * n.x
+        + coefficients[4] * (n.x * n.y) + coefficients[5] * (n.y * n.z) + coefficients[6] * (3.0f * n.z * n.z - 1.0f)
+        + coefficients[7] * (n.x * n.z) + coefficients[8] * (n.x * n.x - n.y * n.y);
+    return glm::max(result, glm::vec3(0.0f)); // Ringing can dip under zero opposite a bright sun
+}
@@ -17,15 +17,25 @@
 #include "Block.h"
 #include "Chunk.h"
 #include "World.h"
+#include "ChunkRenderer.h"
+#include "ChunkCuller.h"
 #include "TextRenderer.h"
 #include "glm/ext.hpp"
 #include "Entity.h"
+#ifdef _MSC_VER
 #include <crtdbg.h>
+#endif
 //#include <vld.h> Visual leak detector, add this on your own for memory leak detection
 #include "Animator.h"
+#include "AnimationScheduler.h"
+#include "BonePaletteBuffer.h"
 #define GLFW_MOUSE_BUTTON_LEFT   GLFW_MOUSE_BUTTON_1
 
 #include "RenderEngine.h"
+#include "IBLCache.h"
+#include "AssetLoader.h"
+#include "SphericalHarmonics.h"
+#include <cstring>
 enum RENDER_PHASE {
     WORLD_3D,
     UI
@@ -47,6 +57,16 @@ GLuint FBO, rectVAO, rectVBO;
 GLuint colorTexture;  // renamed from fbt for clarity
 GLuint RBO;
 
+// Baked IBL maps (IBLCache.h), run with --no-ibl-cache to time a launch that bakes them,
+// --no-shader-cache for one that compiles every program (binary cache in Shaders.h) and
+// --no-model-cache for one that imports the models through Assimp (ModelCache.h),
+// --quantize-clips stores the clip rotations as snorm16 (AnimationClip::compile)
+// and --crowd N adds N animated Steves next to the player (AnimationScheduler + BonePaletteBuffer)
+const char* IBL_CACHE_PATH = "./ibl_cache/sky.ibl";
+const double ASSET_UPLOAD_BUDGET_MS = 4.0; // Main thread GL uploads per loading frame
+const float CROWD_SPACING = 2.0f;
+const GLuint BONE_PALETTES_UNIT = 9;
+
 void setupFramebuffer(int width, int height) {
     // Create and bind framebuffer
     glGenFramebuffers(1, &FBO);
@@ -89,6 +109,8 @@ Camera* g_camera = nullptr;
 //ChunkManager* g_chunkManager = nullptr;
 Block::Type currentBlockType = Block::Type::STONE;
 World world;
+ChunkRenderer chunkRenderer;
+ChunkCuller chunkCuller;
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     if (action == GLFW_PRESS) {
         glm::vec3 rayStart = g_camera->position;
@@ -102,31 +124,13 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
         if (result.hit) {
             std::cout << "Block hit \n";
 
-            // Convert chunk position to glm::ivec3 for proper subtraction
-            glm::ivec3 chunkPosition = result.hitChunk->getPosition();
-
+            // World::editBlock relights, then the mesh is rebuilt off thread and uploaded by World::updateChunks
             if (button == GLFW_MOUSE_BUTTON_LEFT) {
-                // Get local position by subtracting the chunk position
-                glm::ivec3 localBlockPos = result.blockPos - chunkPosition;
-
-                result.hitChunk->setBlockAtLocalPos(
-                    localBlockPos,
-                    Block::Type::AIR
-                );
-                world.markChunkAndNeighborsDirty(result.hitChunk , result.hitChunk->getPosition());
-                result.hitChunk->generateMeshData();
-                result.hitChunk->uploadToGPU();
+                world.editBlock(result.blockPos, Block::Type::AIR);
             }
             else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-                // Get local position by subtracting the chunk position
-                glm::ivec3 localBlockPos = result.previousPos - chunkPosition;
-
-                result.hitChunk->setBlockAtLocalPos(
-                    localBlockPos,
-                    currentBlockType
-                );
-                result.hitChunk->generateMeshData();
-                result.hitChunk->uploadToGPU();
+                // The placed block can be in the chunk next to the hit one, editBlock resolves it from the world position
+                world.editBlock(result.previousPos, currentBlockType);
             }
         }
     }
@@ -168,8 +172,18 @@ enum class View {
     TPP = 1
 };
 
-int main()
+int main(int argc, char** argv)
 {
+    auto startupStart = std::chrono::steady_clock::now();
+    bool useIBLCache = true;
+    int crowdSize = 0;
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--no-ibl-cache") == 0) useIBLCache = false;
+        else if (std::strcmp(argv[i], "--no-shader-cache") == 0) Shader::binaryCacheEnabled = false;
+        else if (std::strcmp(argv[i], "--no-model-cache") == 0) ModelCache::bakeEnabled = false;
+        else if (std::strcmp(argv[i], "--quantize-clips") == 0) Animation::compileOptions.quantizeRotations = true;
+        else if (std::strcmp(argv[i], "--crowd") == 0 && i + 1 < argc) crowdSize = std::max(0, std::atoi(argv[++i]));
+
     RenderEngine game;
     auto current_path = std::filesystem::current_path();
     glfwInit();
@@ -192,7 +206,35 @@ int main()
 
     // Enable depth testing for 3D rendering
     glEnable(GL_DEPTH_TEST);
-  
+
+    // Images / font / model decode on the loader's workers while this thread compiles shaders
+    // and bakes the IBL, the GL uploads happen in assets.finish() right before the main loop
+    AssetLoader assets;
+    auto texturePath = [&](const char* name) { return (current_path / "Resources" / "textures" / name).string(); };
+    auto loadTexture = [&](TextureImp& texture, const std::string& path, const std::string& type) {
+        assets.add(std::filesystem::path(path).filename().string(), [&texture, path, type]() {
+            auto image = std::make_shared<TextureImp::ImageData>(TextureImp::decodeImage(path, true));
+            return AssetLoader::UploadStep([&texture, image, type]() { texture.upload(*image, type); });
+            });
+    };
+    TextureImp textureAtlas, textureAtlasnrml, textureAtlasRM, crosshair;
+    loadTexture(textureAtlas, texturePath("Atlas32.png"), "diffuse");
+    loadTexture(textureAtlasnrml, texturePath("Atlas32nrml.png"), "normal");
+    loadTexture(textureAtlasRM, texturePath("Atlas32RM.png"), "roughness_metallic");
+    loadTexture(crosshair, texturePath("crosshair.png"), "diffuse");
+
+    Model mesh;
+    Animation steve_walk, steve_idle, steve_interact;
+    assets.add("Steve.gltf", [&]() {
+        const std::string path = "Resources/models/Steve.gltf";
+        mesh.Import(path);
+        // Same ModelData as the mesh, the file is only imported (or read from its bake) once
+        steve_walk = Animation(path, 2);
+        steve_idle = Animation(path, 1);
+        steve_interact = Animation(path, 0);
+        return AssetLoader::UploadStep([&mesh]() { mesh.Upload(); });
+        });
+
 
     // Load and compile shaders
     Shader shader(
@@ -227,38 +269,15 @@ int main()
         (current_path / "Resources" / "Shaders" / "skybox.vert").string().c_str(),
         (current_path / "Resources" / "Shaders" / "skybox.frag").string().c_str()
     );
-    Shader irradianceShader(
-        (current_path / "Resources" / "Shaders" / "irradiance.vert").string().c_str(),
-        (current_path / "Resources" / "Shaders" / "irradiance.frag").string().c_str()
-    );
-    Shader HDRIShader(
-		(current_path / "Resources" / "Shaders" / "Hdri.vert").string().c_str(),
-		(current_path / "Resources" / "Shaders" / "Hdri.frag").string().c_str()
-	);
-    Shader prefilterShader(
-		(current_path / "Resources" / "Shaders" / "prefilter.vert").string().c_str(),
-		(current_path / "Resources" / "Shaders" / "prefilter.frag").string().c_str()
-	);
-    Shader brdfShader(
-        (current_path / "Resources" / "Shaders" / "brdf.vert").string().c_str(),
-        (current_path / "Resources" / "Shaders" / "brdf.frag").string().c_str()
-        );
-
-    TextRenderer Text(
-        TextShader,
-        (current_path / "Resources" / "fonts" / "Minecraft.ttf").string().c_str(),
-        16
 
-    );
+    // HUD quads + text of the frame, flushed once after the UI pass
+    SpriteBatch spriteBatch;
+    TextRenderer Text(TextShader, spriteBatch);
+    assets.add("Minecraft.ttf", [&Text, fontPath = (current_path / "Resources" / "fonts" / "Minecraft.ttf").string()]() {
+        auto font = std::make_shared<TextRenderer::FontAtlas>(TextRenderer::Rasterize(fontPath, 16));
+        return AssetLoader::UploadStep([&Text, font]() { Text.Upload(*font); });
+        });
     Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
-    
-    TextureImp textureAtlas((std::filesystem::current_path() / "Resources" / "textures" / "Atlas32.png").string().c_str(), "diffuse", true);
-    TextureImp textureAtlasnrml((std::filesystem::current_path() / "Resources" / "textures" / "Atlas32nrml.png").string().c_str(), "normal", true);
-    TextureImp textureAtlasRM((std::filesystem::current_path() / "Resources" / "textures" / "Atlas32RM.png").string().c_str(), "roughness_metallic" , true);
-    std::cout << "Texture ID: " << textureAtlas.ID << std::endl;
-    std::cout << "Texture ID: " << textureAtlasnrml.ID << std::endl;
-    std::cout << "Texture ID: " << textureAtlasRM.ID << std::endl;
-    TextureImp crosshair((std::filesystem::current_path() / "Resources" / "textures" / "crosshair.png").string().c_str(), "diffuse" , true);
 
     //Rectangle VAO and VBO
     glGenVertexArrays(1, &rectVAO);
@@ -282,8 +301,8 @@ int main()
     bool View_key_pressed = false;
     //------------------------//
    
+    world.setUploader(&chunkRenderer);
     world.inithread();
-    std::mutex chunksMutex;
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -299,28 +318,90 @@ int main()
     float boggle = 0.0f, amplitude = 0.05f;
     bool moving = false;
     std::cout << sizeof(Chunk) << "\n";
-    Model mesh("Resources/models/Steve.gltf");
-    Animation steve_walk("Resources/models/Steve.gltf" , &mesh ,2);
-    Animation steve_idle("Resources/models/Steve.gltf" , &mesh ,1);
-    Animation steve_interact("Resources/models/Steve.gltf" , &mesh ,0);
-    Animator animator;
-    animator.BlendAnimation(&steve_idle, 0.0f);
-    animator.BlendAnimation(&steve_walk, 1.0f);
-    animator.PlayAnimation(&steve_walk);
 
     //Cubemap setup
     unsigned int skyboxVAO, skyboxVBO, skyboxEBO;
-    unsigned int prefilterMap;
-    unsigned int hdrTexture = TextureImp::loadHDR("Resources/HDRI/sky.hdr");
-    unsigned int brdfLUTTexture;
     unsigned int cubemapTexture;
     game.setup_cubemap(&skyboxVAO, &skyboxVBO, &skyboxEBO, &cubemapTexture);
-    unsigned int rboDepth;
-    game.setup_depth_buffer(&rboDepth);
-    unsigned int envCubeMap, cubeFBO, irradianceMap;
-    game.setup_HDRI(&cubeFBO, &envCubeMap, &hdrTexture, &irradianceMap, HDRIShader, irradianceShader);
-    game.setup_prefilter_map(&prefilterMap,prefilterShader,&envCubeMap,&cubeFBO);
-    game.init_BRDF_lut(&brdfLUTTexture, &cubeFBO, &rboDepth, brdfShader);
+
+    // IBL maps, baked once then straight from the disk cache while the HDRI + baking shaders don't change
+    auto iblStart = std::chrono::steady_clock::now();
+    auto shaderPath = [&](const char* name) { return (current_path / "Resources" / "Shaders" / name).string(); };
+    uint64_t iblKey = IBLCache::computeKey({
+        "Resources/HDRI/sky.hdr",
+        shaderPath("Hdri.vert"), shaderPath("Hdri.frag"),
+        shaderPath("prefilter.vert"), shaderPath("prefilter.frag"),
+        shaderPath("brdf.vert"), shaderPath("brdf.frag")
+        });
+    IBLCache::Maps iblMaps;
+    bool iblCacheHit = useIBLCache && IBLCache::load(IBL_CACHE_PATH, iblKey, iblMaps);
+    if (!iblCacheHit) {
+        // Only compiled when there's something to bake
+        Shader HDRIShader(shaderPath("Hdri.vert").c_str(), shaderPath("Hdri.frag").c_str());
+        Shader prefilterShader(shaderPath("prefilter.vert").c_str(), shaderPath("prefilter.frag").c_str());
+        Shader brdfShader(shaderPath("brdf.vert").c_str(), shaderPath("brdf.frag").c_str());
+
+        TextureImp::HDRImage hdrImage = TextureImp::loadHDRImage("Resources/HDRI/sky.hdr");
+        unsigned int hdrTexture = TextureImp::uploadHDR(hdrImage);
+
+        // Diffuse sky light, SH9 projection of the HDRI pixels on every core
+        auto shStart = std::chrono::steady_clock::now();
+        int shThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        iblMaps.irradiance = IrradianceSH::fromEquirect(hdrImage.rgb.data(), hdrImage.width, hdrImage.height, shThreads);
+        std::cout << "Sky irradiance SH9 : " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shStart).count()
+            << " ms (" << hdrImage.width << "x" << hdrImage.height << ", " << shThreads << " threads)\n";
+
+        unsigned int rboDepth, cubeFBO;
+        game.setup_depth_buffer(&rboDepth);
+        game.setup_HDRI(&cubeFBO, &iblMaps.envCubeMap, &hdrTexture, HDRIShader);
+        game.setup_prefilter_map(&iblMaps.prefilterMap, prefilterShader, &iblMaps.envCubeMap, &cubeFBO);
+        game.init_BRDF_lut(&iblMaps.brdfLUT, &cubeFBO, &rboDepth, brdfShader);
+        if (useIBLCache) IBLCache::save(IBL_CACHE_PATH, iblKey, iblMaps);
+
+        // Capture targets + source HDRI aren't needed once the maps are baked
+        glDeleteFramebuffers(1, &cubeFBO);
+        glDeleteRenderbuffers(1, &rboDepth);
+        glDeleteTextures(1, &hdrTexture);
+    }
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    unsigned int prefilterMap = iblMaps.prefilterMap, brdfLUTTexture = iblMaps.brdfLUT;
+    double iblMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - iblStart).count();
+    std::cout << "IBL maps : " << iblMs << " ms (" << (iblCacheHit ? "cache hit" : useIBLCache ? "cache miss, baked + saved" : "cache off, baked") << ")\n";
+
+    // Whatever is still decoding goes up here, a few ms of uploads per presented frame
+    assets.finish(ASSET_UPLOAD_BUDGET_MS, [&]() {
+        glfwPollEvents();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glfwSwapBuffers(window);
+        });
+    AssetLoader::Stats assetStats = assets.stats();
+    assets.printReport(std::cout);
+    ModelCacheStats modelStats = ModelCache::stats();
+    std::cout << "Models : " << modelStats.imported << " imported in " << modelStats.importMs << " ms, " << modelStats.baked
+        << " from bakes in " << modelStats.bakedMs << " ms, " << modelStats.shared << " shared\n";
+
+    Animator animator;
+    animator.BlendAnimation(&steve_idle, 0.0f);
+    animator.BlendAnimation(&steve_walk, 1.0f);
+    animator.PlayAnimation(&steve_walk);
+
+    // Crowd : a square of Steves next to the player, a third idling, the walkers spread over
+    // 8 phases (-> 8 poses to evaluate once everyone is due, the rest is shared)
+    std::vector<Animator> crowd(crowdSize);
+    std::vector<glm::mat4> crowdModels(crowdSize);
+    AnimationScheduler crowdScheduler(crowdSize > 0 ? 0 : 1);
+    BonePaletteBuffer crowdPalettes;
+    crowdPalettes.Create();
+    int crowdSide = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(crowdSize))));
+    for (int i = 0; i < crowdSize; i++) {
+        crowd[i].PlayAnimation(i % 3 == 0 ? &steve_idle : &steve_walk);
+        crowd[i].Advance((i % 8) * 0.1f);
+        glm::vec3 position = entity.getPosition() + glm::vec3(4.0f + (i % crowdSide) * CROWD_SPACING, 0.755f, (i / crowdSide) * CROWD_SPACING);
+        crowdModels[i] = glm::translate(glm::mat4(1.0f), position);
+        crowdScheduler.add(crowd[i].GetSkeleton());
+        crowdScheduler.setPosition(i, position);
+    }
 
  
     bool showDebug = true;
@@ -333,11 +414,66 @@ int main()
     float offsetHeight = 1.75f;    // Height above the player
     bool inWater = false;
     int debugMode = 1;
+    bool useVertexAO = true;
+    bool useVoxelLight = true;
+    bool frustumCulling = true;
+    bool caveCulling = true;
+    bool occlusionCulling = true;
+    chunkCuller.setOcclusionThreads(static_cast<int>(std::max(1u, std::min(4u, std::thread::hardware_concurrency()))));
+
+    // GPU time of the solid world pass, 2 queries so reading last frame's never stalls
+    GLuint worldPassQueries[2];
+    glGenQueries(2, worldPassQueries);
+    int queryFrame = 0;
+    double worldPassGpuMs = 0.0;
+    double timeToFirstFrameMs = 0.0; // Set after the first swap
+
+    // Camera / light data of the frame, one UBO read by the world, water and model programs
+    FrameUniformBuffer frameUniforms;
+    frameUniforms.Create();
+    FrameUniforms frameData;
+    size_t uniformCallsPerFrame = 0;
+
+    // Diffuse sky light (SH9 from the IBL setup), read by the world and model programs
+    SkyIrradianceBuffer skyIrradiance;
+    skyIrradiance.Create();
+    SkyIrradianceUniforms skyIrradianceData;
+    for (int k = 0; k < 9; k++) skyIrradianceData.coefficients[k] = glm::vec4(iblMaps.irradiance.coefficients[k], 0.0f);
+    skyIrradiance.Update(skyIrradianceData);
+
+    // Uniforms that never change, set once here instead of every frame
+    glm::mat4 identity = glm::mat4(1.0f);
+    shader.Use();
+    shader.SetUniformMatrix4fv("model", glm::value_ptr(identity)); // Chunk positions come from the per-draw offset attribute
+    shader.SetInt("texture_diffuse1", 1);
+    shader.SetInt("texture_normal1", 2);
+    shader.SetInt("texture_metallicRoughness1", 3);
+    shader.SetInt("prefilterMap", 7);
+    shader.SetInt("brdfLUT", 8);
+    Watershader.Use();
+    Watershader.SetUniformMatrix4fv("model", glm::value_ptr(identity));
+    Watershader.SetUniform1f("ambientStrength", 0.45f);
+    Watershader.SetUniform1f("diffuseStrength", 0.85f);
+    Watershader.SetUniform1f("specularStrength", 0.8f);
+    Watershader.SetUniform1f("shininess", 64.0f);
+    Watershader.SetInt("texture_diffuse", 1);
+    ModelShader.Use();
+    ModelShader.SetInt("prefilterMap", 7);
+    ModelShader.SetInt("brdfLUT", 8);
+    ModelShader.SetInt("bonePalettes", BONE_PALETTES_UNIT); // Own unit, a samplerBuffer can't share one with the sampler2Ds
+    SkyBoxShader.Use();
+    SkyBoxShader.SetInt("skybox", 0);
+    framebufferS.Use();
+    framebufferS.SetInt("screenTexture", 0);
+    TextShader.Use();
+    TextShader.SetUniform1i("text", 0);
 
     float TRANSITION_SPEED = 8.f;
     float targetBlendFactor = 0.0f;
     float blendFactor  = 0.0f;
     while (!glfwWindowShouldClose(window)) {
+        uniformCallsPerFrame = Shader::uniformCalls;
+        Shader::uniformCalls = 0;
         double currentTime = glfwGetTime();
         double elapsedTime = currentTime - lastTime; 
         lastTime = currentTime; 
@@ -520,29 +656,22 @@ int main()
 
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(fov), (float)width / height, 0.1f, 500.0f);
-        glm::mat4 model = glm::mat4(1.0f);
+
+        // One upload for every program reading FrameData
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.camPos = camera.position;
+        frameData.time = time;
+        frameData.lightDir = glm::vec3(lightDir[0], lightDir[1], lightDir[2]);
+        frameData.lightColor = glm::vec3(lightColor[0], lightColor[1], lightColor[2]);
+        frameUniforms.Update(frameData);
 
         shader.Use();
         shader.SetInt("debugMode", debugMode);
-        shader.SetUniformMatrix4fv("model", glm::value_ptr(model));
-        shader.SetUniformMatrix4fv("view", glm::value_ptr(view));
-        shader.SetUniformMatrix4fv("projection", glm::value_ptr(projection));
-        shader.SetUniform3f("lightPos", lightDir[0], lightDir[1], lightDir[2]); 
-        shader.SetUniform3f("lightColor",lightColor[0], lightColor[1], lightColor[2]); 
-        shader.SetUniform1f("ambientStrength", 0.45f); 
-        shader.SetUniform1f("diffuseStrength", 0.85f); 
-        shader.SetUniform1f("specularStrength", 0.8f);
-        shader.SetUniform1f("shininess", 32.0f);
-        shader.SetUniform3f("camPos", camera.position.x, camera.position.y , camera.position.z);
+        shader.SetInt("useVertexAO", useVertexAO);
+        shader.SetInt("useVoxelLight", useVoxelLight);
 
         // we Bind textures here ->
- 
-        shader.SetInt("texture_diffuse1", 1);
-        shader.SetInt("texture_normal1", 2);
-        shader.SetInt("texture_metallicRoughness1", 3);
-        shader.SetInt("irradianceMap", 6);
-        shader.SetInt("prefilterMap", 7);
-        shader.SetInt("brdfLUT", 8);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, textureAtlas.ID);
@@ -556,9 +685,6 @@ int main()
        /* glActiveTexture(GL_TEXTURE5); 
         glBindTexture(GL_TEXTURE_CUBE_MAP, envCubeMap);*/
 
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-
         glActiveTexture(GL_TEXTURE7);
         glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
 
@@ -574,52 +700,30 @@ int main()
         glEnable(GL_DEPTH_TEST);
         
         //----------------SOLID GEOMETRY-----------------//
-        auto chunkSnapshot = world.chunkCache;
-        for (const auto& entry : chunkSnapshot) {
-            std::lock_guard<std::mutex> lock2(chunksMutex);
-            if (entry.second.chunk->isActive()) {
-                if (entry.second.chunk && entry.second.chunk->isActive() && entry.second.chunk->isValid()) {
-                    /*if (entry.second.chunk.get()->hasAllNeighbours()) {
-                        std::cout << "This has all neightbours \n";
-                    }*/
-                    model = glm::translate(glm::mat4(1.0f), glm::vec3(entry.second.chunk->getPosition()));
-                    shader.SetUniformMatrix4fv("model", glm::value_ptr(model));
-                    entry.second.chunk->SolidBuffers.vao.Bind();
-                    glDrawElements(GL_TRIANGLES, entry.second.chunk->SolidMesh.indexcount, GL_UNSIGNED_INT, 0);
-                    entry.second.chunk->SolidBuffers.vao.Unbind();
-                }
-            }
-        }
+        glBeginQuery(GL_TIME_ELAPSED, worldPassQueries[queryFrame % 2]);
+        // Published by World::updateChunks, holding it keeps its chunks alive for the frame
+        std::shared_ptr<const RenderList> renderList = world.getRenderList();
+        // One visible list for both passes, culled per 16 high section (frustum + cave culling)
+        chunkCuller.setEnabled(frustumCulling);
+        chunkCuller.setCaveCulling(caveCulling);
+        chunkCuller.setOcclusionCulling(occlusionCulling);
+        const std::vector<VisibleChunk>& visibleChunks = chunkCuller.cull(projection * view, camera.position, renderList->chunks);
+
+        // Chunk positions come from the per-draw offset attribute, "model" stays identity
+        chunkRenderer.beginFrame();
+        chunkRenderer.drawSolid(visibleChunks);
+        glEndQuery(GL_TIME_ELAPSED);
+        if (queryFrame > 0) {
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(worldPassQueries[(queryFrame + 1) % 2], GL_QUERY_RESULT, &elapsedNs);
+            worldPassGpuMs = elapsedNs / 1e6;
+        }
+        queryFrame++;
 
         //-----------------LIQUID GEOMETRY-------------//   
         Watershader.Use();
-        Watershader.SetUniformMatrix4fv("model", glm::value_ptr(model));
-        Watershader.SetUniformMatrix4fv("view", glm::value_ptr(view));
-        Watershader.SetUniformMatrix4fv("projection", glm::value_ptr(projection));
-        Watershader.SetUniform3f("lightDir", lightDir[0], lightDir[1], lightDir[2]); 
-        Watershader.SetUniform3f("lightColor", lightColor[0], lightColor[1], lightColor[2]); 
-        Watershader.SetUniform1f("ambientStrength", 0.45f); 
-        Watershader.SetUniform1f("diffuseStrength", 0.85f); 
-        Watershader.SetUniform1f("specularStrength", 0.8f); 
-        Watershader.SetUniform1f("shininess", 64.0f);
-        Watershader.SetInt("texture_diffuse", 1);
-        Watershader.SetUniform1f("time" , time);
-
-        for (const auto& entry : chunkSnapshot) {
-            std::lock_guard<std::mutex> lock2(chunksMutex);
-            if (entry.second.chunk->isActive()) {
-                if (entry.second.chunk && entry.second.chunk->isActive() && entry.second.chunk->isValid()) {
-                    /*if (entry.second.chunk.get()->hasAllNeighbours()) {
-                        std::cout << "This has all neightbours \n";
-                    }*/
-                    model = glm::translate(glm::mat4(1.0f), glm::vec3(entry.second.chunk->getPosition()));
-                    shader.SetUniformMatrix4fv("model", glm::value_ptr(model));
-                    entry.second.chunk->LiquidBuffers.vao.Bind();
-                    glDrawElements(GL_TRIANGLES, entry.second.chunk->LiquidMesh.indexcount, GL_UNSIGNED_INT, 0);
-                    entry.second.chunk->LiquidBuffers.vao.Unbind();
-                }
-            }
-        }
+
+        chunkRenderer.drawLiquid(visibleChunks);
 
         // Model drawing pass //
         // TEMP TEST UPDATE SECTION //
@@ -643,44 +747,51 @@ int main()
         animator.BlendAnimation(&steve_idle, 1.0f - blendFactor);
         animator.BlendAnimation(&steve_walk, blendFactor);
         animator.UpdateAnimation(0.02f);
+
+        for (int i = 0; i < crowdSize; i++) {
+            crowd[i].Advance(0.02f);
+            const std::vector<PoseLayer>& layers = crowd[i].GetLayers();
+            crowdScheduler.setLayers(i, layers.data(), static_cast<int>(layers.size()));
+        }
+        if (crowdSize > 0) crowdScheduler.update(camera.position);
       
         // TEMP TEST UPDATE SECTION END //
         ModelShader.Use();
-        glActiveTexture(GL_TEXTURE6); // Irradiance
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
         glActiveTexture(GL_TEXTURE7); // Prefilter
         glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
         glActiveTexture(GL_TEXTURE8); // BRDF LUT
         glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-        ModelShader.SetInt("irradianceMap", 6);  // GL_TEXTURE0
-        ModelShader.SetInt("prefilterMap", 7);   // GL_TEXTURE1
-        ModelShader.SetInt("brdfLUT", 8);        // GL_TEXTURE2
-        glm::mat4 scale = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 1.0f, 1.0f));
         glm::mat4 Meshmodel = glm::mat4(1.0f);
         Meshmodel = glm::translate(Meshmodel, glm::vec3(entity.getPosition().x, entity.getPosition().y+0.755f, entity.getPosition().z));
         Meshmodel = glm::rotate(Meshmodel, glm::radians(rotation.y+90), glm::vec3(0.f, 1.f, 0.f));
         //Meshmodel = glm::rotate(Meshmodel, glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f));
-        ModelShader.SetUniform3f("camPos", camera.position.x, camera.position.y, camera.position.z);
-
-        glUniformMatrix4fv(glGetUniformLocation(ModelShader.ID, "model"), 1, GL_FALSE, glm::value_ptr(Meshmodel));
-        glUniformMatrix4fv(glGetUniformLocation(ModelShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(ModelShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(ModelShader.ID, "scale"), 1, GL_FALSE, glm::value_ptr(scale));
+        ModelShader.SetUniformMatrix4fv("model", glm::value_ptr(Meshmodel));
 
-       
-        glUniform3f(glGetUniformLocation(ModelShader.ID, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
-        auto transforms = animator.GetFinalBoneMatrices();
-        for (int i = 0; i < transforms.size(); ++i) {
-            ModelShader.SetUniformMatrix4fv("finalBonesMatrices[" + std::to_string(i) + "]", glm::value_ptr(transforms[i]));
+        // Whole palette in one call
+        const std::vector<glm::mat4>& transforms = animator.GetFinalBoneMatrices();
+        if (!transforms.empty()) {
+            ModelShader.SetUniformMatrix4fvArray("finalBonesMatrices", glm::value_ptr(transforms[0]), static_cast<GLsizei>(transforms.size()));
         }
         
         mesh.Draw(ModelShader);
+
+        // Whole crowd : every model matrix + palette in one buffer, one instanced draw per mesh
+        if (crowdSize > 0) {
+            crowdPalettes.Begin(crowdScheduler.getBoneCount(0));
+            for (int i = 0; i < crowdSize; i++)
+                crowdPalettes.Append(crowdModels[i], crowdScheduler.getPalette(i));
+            crowdPalettes.Upload();
+            crowdPalettes.Bind(BONE_PALETTES_UNIT);
+            ModelShader.SetUniform1i("instancedSkin", 1);
+            ModelShader.SetUniform1i("instanceStride", crowdPalettes.GetStride());
+            mesh.DrawInstanced(ModelShader, crowdPalettes.GetCount());
+            ModelShader.SetUniform1i("instancedSkin", 0);
+        }
         //-----Model drawing pass end-----//
 
         //-----Skybox drawing pass-----//
         glDepthFunc(GL_LEQUAL);
         SkyBoxShader.Use();
-        SkyBoxShader.SetInt("skybox", 0);
         glm::mat4 skyview = glm::mat4(1.0f);
         glm::mat4 skyprojection = glm::mat4(1.0f);
         skyview = glm::mat4(glm::mat3(glm::lookAt(camera.position, camera.position + camera.orientation, camera.worldUp)));
@@ -703,7 +814,6 @@ int main()
 
         // Screen texture stuff //
         glBindTexture(GL_TEXTURE_2D,colorTexture);  
-        framebufferS.SetInt("screenTexture", 0);
         glDrawArrays(GL_TRIANGLES, 0, 6);  /*Screen quad draw*/
         // Screen quad drawing end //
 
@@ -713,21 +823,19 @@ int main()
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glUniformMatrix4fv(glGetUniformLocation(uiShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projT));
-        crosshair.Draw(uiShader, glm::vec2((width/2) - 10, (height/2) - 10), glm::vec2(20.0f, 20.0f));
+        uiShader.SetUniformMatrix4fv("projection", glm::value_ptr(projT));
+        crosshair.Draw(spriteBatch, uiShader, glm::vec2((width/2) - 10, (height/2) - 10), glm::vec2(20.0f, 20.0f));
 
         TextShader.Use();
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glUniformMatrix4fv(glGetUniformLocation(TextShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projT));
-        TextShader.SetUniform1i("text", 0);
+        TextShader.SetUniformMatrix4fv("projection", glm::value_ptr(projT));
         if (showDebug) {
-            Text.RenderText("Player position : X = " + std::to_string(camera.position.x) + " | Y = " + std::to_string(camera.position.y) + " | Z = " + std::to_string(camera.position.z), 25.0f, 25.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-            Text.RenderText("Temprature value : " + std::to_string(world.temperatureNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 55.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-            Text.RenderText("Humidity value : " + std::to_string(world.HumidityNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 85.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-            Text.RenderText("Continentalness value : " + std::to_string(world.continentalnessNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 115.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-            Text.RenderText("World Seed : " + std::to_string(world.seed), 25.0f, 145.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+            Text.AddText("Player position : X = " + std::to_string(camera.position.x) + " | Y = " + std::to_string(camera.position.y) + " | Z = " + std::to_string(camera.position.z), 25.0f, 25.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+            Text.AddText("Temprature value : " + std::to_string(world.temperatureNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 55.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+            Text.AddText("Humidity value : " + std::to_string(world.HumidityNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 85.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+            Text.AddText("Continentalness value : " + std::to_string(world.continentalnessNoise.GetNoise(camera.position.x, camera.position.y, camera.position.z)), 25.0f, 115.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+            Text.AddText("World Seed : " + std::to_string(world.seed), 25.0f, 145.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
         }
+        spriteBatch.Flush(); // Crosshair + debug text : one draw per texture
         // IMGUI PASS //
         ImGui::Begin("Light Direction Controls");
         ImGui::SliderFloat("Light Dir X", &lightDir[0], -1.0f, 1.0f);
@@ -737,6 +845,14 @@ int main()
 
         ImGui::Begin("Chunks debug");
         ImGui::Text("Chunks cache: %d", world.chunkCache.size());
+        ImGui::Text("Render list : %zu chunks | version %llu", renderList->chunks.size(), static_cast<unsigned long long>(renderList->version));
+        ImGui::Checkbox("Frustum culling", &frustumCulling);
+        const ChunkCuller::Stats& cullStats = chunkCuller.getStats();
+        ImGui::Text("Chunks drawn : %zu | culled %zu", cullStats.chunksDrawn, cullStats.chunksCulled());
+        ImGui::Checkbox("Cave culling", &caveCulling);
+        ImGui::Checkbox("Occlusion culling", &occlusionCulling);
+        ImGui::Text("Slices drawn : %zu | culled %zu | occluded %zu | hidden %zu", cullStats.slicesDrawn, cullStats.slicesCulled(), cullStats.slicesOccluded, cullStats.slicesHidden);
+        ImGui::Text("Occlusion buffer : %zu tris | %.3f ms", cullStats.occluderTriangles, cullStats.occlusionMs);
         ImGui::SliderInt("Render distance" ,&world.renderDistance ,2 , 32 );
         ImGui::ColorEdit3("Ambient Light", lightColor);
         ImGui::End();
@@ -744,16 +860,48 @@ int main()
         ImGui::Begin("Entity debug");
         ImGui::Checkbox("Show player debug" , &showDebug);
         ImGui::Text("Entity position : X = %f | Y = %f | Z = %f", entity.getPosition().x, entity.getPosition().y, entity.getPosition().z);
+        const AnimationSchedulerStats& crowdStats = crowdScheduler.stats();
+        ImGui::Text("Crowd : %d | evaluated %d | shared %d | skipped %d | %.3f ms on %u threads", crowdStats.instances,
+            crowdStats.evaluated, crowdStats.shared, crowdStats.skipped, crowdStats.updateMs, crowdStats.threads + 1);
+        ImGui::Text("Crowd palettes : %.1f KB per frame", crowdPalettes.GetBytes() / 1024.0f);
         ImGui::End();
 
         ImGui::Begin("Debug Mode");
-        ImGui::SliderInt("Debug Mode", &debugMode, 1, 6);
+        ImGui::SliderInt("Debug Mode", &debugMode, 1, 7);
+        ImGui::Checkbox("Baked vertex AO", &useVertexAO);
+        ImGui::Checkbox("Voxel light", &useVoxelLight);
+        ImGui::Text("Solid pass GPU : %.3f ms", worldPassGpuMs);
+        ImGui::Text("Startup : first frame %.0f ms | IBL %.1f ms (%s)", timeToFirstFrameMs, iblMs, iblCacheHit ? "cache hit" : "baked");
+        ImGui::Text("Shaders : %zu cached (%.1f ms, %.1f ms saved) | %zu compiled (%.1f ms)", Shader::loadStats.fromBinary,
+            Shader::loadStats.binaryLoadMs, Shader::loadStats.savedMs, Shader::loadStats.compiled, Shader::loadStats.compileMs);
+        ImGui::Text("Assets : %zu in %.1f ms | decode %.1f ms on %u threads | upload %.1f ms", assetStats.assets, assetStats.wallMs,
+            assetStats.decodeMs, assetStats.threads, assetStats.uploadMs);
+        ImGui::Text("Models : %zu imported (%.1f ms) | %zu baked (%.1f ms) | %zu shared", modelStats.imported, modelStats.importMs,
+            modelStats.baked, modelStats.bakedMs, modelStats.shared);
+        ImGui::Text("Uniform calls : %zu / frame", uniformCallsPerFrame);
+        SpriteBatch::Stats spriteStats = spriteBatch.getStats();
+        ImGui::Text("UI batch : %zu quads | %zu draws | %zu buffer resizes", spriteStats.quads, spriteStats.draws, spriteStats.bufferResizes);
+        ChunkRenderer::Stats renderStats = chunkRenderer.getStats();
+        ImGui::Text("Chunk draws : %zu calls | %zu ranges | %s", renderStats.drawCalls, renderStats.ranges, chunkRenderer.usesIndirect() ? "multi-draw-indirect" : "per-range fallback");
+        ImGui::Text("Mesh arena : %.1f / %.1f M vertices | %.1f / %.1f M indices | frag %.2f | grown %zu",
+            renderStats.vertexArena.used / 1e6, renderStats.vertexCapacity / 1e6,
+            renderStats.indexArena.used / 1e6, renderStats.indexCapacity / 1e6,
+            renderStats.vertexFragmentation, renderStats.growths);
+        ChunkPool::Stats poolStats = world.getChunkPoolStats();
+        ImGui::Text("Chunk pool : %zu pooled | hit rate %.1f%% | dropped %zu", poolStats.pooled, poolStats.hitRate() * 100.0, poolStats.dropped);
         ImGui::End();
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         // IMGUI Pass end //
         glfwSwapBuffers(window);
+        if (timeToFirstFrameMs == 0.0) {
+            timeToFirstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart).count();
+            std::cout << "Time to first frame : " << timeToFirstFrameMs << " ms (IBL " << iblMs << " ms, "
+                << (iblCacheHit ? "cache hit" : "baked") << ", assets " << assetStats.wallMs << " ms)\n";
+            std::cout << "Shaders : " << Shader::loadStats.fromBinary << " programs from the binary cache in " << Shader::loadStats.binaryLoadMs
+                << " ms (" << Shader::loadStats.savedMs << " ms saved), " << Shader::loadStats.compiled << " compiled in " << Shader::loadStats.compileMs << " ms\n";
+        }
         glfwPollEvents();
         //_CrtDumpMemoryLeaks();
         //std::cout << "Size of the cache :" << sizeof(world.chunkCache) << "\n";
@@ -764,6 +912,16 @@ int main()
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     textureAtlas.Delete();
+    textureAtlasnrml.Delete();
+    textureAtlasRM.Delete();
+    crosshair.Delete();
+    frameUniforms.Delete();
+    crowdPalettes.Delete();
+    skyIrradiance.Delete();
+    spriteBatch.Delete();
+    glDeleteQueries(2, worldPassQueries);
+    world.setChunkPoolHighWaterMark(0); // GPU ranges of the pooled chunks
+    chunkRenderer.shutdown();
     glfwDestroyWindow(window);
     glfwTerminate();
     delete g_camera;